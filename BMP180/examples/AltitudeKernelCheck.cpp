@@ -0,0 +1,111 @@
+/*
+	AltitudeKernelCheck.cpp - Check the altitude kernel against pow() and time it.
+
+	Sweeps the BMP180's pressure range (and past it, to exercise the pow() fallback),
+	compares the scalar, sea level, and batch conversions with the formula, then times
+	each against pow() over a long array, like a replayed pressure log.
+
+	Usage: AltitudeKernelCheck [number of pressures]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "AltitudeKernel.h"
+
+static const double_t SEALEVEL_PRESSURE_MILLIBARS = 1013.25;
+
+// Well under the BMP180's resolution, which is about 8 cm.
+static const double_t SCALAR_TOLERANCE_METERS = 0.001;
+static const double_t BATCH_TOLERANCE_METERS = 0.01;
+static const double_t SEA_LEVEL_TOLERANCE = 1e-9;
+
+static double_t formulaAltitude(const double_t p, const double_t p0)
+{
+	return AltitudeKernel::ALTITUDE_SCALE_METERS * ( 1.0 - pow(p / p0, 1.0 / AltitudeKernel::EXPONENT) );
+}
+
+static double_t secondsNow(void)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + ( now.tv_nsec * 1e-9 );
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t n = ( 1 < argc ) ? (uint32_t)atoi(argv[1]) : 1000000;
+
+	if ( 4 > n )
+		n = 4;
+
+	double_t dScalarError = 0.0, dSeaLevelError = 0.0, dBatchError = 0.0;
+
+	for ( double_t p = 200.0 ; 1300.0 > p ; p += 0.01 )
+		dScalarError = fmax(dScalarError, fabs(AltitudeKernel::pressureToAltitude(p, SEALEVEL_PRESSURE_MILLIBARS) - formulaAltitude(p, SEALEVEL_PRESSURE_MILLIBARS)));
+
+	for ( double_t h = -3000.0 ; 12000.0 > h ; h += 0.1 )
+	{
+		double_t dExpected = 900.0 / pow(1.0 - ( h / AltitudeKernel::ALTITUDE_SCALE_METERS ), AltitudeKernel::EXPONENT);
+
+		dSeaLevelError = fmax(dSeaLevelError, fabs(( AltitudeKernel::seaLevelPressure(900.0, h) / dExpected ) - 1.0));
+	}
+
+	float *pPressures = (float *)malloc(n * sizeof(float));
+	float *pAltitudes = (float *)malloc(n * sizeof(float));
+
+	if ( ( NULL == pPressures ) || ( NULL == pAltitudes ) )
+	{
+		(void)printf("Unable to allocate %u pressures!\n", n);
+		return 1;
+	}
+
+	for ( uint32_t i = 0 ; i < n ; i++ )
+		pPressures[i] = 250.0f + ( i * ( 1000.0f / n ) );
+
+	// One warm-up pass, so the timing doesn't count the page faults.
+	AltitudeKernel::pressuresToAltitudes(pPressures, pAltitudes, n, (float)SEALEVEL_PRESSURE_MILLIBARS);
+
+	double_t dStart = secondsNow();
+	AltitudeKernel::pressuresToAltitudes(pPressures, pAltitudes, n, (float)SEALEVEL_PRESSURE_MILLIBARS);
+	double_t dBatchSeconds = secondsNow() - dStart;
+
+	for ( uint32_t i = 0 ; i < n ; i++ )
+		dBatchError = fmax(dBatchError, fabs(pAltitudes[i] - formulaAltitude(pPressures[i], SEALEVEL_PRESSURE_MILLIBARS)));
+
+	volatile double_t dSum = 0.0;
+
+	dStart = secondsNow();
+	for ( uint32_t i = 0 ; i < n ; i++ )
+		dSum += formulaAltitude(pPressures[i], SEALEVEL_PRESSURE_MILLIBARS);
+	double_t dPowSeconds = secondsNow() - dStart;
+
+	dStart = secondsNow();
+	for ( uint32_t i = 0 ; i < n ; i++ )
+		dSum += AltitudeKernel::pressureToAltitude(pPressures[i], SEALEVEL_PRESSURE_MILLIBARS);
+	double_t dScalarSeconds = secondsNow() - dStart;
+
+	// A pressure that isn't a number has to come out that way, not as an altitude.
+	pPressures[1] = NAN;
+	AltitudeKernel::pressuresToAltitudes(pPressures, pAltitudes, 4, (float)SEALEVEL_PRESSURE_MILLIBARS);
+
+	bool bNan = isnan(pAltitudes[1]);
+
+	free(pPressures);
+	free(pAltitudes);
+
+	(void)printf("Largest errors: scalar %.6lf m, batch %.6lf m, sea level %.3e (relative).\n", dScalarError, dBatchError, dSeaLevelError);
+	(void)printf("Per pressure: pow() %.1lf ns, scalar %.1lf ns, batch %.1lf ns.\n",
+		dPowSeconds * 1e9 / n, dScalarSeconds * 1e9 / n, dBatchSeconds * 1e9 / n);
+
+	bool bGood = ( SCALAR_TOLERANCE_METERS > dScalarError ) && ( BATCH_TOLERANCE_METERS > dBatchError ) &&
+		( SEA_LEVEL_TOLERANCE > dSeaLevelError ) && bNan;
+
+	(void)printf("%s\n", bGood ? "The kernel is within tolerance." : "The kernel is out of tolerance!");
+
+	return bGood ? 0 : 1;
+}
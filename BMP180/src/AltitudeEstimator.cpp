@@ -0,0 +1,137 @@
+/*
+	AltitudeEstimator.cpp - Barometric altitude and vertical speed filter for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include "AltitudeEstimator.h"
+
+const double_t AltitudeEstimator::ACCELERATION_NOISE		= 2.0;
+const double_t AltitudeEstimator::INITIAL_SPEED_SIGMA		= 1.0;
+
+const double_t AltitudeEstimator::APOGEE_ARM_HEIGHT_METERS	= 1.0;
+const double_t AltitudeEstimator::APOGEE_ARM_SPEED			= 0.5;
+const uint32_t AltitudeEstimator::APOGEE_CONFIRM_SAMPLES;
+
+AltitudeEstimator::AltitudeEstimator(const double_t dMeasurementNoise /*= ...*/, const double_t dAccelerationNoise /*= ACCELERATION_NOISE*/)
+{
+	setNoise(dMeasurementNoise, dAccelerationNoise);
+	reset();
+}
+
+AltitudeEstimator::~AltitudeEstimator()
+{
+
+}
+
+void AltitudeEstimator::reset(void)
+{
+	bStarted = false;
+	iLastTimestampNs = 0;
+	dAltitude = dVerticalSpeed = 0.0;
+	dP00 = dP01 = dP11 = 0.0;
+	uUpdates = 0;
+	eApogee = E_APOGEE_WAITING;
+	dStartAltitude = dApogeeAltitude = 0.0;
+	iApogeeTimestampNs = 0;
+	uDescending = 0;
+}
+
+void AltitudeEstimator::setNoise(const double_t dMeasurementNoise, const double_t dAccelerationNoise /*= ACCELERATION_NOISE*/)
+{
+	dMeasurementVariance = dMeasurementNoise * dMeasurementNoise;
+	dAccelerationVariance = dAccelerationNoise * dAccelerationNoise;
+}
+
+bool AltitudeEstimator::update(const BarometerSample &sample, AltitudeEstimate &estimate)
+{
+	if ( !bStarted )
+	{
+		dAltitude = dStartAltitude = dApogeeAltitude = sample.dAltitude;
+		dVerticalSpeed = 0.0;
+		dP00 = dMeasurementVariance, dP01 = 0.0, dP11 = INITIAL_SPEED_SIGMA * INITIAL_SPEED_SIGMA;
+		iApogeeTimestampNs = sample.iTimestampNs;
+		bStarted = true;
+	}
+	else if ( sample.iTimestampNs <= iLastTimestampNs )
+		return false;
+
+	else
+	{
+		const double_t dt = ( sample.iTimestampNs - iLastTimestampNs ) * 1e-9;
+		const double_t dt2 = dt * dt;
+
+		// Predict: x = F x, P = F P F' + Q, with F = [ 1 dt ; 0 1 ].
+		dAltitude += dVerticalSpeed * dt;
+
+		dP00 += ( dt * ( dP01 + dP01 ) ) + ( dt2 * dP11 ) + ( dAccelerationVariance * dt2 * dt2 * 0.25 );
+		dP01 += ( dt * dP11 ) + ( dAccelerationVariance * dt2 * dt * 0.5 );
+		dP11 += dAccelerationVariance * dt2;
+
+		// Correct with the measured altitude: H = [ 1 0 ].
+		const double_t dInnovation = sample.dAltitude - dAltitude;
+		const double_t dS = dP00 + dMeasurementVariance;
+		const double_t dK0 = dP00 / dS, dK1 = dP01 / dS;
+
+		dAltitude += dK0 * dInnovation;
+		dVerticalSpeed += dK1 * dInnovation;
+
+		dP11 -= dK1 * dP01;
+		dP01 -= dK0 * dP01;
+		dP00 -= dK0 * dP00;
+	}
+
+	iLastTimestampNs = sample.iTimestampNs;
+	uUpdates++;
+
+	detectApogee(sample.iTimestampNs);
+
+	estimate.iTimestampNs = sample.iTimestampNs;
+	estimate.uSequence = uUpdates;
+	estimate.dAltitude = dAltitude;
+	estimate.dVerticalSpeed = dVerticalSpeed;
+	estimate.dAltitudeSigma = sqrt(dP00);
+	estimate.dVerticalSpeedSigma = sqrt(dP11);
+	estimate.eApogee = eApogee;
+	estimate.dApogeeAltitude = dApogeeAltitude;
+	estimate.iApogeeTimestampNs = iApogeeTimestampNs;
+
+	return true;
+}
+
+void AltitudeEstimator::detectApogee(const int64_t iTimestampNs)
+{
+	if ( E_APOGEE_DETECTED == eApogee )
+		return;
+
+	if ( dAltitude > dApogeeAltitude )
+		dApogeeAltitude = dAltitude, iApogeeTimestampNs = iTimestampNs;
+
+	if ( E_APOGEE_WAITING == eApogee )
+	{
+		if ( ( ( dAltitude - dStartAltitude ) > APOGEE_ARM_HEIGHT_METERS ) && ( dVerticalSpeed > APOGEE_ARM_SPEED ) )
+			eApogee = E_APOGEE_ARMED;
+	}
+	else if ( 0.0 > dVerticalSpeed )
+	{
+		if ( ++uDescending >= APOGEE_CONFIRM_SAMPLES )
+			eApogee = E_APOGEE_DETECTED;
+	}
+	else
+		uDescending = 0;
+}
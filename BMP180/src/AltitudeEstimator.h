@@ -0,0 +1,113 @@
+/*
+	AltitudeEstimator.h - Barometric altitude and vertical speed filter for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	A two state Kalman filter, altitude and vertical speed, on the BMP180's altitudes. The
+	model is constant velocity driven by white acceleration noise; the measurement noise
+	is the data sheet's RMS pressure noise for the oversampling, in meters. The state and
+	covariance are a handful of doubles, so an update allocates nothing and takes well
+	under a microsecond; BarometerAcquisition runs it after each conversion.
+
+	Apogee: the detector arms once the vehicle is APOGEE_ARM_HEIGHT_METERS above where
+	the filter started and climbing faster than APOGEE_ARM_SPEED; it then fires after
+	APOGEE_CONFIRM_SAMPLES updates in a row with the vertical speed below zero, and
+	reports the highest filtered altitude and when it was reached.
+
+*/
+
+#ifndef _ALTITUDE_ESTIMATOR_H
+#define _ALTITUDE_ESTIMATOR_H
+
+#include <inttypes.h>
+#include <math.h>
+#include "BMP180.h"
+
+#define ALTITUDE_ESTIMATOR_VERSION	1     	// software version of this library
+
+typedef enum
+{
+	E_APOGEE_WAITING		= 0,			// Not yet high or fast enough to arm.
+	E_APOGEE_ARMED			= 1,			// Climbing; watching for the vertical speed to turn.
+	E_APOGEE_DETECTED		= 2,
+
+	NUM_APOGEE_STATES		= 3
+
+} E_APOGEE_STATE;
+
+// The filter's output for one barometer sample.
+typedef struct sAltitudeEstimate
+{
+	int64_t iTimestampNs;					// The sample's, CLOCK_MONOTONIC.
+	uint32_t uSequence;						// Counts updates since the last reset.
+
+	double_t dAltitude;						// Meter(s), filtered.
+	double_t dVerticalSpeed;				// Meter(s) per second, up is positive.
+	double_t dAltitudeSigma;				// The filter's standard deviations.
+	double_t dVerticalSpeedSigma;
+
+	E_APOGEE_STATE eApogee;
+	double_t dApogeeAltitude;				// The highest filtered altitude so far.
+	int64_t iApogeeTimestampNs;				// When it was reached.
+} AltitudeEstimate;
+
+class AltitudeEstimator
+{
+public:
+	AltitudeEstimator(const double_t dMeasurementNoise = BMP180::altitudeNoiseMeters(BMP180_ULTRA_HIGH_RES),
+		const double_t dAccelerationNoise = ACCELERATION_NOISE);
+	~AltitudeEstimator();
+
+	// Starts over from the next sample, and disarms the apogee detector.
+	void reset(void);
+
+	void setNoise(const double_t dMeasurementNoise, const double_t dAccelerationNoise = ACCELERATION_NOISE);
+
+	// False, with the estimate untouched, for a sample that isn't newer than the last.
+	bool update(const BarometerSample &sample, AltitudeEstimate &estimate);
+
+	// m/s² (RMS); what the vehicle's own accelerations look like to the filter.
+	static const double_t ACCELERATION_NOISE;
+
+	// The vertical speed is unknown at the start; this is its first standard deviation (m/s).
+	static const double_t INITIAL_SPEED_SIGMA;
+
+	static const double_t APOGEE_ARM_HEIGHT_METERS;
+	static const double_t APOGEE_ARM_SPEED;
+	static const uint32_t APOGEE_CONFIRM_SAMPLES = 5;
+
+private:
+	double_t dMeasurementVariance, dAccelerationVariance;
+
+	bool bStarted;
+
+	int64_t iLastTimestampNs;
+
+	double_t dAltitude, dVerticalSpeed;
+	double_t dP00, dP01, dP11;				// The covariance; it's symmetric.
+
+	uint32_t uUpdates;
+
+	E_APOGEE_STATE eApogee;
+	double_t dStartAltitude;
+	double_t dApogeeAltitude;
+	int64_t iApogeeTimestampNs;
+	uint32_t uDescending;
+
+	void detectApogee(const int64_t iTimestampNs);
+};
+
+#endif	// _ALTITUDE_ESTIMATOR_H
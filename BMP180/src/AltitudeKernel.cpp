@@ -0,0 +1,171 @@
+/*
+	AltitudeKernel.cpp - Barometric altitude without pow() for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <string.h>
+
+#include "AltitudeKernel.h"
+
+const double_t AltitudeKernel::ALTITUDE_SCALE_METERS	= 44330.0;
+const double_t AltitudeKernel::EXPONENT					= 5.255;
+
+const double_t AltitudeKernel::RATIO_LOW				= 0.55;
+const double_t AltitudeKernel::RATIO_HIGH				= 1.15;
+const double_t AltitudeKernel::RATIO_MINIMUM			= 0.275;
+
+const double_t AltitudeKernel::HALVING_SCALE			= 8.76426518700139101e-01;
+
+const double_t AltitudeKernel::SEA_LEVEL_LOW			= 0.75;
+const double_t AltitudeKernel::SEA_LEVEL_HIGH			= 1.05;
+
+const uint32_t AltitudeKernel::ALTITUDE_DEGREE;
+const uint32_t AltitudeKernel::SEA_LEVEL_DEGREE;
+
+// Chebyshev interpolation of r ^ ( 1 / 5.255 ) on [ 0.55, 1.15 ] at ten nodes.
+const double_t AltitudeKernel::ALTITUDE_COEFFICIENTS[ALTITUDE_DEGREE + 1] =
+{
+	 9.69546799621234690e-01,
+	 6.51176003240170054e-02,
+	-9.30455726070933235e-03,
+	 1.98099639517819144e-03,
+	-4.91435959393449260e-04,
+	 1.32171975813299975e-04,
+	-3.65082665787497262e-05,
+	 1.06743563030420325e-05,
+	-4.21888290986771591e-06,
+	 1.30094956318771438e-06
+};
+
+// Chebyshev interpolation of y ^ 5.255 on [ 0.75, 1.05 ] at nine nodes.
+const double_t AltitudeKernel::SEA_LEVEL_COEFFICIENTS[SEA_LEVEL_DEGREE + 1] =
+{
+	 5.74836567062444792e-01,
+	 5.03461026653236332e-01,
+	 1.78518889033690703e-01,
+	 3.22821657529994629e-02,
+	 3.03317849272370177e-03,
+	 1.26888017053368885e-04,
+	 8.98786629911619915e-07,
+	-1.60095480576198172e-08,
+	 5.83759411180532542e-10
+};
+
+// T is E, or a vector of E.
+template <typename T, typename E>
+static inline T horner(const E *pCoefficients, const uint32_t uDegree, const T x)
+{
+	T y = ( x * pCoefficients[uDegree] ) + pCoefficients[uDegree - 1];
+
+	for ( int32_t i = (int32_t)uDegree - 2 ; 0 <= i ; i-- )
+		y = ( y * x ) + pCoefficients[i];
+
+	return y;
+}
+
+double_t AltitudeKernel::pressureToAltitude(const double_t p, const double_t p0)
+{
+	double_t r = p / p0;
+
+	// The negated test also sends NaN to pow().
+	if ( !( ( RATIO_MINIMUM <= r ) && ( RATIO_HIGH >= r ) ) )
+		return ALTITUDE_SCALE_METERS * ( 1.0 - pow(r, 1.0 / EXPONENT) );
+
+	double_t dScale = 1.0;
+
+	if ( RATIO_LOW > r )
+		r *= 2.0, dScale = HALVING_SCALE;
+
+	double_t x = ( r * ( 2.0 / ( RATIO_HIGH - RATIO_LOW ) ) ) - ( ( RATIO_HIGH + RATIO_LOW ) / ( RATIO_HIGH - RATIO_LOW ) );
+
+	return ALTITUDE_SCALE_METERS * ( 1.0 - ( dScale * horner<double_t, double_t>(ALTITUDE_COEFFICIENTS, ALTITUDE_DEGREE, x) ) );
+}
+
+double_t AltitudeKernel::seaLevelPressure(const double_t p, const double_t dAltitude)
+{
+	double_t y = 1.0 - ( dAltitude / ALTITUDE_SCALE_METERS );
+
+	if ( !( ( SEA_LEVEL_LOW <= y ) && ( SEA_LEVEL_HIGH >= y ) ) )
+		return p / pow(y, EXPONENT);
+
+	double_t x = ( y * ( 2.0 / ( SEA_LEVEL_HIGH - SEA_LEVEL_LOW ) ) ) - ( ( SEA_LEVEL_HIGH + SEA_LEVEL_LOW ) / ( SEA_LEVEL_HIGH - SEA_LEVEL_LOW ) );
+
+	return p / horner<double_t, double_t>(SEA_LEVEL_COEFFICIENTS, SEA_LEVEL_DEGREE, x);
+}
+
+// GCC's generic vectors; four floats fill a NEON or an SSE register.
+typedef float v4sf __attribute__((vector_size(16)));
+typedef int32_t v4si __attribute__((vector_size(16)));
+
+static const uint32_t LANES = sizeof(v4sf) / sizeof(float);
+
+void AltitudeKernel::pressuresToAltitudes(const float *pPressures, float *pAltitudes, const uint32_t n, const float p0)
+{
+	const float fInverse = 1.0f / p0;
+	const float fSlope = (float)( 2.0 / ( RATIO_HIGH - RATIO_LOW ) );
+	const float fIntercept = (float)( ( RATIO_HIGH + RATIO_LOW ) / ( RATIO_HIGH - RATIO_LOW ) );
+
+	float afCoefficients[ALTITUDE_DEGREE + 1];
+
+	for ( uint32_t k = 0 ; k <= ALTITUDE_DEGREE ; k++ )
+		afCoefficients[k] = (float)ALTITUDE_COEFFICIENTS[k];
+
+	const v4sf vOne = { 1.0f, 1.0f, 1.0f, 1.0f };
+	const v4sf vHalving = vOne * (float)HALVING_SCALE;
+
+	uint32_t i = 0;
+
+	for ( ; ( i + LANES ) <= n ; i += LANES )
+	{
+		v4sf r;
+
+		(void)memcpy(&r, &pPressures[i], sizeof(r));
+
+		r = r * fInverse;
+
+		// Any lane outside the fit goes through the scalar version.
+		v4si bOutside = ( r < (float)RATIO_MINIMUM ) | ( r > (float)RATIO_HIGH ) | ( r != r );
+
+		v4si bLow = r < (float)RATIO_LOW;
+
+		r = bLow ? r + r : r;
+
+		v4sf vScale = bLow ? vHalving : vOne;
+
+		v4sf x = ( r * fSlope ) - fIntercept;
+
+		v4sf h = ( vOne - ( vScale * horner<v4sf, float>(afCoefficients, ALTITUDE_DEGREE, x) ) ) * (float)ALTITUDE_SCALE_METERS;
+
+		if ( bOutside[0] | bOutside[1] | bOutside[2] | bOutside[3] )
+		{
+			// Read the pressures before the store, in case the arrays are the same one.
+			float afPressures[LANES];
+
+			(void)memcpy(afPressures, &pPressures[i], sizeof(afPressures));
+
+			for ( uint32_t j = 0 ; j < LANES ; j++ )
+				h[j] = bOutside[j] ? (float)pressureToAltitude(afPressures[j], p0) : h[j];
+		}
+
+		(void)memcpy(&pAltitudes[i], &h, sizeof(h));
+	}
+
+	for ( ; i < n ; i++ )
+		pAltitudes[i] = (float)pressureToAltitude(pPressures[i], p0);
+}
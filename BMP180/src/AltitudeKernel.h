@@ -0,0 +1,76 @@
+/*
+	AltitudeKernel.h - Barometric altitude without pow() for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	The barometric formula, h = 44330 * ( 1 - ( p / p0 ) ^ ( 1 / 5.255 ) ), costs a pow() for
+	every reading, and its inverse, for the sea level pressure, costs another. Here both
+	powers are Chebyshev fits evaluated by Horner's rule: ( p / p0 ) ^ ( 1 / 5.255 ) over
+	ratios from 0.55 to 1.15, with one exact halving step that reaches down to 0.275, and
+	y ^ 5.255 over 0.75 to 1.05. The double versions are within 0.1 mm and 1e-9 relative
+	of pow(); the BMP180 resolves about 8 cm. Outside those ranges they call pow().
+
+	pressuresToAltitudes() converts an array of float pressures, four at a time in the
+	vector unit (NEON on the Pi, SSE on a PC), for high-rate estimation or to replay a
+	long pressure log on the ground. Float rounding puts it within about 5 mm of pow().
+
+*/
+
+#ifndef _ALTITUDE_KERNEL_H
+#define _ALTITUDE_KERNEL_H
+
+#include <inttypes.h>
+#include <math.h>
+
+#define ALTITUDE_KERNEL_VERSION	1     		// software version of this library
+
+class AltitudeKernel
+{
+public:
+	// Meters above the level where the pressure is p0; p and p0 in the same units.
+	static double_t pressureToAltitude(const double_t p, const double_t p0);
+
+	// The pressure at sea level, given the pressure at an altitude in meters.
+	static double_t seaLevelPressure(const double_t p, const double_t dAltitude);
+
+	// Converts n pressures; the arrays may be the same one, and need no alignment.
+	static void pressuresToAltitudes(const float *pPressures, float *pAltitudes, const uint32_t n, const float p0);
+
+	// The formula's constants.
+	static const double_t ALTITUDE_SCALE_METERS;
+	static const double_t EXPONENT;
+
+private:
+	// The polynomial's range of ratios, and the lowest one the halving step reaches.
+	static const double_t RATIO_LOW;
+	static const double_t RATIO_HIGH;
+	static const double_t RATIO_MINIMUM;
+
+	// 2 ^ ( -1 / 5.255 ); undoes the halving step's doubling.
+	static const double_t HALVING_SCALE;
+
+	static const double_t SEA_LEVEL_LOW;
+	static const double_t SEA_LEVEL_HIGH;
+
+	static const uint32_t ALTITUDE_DEGREE = 9;
+	static const uint32_t SEA_LEVEL_DEGREE = 8;
+
+	// Monomial coefficients in x, the range mapped onto [-1, 1]; lowest order first.
+	static const double_t ALTITUDE_COEFFICIENTS[ALTITUDE_DEGREE + 1];
+	static const double_t SEA_LEVEL_COEFFICIENTS[SEA_LEVEL_DEGREE + 1];
+};
+
+#endif	// _ALTITUDE_KERNEL_H
@@ -32,6 +32,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <errno.h>
 
 #include "BMP180.h"
+#include "AltitudeKernel.h"
+#include "CalibrationProfile.h"
 
 /*
 
@@ -53,26 +55,15 @@ const char *BMP180::getName(void)
 		IIO_PATH_PREFACE "/name"
 	};
 
-	if ( bDebug )
-		(void)printf("\nTrying to open \"%s.\"\n", pName);
+	SysfsAttribute nameAttribute(pName);
 
-	pHandle = fopen(pName,"r");
-	
-	if ( NULL == pHandle )
-	{	
-		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pName, strerror(errno));	
-		return (const char *)achDeviceName;		
-	}
+	if ( !nameAttribute.isOpen() )
+		return (const char *)achDeviceName;
 
-	else if ( bDebug )
-		(void)printf("Successfully opened \"%s.\"\n", pName);	
-	else
-		;
-	
 	(void)memset(achDeviceName, '\0', sizeof(achDeviceName));
-	if ( 1 != fscanf(pHandle, "%s", achDeviceName) )
+	if ( !nameAttribute.readString(achDeviceName, sizeof(achDeviceName)) )
 	{
-		(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pName, strerror(errno));
+		;						// Already reported.
 	}
 	else if ( bDebug )
 	{
@@ -80,10 +71,6 @@ const char *BMP180::getName(void)
 	}
 	else
 		;
-
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;
  	
 	return (const char *)achDeviceName;
 };
@@ -95,27 +82,20 @@ void BMP180::setOversampling(E_BMP180_OSS oss /*= BMP180_ULTRA_HIGH_RES*/)
 		IIO_PATH_PREFACE  "/in_pressure_oversampling_ratio"
 	};
 
-	if ( bDebug )
-		(void)printf("\nTrying to open \"%s\" for read/write.\n", pPressureOversampling);
+	// Writing is rare and needs root; use a one-shot read/write handle.
+	SysfsAttribute writableAttribute(pPressureOversampling, O_RDWR);
 
-	pHandle = fopen(pPressureOversampling,"r+");
-	
-	if ( NULL == pHandle )
+	if ( !writableAttribute.isOpen() )
 	{	
-		(void)printf("Unable to open \"%s!\" You might need to be root.\n\t\"%s\"\n", pPressureOversampling, strerror(errno));	
+		(void)printf("You might need to be root to write \"%s.\"\n", pPressureOversampling);	
 		return;		
 	}
-
-	else if ( bDebug )
-		(void)printf("Successfully opened \"%s.\"\n", pPressureOversampling);	
-	else
-		;	
 		
 	in_pressure_oversampling_ratio = oss;
 		
-	if ( 0 > fprintf(pHandle, "%u", in_pressure_oversampling_ratio) )
+	if ( !writableAttribute.writeUnsigned(in_pressure_oversampling_ratio) )
 	{
-		(void)printf("Unable to write to \"%s!\" You might need to be root.\n\t\"%s\"\n", pPressureOversampling, strerror(errno));
+		(void)printf("You might need to be root to write \"%s.\"\n", pPressureOversampling);
 		return;			 
 	}
 	else if ( bDebug )
@@ -126,54 +106,28 @@ void BMP180::setOversampling(E_BMP180_OSS oss /*= BMP180_ULTRA_HIGH_RES*/)
 		;
 				
 	eOSS = oss;
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;		
-	
 }
 
 E_BMP180_OSS BMP180::getOversampling(void)
 {
-	const char *pPressureOversampling =
-	{
-		IIO_PATH_PREFACE "/in_pressure_oversampling_ratio"
-	};
-
-	if ( bDebug )
-		(void)printf("\nTrying to open \"%s.\"\n", pPressureOversampling);
-
-	pHandle = fopen(pPressureOversampling,"r");
-	
-	if ( NULL == pHandle )
-	{	
-		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pPressureOversampling, strerror(errno));	
-		return eOSS;		
-	}
-
-	else if ( bDebug )
-		(void)printf("Successfully opened \"%s.\"\n", pPressureOversampling);	
-	else
-		;
+	if ( !oversamplingAttribute.isOpen() )
+		return eOSS;			// Reported when opened.
 	
 	in_pressure_oversampling_ratio =		// The Linux driver's default value.
 		eOSS = BMP180_ULTRA_HIGH_RES;
 	
-	if ( 1 != fscanf(pHandle, "%u", &in_pressure_oversampling_ratio) )
+	if ( !oversamplingAttribute.readUnsigned(in_pressure_oversampling_ratio) )
 	{
-		(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pPressureOversampling, strerror(errno));
+		;						// Already reported.
 	}
 	else if ( bDebug )
 	{
-		(void)printf("The oversampling value reported from \"%s\" is \"%u.\"\n", pPressureOversampling, in_pressure_oversampling_ratio);
+		(void)printf("The oversampling value reported from \"%s\" is \"%u.\"\n", oversamplingAttribute.getPath(), in_pressure_oversampling_ratio);
 	}
 	else
 		;
 
 	eOSS = (E_BMP180_OSS)in_pressure_oversampling_ratio;
-
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;	
 	
 	return eOSS;
 }
@@ -181,42 +135,20 @@ E_BMP180_OSS BMP180::getOversampling(void)
 uint32_t BMP180::readRawTemperature(void)
 {
 	in_temp_input = 0xffffffff;
-	
-	const char *pTemperatureInput =
-	{
-		IIO_PATH_PREFACE "/in_temp_input"
-	};
-
-	if ( bDebug )
-		(void)printf("\nTrying to open \"%s.\"\n", pTemperatureInput);
 
-	pHandle = fopen(pTemperatureInput,"r");	
+	if ( !temperatureAttribute.isOpen() )
+		return in_temp_input;	// Reported when opened.
 	
-	if ( NULL == pHandle )
-	{	
-		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pTemperatureInput, strerror(errno));	
-		return in_temp_input;		
-	}
-
-	else if ( bDebug )
-		(void)printf("Successfully opened \"%s.\"\n", pTemperatureInput);	
-	else
-		;	
-	
-	if ( 1 != fscanf(pHandle, "%u", &in_temp_input) )
+	if ( !temperatureAttribute.readUnsigned(in_temp_input) )
 	{
-		(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pTemperatureInput, strerror(errno));
+		in_temp_input = 0xffffffff;
 	}
 	else if ( bDebug )
 	{
-		(void)printf("The raw (unzeroed) temperature value reported from \"%s\" is \"%u.\"\n", pTemperatureInput, in_temp_input);
+		(void)printf("The raw (unzeroed) temperature value reported from \"%s\" is \"%u.\"\n", temperatureAttribute.getPath(), in_temp_input);
 	}
 	else
 		;	
-	
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;	
 
 	return in_temp_input;
 }
@@ -230,6 +162,8 @@ double_t BMP180::readTemperature(void)	// in degrees C.
 	d /= RAW_TEMPERATURE_CONVERSION;
 
 	d -= raw_temp_offset;
+
+	dLastTemperature = d;
 	
 	if ( bDebug )
 		(void)printf("The reported temperature is %lf degrees C.\n", d);
@@ -245,31 +179,13 @@ double_t BMP180::readPressure(void)
 double_t BMP180::getPressure(void)		// in mbars.
 {
 	in_pressure_input = SEALEVEL_PRESSURE_MILLIBARS;
-	
-	const char *pPressureInput =
-	{
-		IIO_PATH_PREFACE "/in_pressure_input"
-	};
-
-	if ( bDebug )
-		(void)printf("\nTrying to open \"%s.\"\n", pPressureInput);
-
-	pHandle = fopen(pPressureInput,"r");		
-	
-	if ( NULL == pHandle )
-	{	
-		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pPressureInput, strerror(errno));	
-		return in_pressure_input;		
-	}
 
-	else if ( bDebug )
-		(void)printf("Successfully opened \"%s.\"\n", pPressureInput);	
-	else
-		;		
+	if ( !pressureAttribute.isOpen() )
+		return in_pressure_input;	// Reported when opened.
 	
-	if ( 1 != fscanf(pHandle, "%lf", &in_pressure_input) )
+	if ( !pressureAttribute.readDouble(in_pressure_input) )
 	{
-		(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pPressureInput, strerror(errno));
+		in_pressure_input = SEALEVEL_PRESSURE_MILLIBARS;
 	}
 
 	else
@@ -279,47 +195,53 @@ double_t BMP180::getPressure(void)		// in mbars.
 	
 	if ( bDebug )
 	{
-		(void)printf("The raw, unzeroed, pressure value reported from \"%s\" is \"%lf mbar(s).\"\n", pPressureInput, in_pressure_input);
+		(void)printf("The raw, unzeroed, pressure value reported from \"%s\" is \"%lf mbar(s).\"\n", pressureAttribute.getPath(), in_pressure_input);
 	}	
 	
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;	
-	
 	return in_pressure_input;
 }
 
-BMP180::BMP180(E_BMP180_OSS e /*= BMP180_ULTRA_HIGH_RES*/) :
+BMP180::BMP180(E_BMP180_OSS e /*= BMP180_ULTRA_HIGH_RES*/, const char *pProfilePath /*= BMP180_PROFILE_PATH*/) :
 	eOSS(e), bCalibrated(false), 
 	
 	dBaselinePressure(SEALEVEL_PRESSURE_MILLIBARS),
 	dBaselineAltitude(DEFAULT_ALTITUDE),
 
-	pHandle(NULL), in_temp_input(0xffffffff),
+	in_temp_input(0xffffffff),
 	in_pressure_oversampling_ratio(BMP180_ULTRA_HIGH_RES), in_temp_oversampling_ratio(1),
 	in_pressure_input(SEALEVEL_PRESSURE_MILLIBARS),
+	dLastTemperature(DEFAULT_TEMPERATURE), uSampleSequence(0),
 	raw_temp_offset(0.0), raw_pressure_offset(0.0),
 	raw_altitude_offset(0.0), set_altitude_value(DEFAULT_ALTITUDE), set_pressure_value(DEFAULT_PRESSURE), set_temperature_value(DEFAULT_TEMPERATURE)
 {
+	(void)temperatureAttribute.open(IIO_PATH_PREFACE "/in_temp_input");
+	(void)pressureAttribute.open(IIO_PATH_PREFACE "/in_pressure_input");
+	(void)oversamplingAttribute.open(IIO_PATH_PREFACE "/in_pressure_oversampling_ratio");
+
+	// A profile that still fits needs none of the settling below.
+	if ( ( NULL != pProfilePath ) && loadProfile(pProfilePath) && checkDrift() )
+	{
+		if ( bDebug )
+			(void)printf("Using the calibration profile \"%s.\"\n", pProfilePath);
+		return;
+	}
+
+	bCalibrated = false;
+
 	// setOversampling(e);
-	(void)usleep(BMP180_SAMPLE_DELAY_US);	
+	// Each read blocks until its conversion is done, so there's nothing to wait out between them.
 	(void)getName();
-	(void)usleep(BMP180_SAMPLE_DELAY_US);
 	(void)getOversampling();
-	(void)usleep(BMP180_SAMPLE_DELAY_US);
 	(void)readTemperature();
-	(void)usleep(BMP180_SAMPLE_DELAY_US);
 	(void)getPressure();
-	(void)usleep(BMP180_SAMPLE_DELAY_US);
 	(void)getAltitude();
-	(void)usleep(BMP180_SAMPLE_DELAY_US);	
 }
 
 BMP180::~BMP180()
 {
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;
+	temperatureAttribute.close();
+	pressureAttribute.close();
+	oversamplingAttribute.close();
 	bCalibrated = false;
 }
 
@@ -348,15 +270,68 @@ double_t BMP180::getAltitude(double_t p0 /*= SEALEVEL_PRESSURE_MILLIBARS*/)
 {
 	double_t p 	= getPressure();
 	
-	double_t H = 44330.0f * (1.0f - pow( ( p/p0 ), ( 1.0f / 5.255f ) ) );
+	return pressureToAltitude(p, p0);
+}
+
+uint32_t BMP180::conversionTimeUs(const E_BMP180_OSS oss)
+{
+	switch ( oss )
+	{
+		case BMP180_ULTRA_LOW_POWER:
+			return 4500;
+		case BMP180_STANDARD:
+			return 7500;
+		case BMP180_HIGH_RES:
+			return 13500;
+		default:
+			return 25500;
+	}
+}
+
+double_t BMP180::altitudeNoiseMeters(const E_BMP180_OSS oss)
+{
+	switch ( oss )
+	{
+		case BMP180_ULTRA_LOW_POWER:
+			return 0.5;
+		case BMP180_STANDARD:
+			return 0.4;
+		case BMP180_HIGH_RES:
+			return 0.3;
+		default:
+			return 0.25;
+	}
+}
+
+double_t BMP180::pressureToAltitude(const double_t p, const double_t p0 /*= SEALEVEL_PRESSURE_MILLIBARS*/)
+{
+	return AltitudeKernel::pressureToAltitude(p, p0);
+}
+
+void BMP180::readSample(BarometerSample &sample, const bool bTemperature /*= true*/)
+{
+	if ( bTemperature )
+		(void)readTemperature();
+
+	// One conversion for both; readPressure() and readAltitude() would each do their own.
+	double_t p = getPressure();
+
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
 
-	return H;
+	sample.iTimestampNs = ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec;
+	sample.uSequence = uSampleSequence++;
+	sample.dTemperature = dLastTemperature;
+	sample.dPressure = p - raw_pressure_offset;
+	sample.dRawPressure = p;
+	sample.dAltitude = pressureToAltitude(p, dBaselinePressure) + dBaselineAltitude;
 }
 
 // Calculate sea level from the pressure in pascals given at a specific altitude in meters.
 double BMP180::getSeaLevel(double pressure, double altitude)
 {
-    return ((double)pressure / pow(1.0f - ((double)altitude / 44330.0f), 5.255f));
+    return AltitudeKernel::seaLevelPressure(pressure, altitude);
 }
 
 // "Oversampling 8 Conversion time 25.5 ms." 
@@ -368,7 +343,7 @@ const uint32_t BMP180::NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_SECOND 		= 21;
 
 const uint32_t BMP180::NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_MINUTE 		= ( 60 * NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_SECOND );
 
-const uint32_t BMP180::NUMBER_OF_OFFSET_SAMPLES_FOR_FIVE_MINUTES	= ( 5 * NUMBER_OF_OFFSET_SAMPLES_FOR_FIVE_MINUTES );
+const uint32_t BMP180::NUMBER_OF_OFFSET_SAMPLES_FOR_FIVE_MINUTES	= ( 5 * NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_MINUTE );
 
 const double_t BMP180::DEFAULT_TEMPERATURE 							= 22.6, 
 	BMP180::DEFAULT_ALTITUDE 										= 334.0,
@@ -470,3 +445,75 @@ void BMP180::getOffsets(const uint32_t uN /*= NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_M
 	bCalibrated = true;
 
 }
+
+const double_t BMP180::DRIFT_PRESSURE_MILLIBARS						= 2.0;		// About 17 meters.
+
+const uint32_t BMP180::PROFILE_MAGIC								= 0x30383142;	// "B180"
+
+const uint32_t BMP180::PROFILE_VERSION								= 1;
+
+bool BMP180::saveProfile(const char *pPath /*= BMP180_PROFILE_PATH*/)
+{
+	if ( !bCalibrated )
+		return false;
+
+	Profile profile;
+
+	(void)memset(&profile, 0, sizeof(profile));
+
+	profile.raw_temp_offset = raw_temp_offset;
+	profile.raw_pressure_offset = raw_pressure_offset;
+	profile.raw_altitude_offset = raw_altitude_offset;
+	profile.set_altitude_value = set_altitude_value;
+	profile.set_pressure_value = set_pressure_value;
+	profile.set_temperature_value = set_temperature_value;
+	profile.dBaselinePressure = dBaselinePressure;
+	profile.dBaselineAltitude = dBaselineAltitude;
+	profile.uOversampling = (uint32_t)eOSS;
+
+	return CalibrationProfile::save(pPath, PROFILE_MAGIC, PROFILE_VERSION, &profile, sizeof(profile));
+}
+
+bool BMP180::loadProfile(const char *pPath /*= BMP180_PROFILE_PATH*/)
+{
+	Profile profile;
+
+	if ( !CalibrationProfile::load(pPath, PROFILE_MAGIC, PROFILE_VERSION, &profile, sizeof(profile)) )
+		return false;
+
+	raw_temp_offset = profile.raw_temp_offset;
+	raw_pressure_offset = profile.raw_pressure_offset;
+	raw_altitude_offset = profile.raw_altitude_offset;
+	set_altitude_value = profile.set_altitude_value;
+	set_pressure_value = profile.set_pressure_value;
+	set_temperature_value = profile.set_temperature_value;
+	dBaselinePressure = profile.dBaselinePressure;
+	dBaselineAltitude = profile.dBaselineAltitude;
+	eOSS = (E_BMP180_OSS)profile.uOversampling;
+
+	bCalibrated = true;
+
+	return true;
+}
+
+bool BMP180::checkDrift(void)
+{
+	const E_BMP180_OSS eSaved = eOSS;
+
+	if ( oversamplingAttribute.isOpen() && ( eSaved != getOversampling() ) )
+	{
+		(void)printf("The BMP180 oversampling changed since its profile was saved; recalibrate.\n");
+		return false;
+	}
+
+	// The read waits out the conversion.
+	double_t dDrift = getPressure() - dBaselinePressure;
+
+	if ( fabs(dDrift) > DRIFT_PRESSURE_MILLIBARS )
+	{
+		(void)printf("The pressure moved %lf mbar(s) from the BMP180 profile's baseline; recalibrate.\n", dDrift);
+		return false;
+	}
+
+	return true;
+}
@@ -27,9 +27,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <inttypes.h>
 #include <math.h>
 #include <unistd.h>
+#include <time.h>
+#include "SysfsAttribute.h"
 
 #define IIO_PATH_PREFACE	"/sys/bus/iio/devices/iio:device0"
 
+// Where the last calibration is kept between runs; NULL to the constructor skips it.
+#define BMP180_PROFILE_PATH	"/var/tmp/bmp180.profile"
+
+// One pressure conversion, compensated; see BMP180::readSample().
+typedef struct sBarometerSample
+{
+	int64_t iTimestampNs;					// CLOCK_MONOTONIC, when the conversion finished.
+	uint32_t uSequence;						// Counts samples read.
+
+	double_t dTemperature;					// Degrees C; from the last temperature conversion.
+	double_t dPressure;						// mbar(s), as readPressure().
+	double_t dRawPressure;					// mbar(s), as getPressure(); the baseline's units.
+	double_t dAltitude;						// Meter(s), as readAltitude().
+} BarometerSample;
+
 typedef enum
 {
     BMP180_ULTRA_LOW_POWER  	= 1,	// Oversampling 1 Conversion time 4.5 ms.
@@ -44,7 +61,7 @@ typedef enum
 class BMP180
 {
     public:
-		BMP180(E_BMP180_OSS e = BMP180_ULTRA_HIGH_RES);
+		BMP180(E_BMP180_OSS e = BMP180_ULTRA_HIGH_RES, const char *pProfilePath = BMP180_PROFILE_PATH);
 		~BMP180();
 		
 		const char *getName(void);
@@ -61,6 +78,19 @@ class BMP180
 		double_t getAltitude(double_t p0 = SEALEVEL_PRESSURE_MILLIBARS);
 		double_t getSeaLevel(double_t pressure, double_t altitude);
 
+		// The data sheet's pressure conversion time for an oversampling setting.
+		static uint32_t conversionTimeUs(const E_BMP180_OSS oss);
+
+		// The data sheet's typical RMS altitude noise for an oversampling setting (meters).
+		static double_t altitudeNoiseMeters(const E_BMP180_OSS oss);
+
+		// The altitude for a pressure, without reading the sensor.
+		static double_t pressureToAltitude(const double_t p, const double_t p0 = SEALEVEL_PRESSURE_MILLIBARS);
+
+		// Blocks for one pressure conversion (and a temperature one, if asked), then fills
+		//	in the sample from that single reading; see BarometerAcquisition to not block.
+		void readSample(BarometerSample &sample, const bool bTemperature = true);
+
 		void getOffsets(const uint32_t uN = NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_MINUTE, const double_t dPressure = DEFAULT_PRESSURE, const double_t dTemperature = DEFAULT_TEMPERATURE, const double_t dAltitude = DEFAULT_ALTITUDE );		
 									
 		inline bool calibrated(void)
@@ -68,6 +98,31 @@ class BMP180
 			return bCalibrated;
 		}									
 
+		// The raw pressure (as getPressure()) that getOffsets() found at the baseline altitude;
+		//	see BaselineTracker to follow it as the weather changes.
+		inline double_t getBaselinePressure(void)
+		{
+			return dBaselinePressure;
+		}
+
+		inline void setBaselinePressure(const double_t dPressure)
+		{
+			dBaselinePressure = dPressure;
+		}
+
+		inline double_t getBaselineAltitude(void)
+		{
+			return dBaselineAltitude;
+		}
+
+		// The offsets and the baseline pressure and altitude from the last calibration.
+		bool saveProfile(const char *pPath = BMP180_PROFILE_PATH);
+		bool loadProfile(const char *pPath = BMP180_PROFILE_PATH);
+
+		// One reading; false if the pressure moved more than DRIFT_PRESSURE_MILLIBARS from the
+		//	baseline (weather, or a different pad) or the oversampling changed.
+		bool checkDrift(void);
+
 		static const double_t MILLIBARS_TO_PASCALS;
 		
 		static const double_t SEALEVEL_PRESSURE_MILLIBARS;
@@ -81,6 +136,11 @@ class BMP180
 
 		static const double_t DEFAULT_TEMPERATURE, DEFAULT_ALTITUDE, DEFAULT_PRESSURE;
 
+		static const double_t DRIFT_PRESSURE_MILLIBARS;
+
+		static const uint32_t PROFILE_MAGIC;
+		static const uint32_t PROFILE_VERSION;
+
 	protected:
 		E_BMP180_OSS eOSS;
 
@@ -91,7 +151,10 @@ class BMP180
 		double_t dBaselineAltitude;
 
     private:
-    	FILE *pHandle;					// Used to access the "/sys/bus/iio/device0" bmp180 abstraction.
+		// Used to access the "/sys/bus/iio/device0" bmp180 abstraction; opened once, re-read with pread.
+		SysfsAttribute temperatureAttribute;
+		SysfsAttribute pressureAttribute;
+		SysfsAttribute oversamplingAttribute;
 		
 		char achDeviceName[100];
 		
@@ -104,11 +167,24 @@ class BMP180
 		uint32_t in_temp_oversampling_ratio;
 										// Never changes for BMP180. Does for BMP280.
 		double_t in_pressure_input;
+
+		double_t dLastTemperature;
+
+		uint32_t uSampleSequence;
 		
 		static const double_t RAW_TEMPERATURE_CONVERSION;
 
 		double_t raw_temp_offset;
 		double_t raw_pressure_offset, raw_altitude_offset, set_altitude_value, set_pressure_value, set_temperature_value;
+
+		// The saved calibration; bump PROFILE_VERSION when it changes.
+		typedef struct sProfile
+		{
+			double_t raw_temp_offset, raw_pressure_offset, raw_altitude_offset;
+			double_t set_altitude_value, set_pressure_value, set_temperature_value;
+			double_t dBaselinePressure, dBaselineAltitude;
+			uint32_t uOversampling;
+		} Profile;
 		
 };
 
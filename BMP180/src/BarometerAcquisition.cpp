@@ -0,0 +1,235 @@
+/*
+	BarometerAcquisition.cpp - Non-blocking BMP180 conversions for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "BarometerAcquisition.h"
+
+const bool BarometerAcquisition::bDebug = false;
+
+const uint32_t BarometerAcquisition::TEMPERATURE_INTERVAL;
+
+BarometerAcquisition::BarometerAcquisition(BMP180 *pSensor) :
+	pSensor(pSensor), bRunning(false), eState(E_BAROMETER_IDLE), uConversions(0),
+	bContinuous(true), bRequested(false)
+{
+	(void)memset(&sAcquisitionThread, 0, sizeof(pthread_t));
+
+	(void)pthread_mutex_init(&sMutex, NULL);
+	(void)pthread_cond_init(&sRequest, NULL);
+}
+
+BarometerAcquisition::~BarometerAcquisition()
+{
+	stop();
+
+	(void)pthread_cond_destroy(&sRequest);
+	(void)pthread_mutex_destroy(&sMutex);
+}
+
+bool BarometerAcquisition::start(const bool bContinuousConversions /*= true*/)
+{
+	if ( running() || ( NULL == pSensor ) )
+		return running();
+
+	bContinuous = bContinuousConversions, bRequested = false;
+
+	estimator.setNoise(BMP180::altitudeNoiseMeters(pSensor->getOversampling()));
+	estimator.reset();
+
+	bRunning = true;
+
+	int32_t iRet = pthread_create(&sAcquisitionThread, NULL, acquisitionBackground, (void *)this);
+
+	if ( 0 != iRet )
+	{
+		(void)fprintf(stderr, "%s: thread creation error!\n\t\"%s\"", __FUNCTION__, strerror(iRet));
+		bRunning = false;
+		return false;
+	}
+	else if ( bDebug )
+		(void)printf("Barometer acquisition thread created successfully.\n");
+	else
+		;
+
+	return true;
+}
+
+void BarometerAcquisition::stop(void)
+{
+	if ( !running() )
+		return;
+
+	(void)pthread_mutex_lock(&sMutex);
+	bRunning = false;
+	(void)pthread_cond_signal(&sRequest);
+	(void)pthread_mutex_unlock(&sMutex);
+
+	// At most one conversion to wait out.
+	(void)pthread_join(sAcquisitionThread, NULL);
+
+	eState = E_BAROMETER_IDLE;
+
+	if ( bDebug )
+		(void)printf("Barometer acquisition stopped: %u conversions.\n", getConversions());
+}
+
+bool BarometerAcquisition::requestConversion(void)
+{
+	if ( !running() )
+		return false;
+
+	(void)pthread_mutex_lock(&sMutex);
+
+	bool bAccepted = !bRequested && ( E_BAROMETER_IDLE == getState() );
+
+	if ( bAccepted )
+	{
+		bRequested = true;
+		(void)pthread_cond_signal(&sRequest);
+	}
+
+	(void)pthread_mutex_unlock(&sMutex);
+
+	return bAccepted;
+}
+
+bool BarometerAcquisition::getLatest(BarometerSample &sample)
+{
+	if ( 0 == latestSample.writes() )
+		return false;
+
+	latestSample.read(sample);
+
+	return true;
+}
+
+bool BarometerAcquisition::getEstimate(AltitudeEstimate &estimate)
+{
+	if ( 0 == latestEstimate.writes() )
+		return false;
+
+	latestEstimate.read(estimate);
+
+	return true;
+}
+
+int64_t BarometerAcquisition::getAgeNs(void)
+{
+	BarometerSample sample;
+
+	if ( !getLatest(sample) )
+		return -1;
+
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ( ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec ) - sample.iTimestampNs;
+}
+
+void *BarometerAcquisition::acquisitionBackground(void *pContext)
+{
+	BarometerAcquisition *pThis = (BarometerAcquisition *)pContext;
+	pThis->acquire();
+	return NULL;
+}
+
+void BarometerAcquisition::acquire(void)
+{
+	uint32_t uCount = 0;
+
+	const int64_t iConversionUs = BMP180::conversionTimeUs(pSensor->getOversampling());
+
+	while ( running() )
+	{
+		if ( !bContinuous )
+		{
+			(void)pthread_mutex_lock(&sMutex);
+
+			while ( running() && !bRequested )
+				(void)pthread_cond_wait(&sRequest, &sMutex);
+
+			(void)pthread_mutex_unlock(&sMutex);
+
+			if ( !running() )
+				break;
+		}
+
+		struct timespec start, now;
+
+		(void)clock_gettime(CLOCK_MONOTONIC, &start);
+
+		if ( 0 == ( uCount % TEMPERATURE_INTERVAL ) )
+		{
+			eState.store(E_BAROMETER_CONVERTING_TEMPERATURE, std::memory_order_release);
+			(void)pSensor->readTemperature();
+		}
+
+		eState.store(E_BAROMETER_CONVERTING_PRESSURE, std::memory_order_release);
+
+		BarometerSample sample;
+
+		(void)memset(&sample, 0, sizeof(sample));
+
+		pSensor->readSample(sample, false);
+
+		latestSample.write(sample);
+		uConversions++;
+
+		AltitudeEstimate estimate;
+
+		if ( estimator.update(sample, estimate) )
+		{
+			latestEstimate.write(estimate);
+
+			const bool bSeeding = ( E_BASELINE_SEEDING == baselineTracker.getState() );
+
+			// The seeding moves the altitudes, which the filter would take for a climb.
+			if ( bSeeding && ( E_BASELINE_SEEDING != baselineTracker.update(pSensor, sample, estimate) ) )
+				estimator.reset();
+
+			else if ( !bSeeding )
+				(void)baselineTracker.update(pSensor, sample, estimate);
+
+			else
+				;
+		}
+		uCount++;
+
+		// The reads block for the conversion; if they didn't (no sensor), don't spin.
+		(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+		int64_t iElapsedUs = ( ( (int64_t)( now.tv_sec - start.tv_sec ) * 1000000000LL ) + ( now.tv_nsec - start.tv_nsec ) ) / 1000;
+
+		if ( iElapsedUs < iConversionUs )
+			(void)usleep((useconds_t)( iConversionUs - iElapsedUs ));
+
+		(void)pthread_mutex_lock(&sMutex);
+		bRequested = false;
+		eState.store(E_BAROMETER_IDLE, std::memory_order_release);
+		(void)pthread_mutex_unlock(&sMutex);
+	}
+}
@@ -0,0 +1,142 @@
+/*
+	BarometerAcquisition.h - Non-blocking BMP180 conversions for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	The IIO driver's in_pressure_input read stalls for the whole conversion (about 25 ms
+	at BMP180_ULTRA_HIGH_RES), so reading the barometer on the control thread stalls the
+	control. Here a worker thread does the blocking reads. A caller starts a conversion
+	with requestConversion(), which returns at once, and picks up the result on a later
+	tick with getLatest(); or, with start(true), the worker converts back to back and
+	getLatest() always has the newest completed sample and its age.
+
+	The worker also runs an AltitudeEstimator on each sample and publishes its filtered
+	altitude, vertical speed, and apogee through getEstimate(), so control, telemetry, and
+	the UI get them without touching the sensor. The filter starts over with each start().
+	A BaselineTracker, fed from the same samples, keeps the ground level pressure current
+	until launch; it carries on across stop() and start().
+
+	While the worker runs, it owns the sensor; don't read the BMP180 directly.
+
+*/
+
+#ifndef _BAROMETER_ACQUISITION_H
+#define _BAROMETER_ACQUISITION_H
+
+#include <pthread.h>
+#include <atomic>
+#include "BMP180.h"
+#include "AltitudeEstimator.h"
+#include "BaselineTracker.h"
+#include "SeqLock.h"
+
+#define BAROMETER_ACQUISITION_VERSION	1     // software version of this library
+
+typedef enum
+{
+	E_BAROMETER_IDLE					= 0,	// Waiting for a request.
+	E_BAROMETER_CONVERTING_TEMPERATURE	= 1,
+	E_BAROMETER_CONVERTING_PRESSURE		= 2,
+
+	NUM_BAROMETER_STATES				= 3
+
+} E_BAROMETER_STATE;
+
+class BarometerAcquisition
+{
+public:
+	BarometerAcquisition(BMP180 *pSensor);
+	~BarometerAcquisition();
+
+	// Continuous: convert back to back. Otherwise convert once per requestConversion().
+	bool start(const bool bContinuous = true);
+	void stop(void);
+
+	inline bool running(void)
+	{
+		return bRunning.load(std::memory_order_relaxed);
+	}
+
+	// Returns at once; false if a conversion is already under way (its result is coming).
+	bool requestConversion(void);
+
+	inline E_BAROMETER_STATE getState(void)
+	{
+		return eState.load(std::memory_order_acquire);
+	}
+
+	// The newest completed sample; false until there's one.
+	bool getLatest(BarometerSample &sample);
+
+	// The filter's output for the newest sample; false until there's one.
+	bool getEstimate(AltitudeEstimate &estimate);
+
+	// Stops the baseline from following the pressure; call on launch, e.g., on throttle up.
+	inline void freezeBaseline(void)
+	{
+		baselineTracker.freeze();
+	}
+
+	// Back on the pad; see BaselineTracker::rearm().
+	inline void rearmBaseline(const bool bSeed = false)
+	{
+		baselineTracker.rearm(bSeed);
+	}
+
+	inline E_BASELINE_STATE getBaselineState(void)
+	{
+		return baselineTracker.getState();
+	}
+
+	// How old the newest completed sample is, in nanoseconds; negative until there's one.
+	int64_t getAgeNs(void);
+
+	inline uint32_t getConversions(void)
+	{
+		return uConversions.load(std::memory_order_relaxed);
+	}
+
+	// The temperature changes slowly; convert it on every this many pressures.
+	static const uint32_t TEMPERATURE_INTERVAL = 10;
+
+private:
+	BMP180 *pSensor;
+
+	SeqLock<BarometerSample> latestSample;
+	SeqLock<AltitudeEstimate> latestEstimate;
+
+	AltitudeEstimator estimator;			// Only the worker uses it while it runs.
+	BaselineTracker baselineTracker;
+
+	std::atomic<bool> bRunning;
+	std::atomic<E_BAROMETER_STATE> eState;
+	std::atomic<uint32_t> uConversions;
+
+	bool bContinuous;
+	bool bRequested;						// Guarded by sMutex.
+
+	pthread_t sAcquisitionThread;
+	pthread_mutex_t sMutex;
+	pthread_cond_t sRequest;
+
+	static const bool bDebug;
+
+	static void *acquisitionBackground(void *pContext);
+	void acquire(void);
+};
+
+#endif	// _BAROMETER_ACQUISITION_H
@@ -0,0 +1,119 @@
+/*
+	BaselineTracker.cpp - On-pad ground pressure tracking for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <stdio.h>
+
+#include "BaselineTracker.h"
+
+const bool BaselineTracker::bDebug = false;
+
+const double_t BaselineTracker::TIME_CONSTANT_S				= 30.0;
+const uint32_t BaselineTracker::SEED_SAMPLES;
+
+const double_t BaselineTracker::STATIONARY_SPEED			= 0.3;
+const double_t BaselineTracker::STATIONARY_HEIGHT_METERS	= 1.0;
+
+const double_t BaselineTracker::LAUNCH_SPEED				= 1.0;
+const double_t BaselineTracker::LAUNCH_HEIGHT_METERS		= 2.0;
+
+BaselineTracker::BaselineTracker(const double_t dTimeConstant /*= TIME_CONSTANT_S*/) :
+	dTimeConstant(dTimeConstant), eState(E_BASELINE_SEEDING), iRearm(-1),
+	uSeedSamples(0), iLastTimestampNs(0)
+{
+
+}
+
+BaselineTracker::~BaselineTracker()
+{
+
+}
+
+void BaselineTracker::freeze(void)
+{
+	eState.store(E_BASELINE_FROZEN, std::memory_order_release);
+}
+
+void BaselineTracker::rearm(const bool bSeed /*= false*/)
+{
+	iRearm.store(bSeed ? E_BASELINE_SEEDING : E_BASELINE_TRACKING, std::memory_order_release);
+}
+
+E_BASELINE_STATE BaselineTracker::update(BMP180 *pSensor, const BarometerSample &sample, const AltitudeEstimate &estimate)
+{
+	const int32_t iRequested = iRearm.exchange(-1, std::memory_order_acq_rel);
+
+	if ( 0 <= iRequested )
+	{
+		eState.store((E_BASELINE_STATE)iRequested, std::memory_order_release);
+		uSeedSamples = 0, iLastTimestampNs = 0;
+	}
+
+	E_BASELINE_STATE eCurrent = getState();
+
+	double_t dBaseline = pSensor->getBaselinePressure();
+
+	if ( E_BASELINE_FROZEN == eCurrent )
+		return eCurrent;
+
+	else if ( E_BASELINE_SEEDING == eCurrent )
+	{
+		// The first sample replaces the old baseline; the rest make a running mean.
+		uSeedSamples++;
+		dBaseline += ( sample.dRawPressure - dBaseline ) / (double_t)uSeedSamples;
+
+		// A freeze() from another thread wins over the change of state.
+		if ( ( SEED_SAMPLES <= uSeedSamples ) && eState.compare_exchange_strong(eCurrent, E_BASELINE_TRACKING) )
+			eCurrent = E_BASELINE_TRACKING;
+
+		else
+			eCurrent = getState();
+	}
+	else
+	{
+		const double_t dHeight = estimate.dAltitude - pSensor->getBaselineAltitude();
+
+		if ( ( LAUNCH_SPEED < estimate.dVerticalSpeed ) || ( LAUNCH_HEIGHT_METERS < dHeight ) )
+		{
+			freeze();
+
+			if ( bDebug )
+				(void)printf("Launch: the baseline pressure is frozen at %lf mbar(s).\n", dBaseline);
+
+			return E_BASELINE_FROZEN;
+		}
+
+		// Only a vehicle sitting on the pad measures the ground's pressure.
+		if ( ( STATIONARY_SPEED > fabs(estimate.dVerticalSpeed) ) && ( STATIONARY_HEIGHT_METERS > fabs(dHeight) ) &&
+			( 0 != iLastTimestampNs ) && ( sample.iTimestampNs > iLastTimestampNs ) )
+		{
+			const double_t dt = ( sample.iTimestampNs - iLastTimestampNs ) * 1e-9;
+
+			dBaseline += ( sample.dRawPressure - dBaseline ) * ( dt / ( dTimeConstant + dt ) );
+		}
+	}
+
+	iLastTimestampNs = sample.iTimestampNs;
+
+	if ( E_BASELINE_FROZEN != eCurrent )
+		pSensor->setBaselinePressure(dBaseline);
+
+	return eCurrent;
+}
@@ -0,0 +1,103 @@
+/*
+	BaselineTracker.h - On-pad ground pressure tracking for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	BMP180::getOffsets() fixes the ground level pressure once, so weather moving the ambient
+	pressure during a long wait on the pad shows up as altitude. The tracker keeps refining
+	the BMP180's baseline pressure while the vehicle sits still: first a running mean of
+	SEED_SAMPLES samples, replacing whatever baseline the profile had, then a first order
+	low pass with a time constant of TIME_CONSTANT_S seconds.
+
+	It only follows the pressure while the AltitudeEstimate says the vehicle is still, and
+	freezes for good on a launch: a climb faster than LAUNCH_SPEED, a height more than
+	LAUNCH_HEIGHT_METERS over the baseline, or a call to freeze(), e.g., on throttle up.
+	rearm() starts it over once the vehicle is back on the pad.
+
+	BarometerAcquisition runs it on its worker thread, which owns the sensor; freeze(),
+	rearm(), and getState() may be called from any thread.
+
+*/
+
+#ifndef _BASELINE_TRACKER_H
+#define _BASELINE_TRACKER_H
+
+#include <inttypes.h>
+#include <math.h>
+#include <atomic>
+#include "BMP180.h"
+#include "AltitudeEstimator.h"
+
+#define BASELINE_TRACKER_VERSION	1     	// software version of this library
+
+typedef enum
+{
+	E_BASELINE_SEEDING		= 0,			// Averaging the first samples.
+	E_BASELINE_TRACKING		= 1,			// Following the pressure slowly.
+	E_BASELINE_FROZEN		= 2,			// Launched; the baseline stays put.
+
+	NUM_BASELINE_STATES		= 3
+
+} E_BASELINE_STATE;
+
+class BaselineTracker
+{
+public:
+	BaselineTracker(const double_t dTimeConstant = TIME_CONSTANT_S);
+	~BaselineTracker();
+
+	// Feeds one sample and the estimate made from it; may move the sensor's baseline
+	//	pressure. Returns the state after the sample.
+	E_BASELINE_STATE update(BMP180 *pSensor, const BarometerSample &sample, const AltitudeEstimate &estimate);
+
+	inline E_BASELINE_STATE getState(void)
+	{
+		return eState.load(std::memory_order_acquire);
+	}
+
+	inline bool frozen(void)
+	{
+		return ( E_BASELINE_FROZEN == getState() );
+	}
+
+	void freeze(void);
+
+	// Takes effect on the next sample. bSeed throws the baseline away and averages afresh;
+	//	otherwise tracking resumes from it (e.g., right after getOffsets()).
+	void rearm(const bool bSeed = false);
+
+	static const double_t TIME_CONSTANT_S;
+	static const uint32_t SEED_SAMPLES = 100;
+
+	static const double_t STATIONARY_SPEED;
+	static const double_t STATIONARY_HEIGHT_METERS;
+
+	static const double_t LAUNCH_SPEED;
+	static const double_t LAUNCH_HEIGHT_METERS;
+
+private:
+	double_t dTimeConstant;
+
+	std::atomic<E_BASELINE_STATE> eState;
+	std::atomic<int32_t> iRearm;			// Negative: none; else the state to rearm to.
+
+	uint32_t uSeedSamples;
+	int64_t iLastTimestampNs;
+
+	static const bool bDebug;
+};
+
+#endif	// _BASELINE_TRACKER_H
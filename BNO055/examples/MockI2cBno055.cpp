@@ -0,0 +1,135 @@
+/*
+	MockI2cBno055.cpp - Exercise the i2c-dev BNO055 backend without hardware.
+
+	A MockI2cBus stands in for "/dev/i2c-1" with a BNO055's chip ID and data block. The
+	BNO055 calibrates against one block, then reads another; the example checks the decoded
+	and scaled values, that each sample took one bus transaction, the raw (AMG) mode and
+	decimation, and that a dead bus makes readSample() fail rather than return zeros.
+
+	Usage: MockI2cBno055
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "BNO055.h"
+#include "BNO055I2cBackend.h"
+#include "ImuDecimator.h"
+#include "MockI2cBus.h"
+
+// Sixteen bit value number j of data block n (in register order); negative values exercise the sign extension.
+static int16_t blockValue(const int32_t n, const int32_t j)
+{
+	return (int16_t)( ( ( n * 100 ) + j ) * ( ( j & 1 ) ? -1 : 1 ) );
+}
+
+static void setDataBlock(MockI2cBus &bus, const int32_t n)
+{
+	uint8_t auBlock[BNO055I2cBackend::DATA_SIZE];
+
+	for ( uint32_t j = 0 ; j < ( BNO055I2cBackend::DATA_SIZE / 2 ) ; j++ )
+	{
+		uint16_t u = (uint16_t)blockValue(n, j);
+		auBlock[2 * j] = (uint8_t)( u & 0xff );
+		auBlock[( 2 * j ) + 1] = (uint8_t)( u >> 8 );
+	}
+
+	bus.setRegisters(BNO055I2cBackend::DATA_REGISTER, auBlock, sizeof(auBlock));
+}
+
+static bool check(const char *pName, const double_t dValue, const double_t dExpected)
+{
+	if ( fabs(dValue - dExpected) <= 1e-9 )
+		return true;
+
+	(void)printf("%s: expected %lf, read %lf.\n", pName, dExpected, dValue);
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	MockI2cBus bus(BNO055_I2C_ADDRESS);
+
+	bus.setRegisters(BNO055I2cBackend::CHIP_ID_REGISTER, &BNO055I2cBackend::CHIP_ID, 1);
+	setDataBlock(bus, 1);
+
+	BNO055I2cBackend backend(&bus);
+
+	// No profile; calibrate against block 1.
+	BNO055 sensor(NULL, &backend);
+
+	bool bGood = sensor.calibrated() && ( BNO055I2cBackend::NDOF_MODE == bus.getRegister(BNO055I2cBackend::OPERATION_MODE_REGISTER) ) &&
+		( BNO055I2cBackend::UNITS == bus.getRegister(BNO055I2cBackend::UNIT_SELECT_REGISTER) );
+
+	(void)printf("\"%s\" calibrated with %u samples.\n", sensor.getName(), sensor.getCalibrationSamples());
+
+	setDataBlock(bus, 3);
+
+	const uint32_t uReads = bus.getReads();
+
+	ImuSample sample;
+
+	bGood = sensor.readSample(sample) && bGood;
+	bGood = ( ( uReads + 1 ) == bus.getReads() ) && bGood;
+
+	// Registers 0x08 on: acceleration 0-2, magnetometer 3-5, gyroscope 6-8, heading, roll,
+	//	and pitch 9-11, quaternion 12-15, linear acceleration 16-18, gravity 19-21.
+	//	Block 3 less the block 1 offsets.
+	for ( int32_t i = 0 ; i < 3 ; i++ )
+	{
+		bGood = check("acceleration", sample.dAcceleration[i], ( blockValue(3, i) - blockValue(1, i) ) / 100.0) && bGood;
+		bGood = check("compass", sample.dCompass[i], ( blockValue(3, 3 + i) - blockValue(1, 3 + i) ) / 16.0) && bGood;
+		bGood = check("gyroscope", sample.dGyroscope[i], ( blockValue(3, 6 + i) - blockValue(1, 6 + i) ) / 900.0) && bGood;
+		bGood = check("linear acceleration", sample.dLinearAcceleration[i], ( blockValue(3, 16 + i) - blockValue(1, 16 + i) ) / 100.0) && bGood;
+		bGood = check("gravity", sample.dGravity[i], ( blockValue(3, 19 + i) - blockValue(1, 19 + i) ) / 100.0) && bGood;
+	}
+
+	for ( int32_t i = 0 ; i < 4 ; i++ )
+		bGood = check("quaternion", sample.dQuaternion[i], ( blockValue(3, 12 + i) - blockValue(1, 12 + i) ) / 16.0) && bGood;
+
+	bGood = check("pitch", sample.dOrientation[0], ( blockValue(3, 11) - blockValue(1, 11) ) / 16.0) && bGood;
+	bGood = check("roll", sample.dOrientation[1], ( blockValue(3, 10) - blockValue(1, 10) ) / 16.0) && bGood;
+	bGood = check("yaw", sample.dOrientation[2], ( (uint16_t)blockValue(3, 9) - (uint16_t)blockValue(1, 9) ) / 16.0) && bGood;
+
+	// Raw mode: only the accelerometer, magnetometer, and gyroscope registers are read.
+	bGood = sensor.setOperatingMode(E_BNO055_RAW_MODE) && ( BNO055::RAW_UPDATE_RATE == sensor.getUpdateRate() ) &&
+		( BNO055I2cBackend::AMG_MODE == bus.getRegister(BNO055I2cBackend::OPERATION_MODE_REGISTER) ) && bGood;
+
+	setDataBlock(bus, 3);
+
+	ImuDecimator decimator(4);
+	ImuSample decimated;
+	uint32_t uOutputs = 0;
+
+	for ( int32_t n = 0 ; n < 8 ; n++ )
+	{
+		// The gyroscope's x register steps by 8 counts a sample.
+		uint8_t auGyroscopeX[2] = { (uint8_t)( 8 * n ), 0 };
+
+		bus.setRegisters(BNO055I2cBackend::DATA_REGISTER + 12, auGyroscopeX, sizeof(auGyroscopeX));
+
+		bGood = sensor.readSample(sample) && bGood;
+		bGood = check("raw mode gravity", sample.dGravity[0], -blockValue(1, 19) / 100.0) && bGood;
+
+		if ( decimator.add(sample, decimated) )
+		{
+			// The average of four steps, less the calibration offset.
+			double_t dMean = ( 8.0 * ( ( 4 * uOutputs ) + 1.5 ) - blockValue(1, 6) ) / 900.0;
+
+			bGood = check("decimated gyroscope", decimated.dGyroscope[0], dMean) && ( uOutputs == decimated.uSequence ) && bGood;
+			uOutputs++;
+		}
+	}
+
+	bGood = ( 2 == uOutputs ) && bGood;
+
+	bus.setFailing(true);
+
+	bGood = !sensor.readSample(sample) && ( 1 == backend.getErrors() ) && bGood;
+
+	(void)printf("The mock BNO055 %s.\n", bGood ? "decoded correctly" : "did not decode correctly");
+
+	return bGood ? 0 : 1;
+}
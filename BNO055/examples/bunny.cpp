@@ -35,6 +35,9 @@
 /* Set the delay between fresh samples */
 #define BNO055_SAMPLERATE_DELAY_MS (100)
 
+/* When streaming, the sensor paces the loop; print every tenth sample. */
+#define BNO055_SAMPLES_PER_PRINT (10)
+
 static BNO055 *mySensor = NULL;
 
 static bool bContinue = true;
@@ -71,6 +74,10 @@ static void setup(void)
 {
   mySensor = new BNO055();
 
+  // Use the triggered buffer when there's a trigger set up; else read the sysfs files.
+  if ( !mySensor->startStreaming() )
+    (void)printf("Not streaming; reading each channel.\n");
+
   // Zero the offsets of the sensor here.  
   mySensor->getOffsets();
 
@@ -95,6 +102,23 @@ static void loop(void)
 {
     double_t pitch, roll, yaw;
 
+    if ( mySensor->streaming() )
+    {
+      ImuSample sample;
+
+      (void)memset(&sample, 0, sizeof(sample));
+
+      // Wake exactly when each scan lands; there's no sleep to drift against the sensor.
+      for ( int32_t i = 0 ; i < BNO055_SAMPLES_PER_PRINT ; i++ )
+      {
+        if ( !mySensor->readSample(sample, BNO055::STREAM_TIMEOUT_MS) )
+          (void)printf("No sample for %i ms!\n", BNO055::STREAM_TIMEOUT_MS);
+      }
+
+      (void)printf("Orientation: %lf %lf %lf\n", sample.dOrientation[0], sample.dOrientation[1], sample.dOrientation[2]);
+      return;
+    }
+
     mySensor->readOrientation(pitch, roll, yaw); 
 
     /* The processing sketch expects data as pitch, roll, and yaw. */
@@ -11,39 +11,41 @@
 #include <errno.h>
 
 #include "BNO055.h"
+#include "CalibrationProfile.h"
 
 const bool BNO055::bDebug = false;
 
 const double_t BNO055::UPDATE_RATE = 100.0;
 
+// The gyroscope's 523 Hz bandwidth; about what sysfs or one I2C burst per sample keeps up with.
+const double_t BNO055::RAW_UPDATE_RATE = 400.0;
+
+const int32_t BNO055::STREAM_TIMEOUT_MS;
+const int64_t BNO055::STALE_SAMPLE_AGE_NS;
+
 const char *BNO055::getName(void)
 {
+	if ( NULL != pBackend )
+	{
+		(void)strncpy(achDeviceName, pBackend->getName(), sizeof(achDeviceName) - 1);
+		return (const char *)achDeviceName;
+	}
+
 	// Note: the same path as for the BMP180.
 	const char *pName =
 	{
 		IIO_PATH_PREFACE "/name"
 	};
 
-	if ( bDebug )
-		(void)printf("\nTrying to open \"%s.\"\n", pName);
+	SysfsAttribute nameAttribute(pName);
 
-	pHandle = fopen(pName,"r");
-	
-	if ( NULL == pHandle )
-	{	
-		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pName, strerror(errno));	
-		return (const char *)achDeviceName;		
-	}
+	if ( !nameAttribute.isOpen() )
+		return (const char *)achDeviceName;
 
-	else if ( bDebug )
-		(void)printf("Successfully opened \"%s.\"\n", pName);	
-	else
-		;
-	
 	(void)memset(achDeviceName, '\0', sizeof(achDeviceName));
-	if ( 1 != fscanf(pHandle, "%s", achDeviceName) )
+	if ( !nameAttribute.readString(achDeviceName, sizeof(achDeviceName)) )
 	{
-		(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pName, strerror(errno));
+		;						// Already reported.
 	}
 	else if ( bDebug )
 	{
@@ -51,10 +53,6 @@ const char *BNO055::getName(void)
 	}
 	else
 		;
-
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;
  	
 	return (const char *)achDeviceName;
 };
@@ -84,44 +82,257 @@ void BNO055::getScaleFactors(void)
 
 	for ( int32_t i = 0 ; i < NUMBER_OF_SCALE_FACTORS ; i++ )
 	{
-		if ( bDebug )
-			(void)printf("\nTrying to open \"%s.\"\n", pScales[i]);
+		SysfsAttribute scaleAttribute(pScales[i]);
 
-		pHandle = fopen(pScales[i],"r");
+		if ( !scaleAttribute.isOpen() )
+			break;
+
+		*pScaleFactors[i] = 0.0;
 		
-		if ( NULL == pHandle )
-		{	
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pScales[i], strerror(errno));	
-			break;		
+		if ( !scaleAttribute.readDouble(*pScaleFactors[i]) )
+		{
+			;					// Already reported.
 		}
-
 		else if ( bDebug )
-			(void)printf("Successfully opened \"%s.\"\n", pScales[i]);	
+		{
+			(void)printf("The scale factor reported from \"%s\" is \"%lf.\"\n", pScales[i], *pScaleFactors[i]);
+		}
 		else
 			;
+	}
+	return;
+}
+
+const char *BNO055::pGyroscopePaths[NUMBER_OF_ANGLES] =
+{
+	IIO_PATH_PREFACE "/in_anglvel_x_raw",
+	IIO_PATH_PREFACE "/in_anglvel_y_raw",
+	IIO_PATH_PREFACE "/in_anglvel_z_raw"
+};
+
+const char *BNO055::pAccelerationPaths[NUMBER_OF_AXES] =
+{
+	IIO_PATH_PREFACE "/in_accel_x_raw",
+	IIO_PATH_PREFACE "/in_accel_y_raw",
+	IIO_PATH_PREFACE "/in_accel_z_raw"
+};
+
+const char *BNO055::pLinearAccelerationPaths[NUMBER_OF_AXES] =
+{
+	IIO_PATH_PREFACE "/in_accel_linear_x_raw",
+	IIO_PATH_PREFACE "/in_accel_linear_y_raw",
+	IIO_PATH_PREFACE "/in_accel_linear_z_raw"
+};
+
+const char *BNO055::pGravityPaths[NUMBER_OF_AXES] =
+{
+	IIO_PATH_PREFACE "/in_gravity_x_raw",
+	IIO_PATH_PREFACE "/in_gravity_y_raw",
+	IIO_PATH_PREFACE "/in_gravity_z_raw"
+};
+
+const char *BNO055::pCompassPaths[NUMBER_OF_AXES] =
+{
+	IIO_PATH_PREFACE "/in_magn_x_raw",
+	IIO_PATH_PREFACE "/in_magn_y_raw",
+	IIO_PATH_PREFACE "/in_magn_z_raw"
+};
+
+const char *BNO055::pQuaternionPath =
+{
+	IIO_PATH_PREFACE "/in_rot_quaternion_raw"
+};
+
+const char *BNO055::pOrientationPaths[NUMBER_OF_AXES] =
+{
+	IIO_PATH_PREFACE "/in_rot_pitch_raw",
+	IIO_PATH_PREFACE "/in_rot_roll_raw",
+	IIO_PATH_PREFACE "/in_rot_yaw_raw"
+};
+
+void BNO055::openChannels(void)
+{
+	for ( int32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+	{
+		(void)gyroscopeAttributes[i].open(pGyroscopePaths[i]);
+		(void)accelerationAttributes[i].open(pAccelerationPaths[i]);
+		(void)linearAccelerationAttributes[i].open(pLinearAccelerationPaths[i]);
+		(void)gravityAttributes[i].open(pGravityPaths[i]);
+		(void)compassAttributes[i].open(pCompassPaths[i]);
+		(void)orientationAttributes[i].open(pOrientationPaths[i]);
+	}
+
+	(void)quaternionAttribute.open(pQuaternionPath);
+}
+
+void BNO055::closeChannels(void)
+{
+	for ( int32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+	{
+		gyroscopeAttributes[i].close();
+		accelerationAttributes[i].close();
+		linearAccelerationAttributes[i].close();
+		gravityAttributes[i].close();
+		compassAttributes[i].close();
+		orientationAttributes[i].close();
+	}
+
+	quaternionAttribute.close();
+}
+
+void BNO055::readRawChannels(SysfsAttribute *pAttributes, int32_t *pValues[], const int32_t nValues,
+	const int32_t iFrameIndex, const char *pDescription)
+{
+	if ( streaming() || ( ( NULL != pBackend ) && readBackendFrame() ) )
+	{
+		for ( int32_t i = 0 ; i < nValues ; i++ )
+			*pValues[i] = aiFrame[iFrameIndex + i];
+		return;
+	}
+
+	for ( int32_t i = 0 ; i < nValues ; i++ )
+		*pValues[i] = 0;
+
+	for ( int32_t i = 0 ; i < nValues ; i++ )
+	{
+		if ( !pAttributes[i].isOpen() )
+			break;				// Reported when opened.
 		
-		*pScaleFactors[i] = 0.0;
-		
-		if ( 1 != fscanf(pHandle, "%lf", pScaleFactors[i]) )
+		if ( !pAttributes[i].readInteger(*pValues[i]) )
 		{
-			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pScales[i], strerror(errno));
+			;					// Already reported.
 		}
 		else if ( bDebug )
 		{
-			(void)printf("The scale factor reported from \"%s\" is \"%lf.\"\n", pScales[i], *pScaleFactors[i]);
+			(void)printf("The raw %s value from \"%s\" is \"%i.\"\n", pDescription, pAttributes[i].getPath(), *pValues[i]);
 		}
 		else
 			;
+	}
+}
+
+const int32_t BNO055::NUMBER_OF_STREAM_CHANNELS;
+
+const StreamChannel BNO055::streamChannels[NUMBER_OF_STREAM_CHANNELS] =
+{
+	{ "in_anglvel_x",		FRAME_GYROSCOPE,				1 },
+	{ "in_anglvel_y",		FRAME_GYROSCOPE + 1,			1 },
+	{ "in_anglvel_z",		FRAME_GYROSCOPE + 2,			1 },
+	{ "in_accel_x",			FRAME_ACCELERATION,				1 },
+	{ "in_accel_y",			FRAME_ACCELERATION + 1,			1 },
+	{ "in_accel_z",			FRAME_ACCELERATION + 2,			1 },
+	{ "in_accel_linear_x",	FRAME_LINEAR_ACCELERATION,		1 },
+	{ "in_accel_linear_y",	FRAME_LINEAR_ACCELERATION + 1,	1 },
+	{ "in_accel_linear_z",	FRAME_LINEAR_ACCELERATION + 2,	1 },
+	{ "in_gravity_x",		FRAME_GRAVITY,					1 },
+	{ "in_gravity_y",		FRAME_GRAVITY + 1,				1 },
+	{ "in_gravity_z",		FRAME_GRAVITY + 2,				1 },
+	{ "in_magn_x",			FRAME_COMPASS,					1 },
+	{ "in_magn_y",			FRAME_COMPASS + 1,				1 },
+	{ "in_magn_z",			FRAME_COMPASS + 2,				1 },
+	{ "in_rot_quaternion",	FRAME_QUATERNION,				4 },
+	{ "in_rot_pitch",		FRAME_ORIENTATION,				1 },
+	{ "in_rot_roll",		FRAME_ORIENTATION + 1,			1 },
+	{ "in_rot_yaw",			FRAME_ORIENTATION + 2,			1 }
+};
+
+bool BNO055::startStreaming(const char *pTriggerName /*= NULL*/,
+	const char *pSysfsPath /*= IIO_PATH_PREFACE*/, const char *pDevicePath /*= IIO_DEVICE_PATH*/)
+{
+	stopStreaming();
 
-		if ( NULL!=pHandle )
-			(void)fclose(pHandle);
-		pHandle = NULL;	
+	if ( NULL != pBackend )
+	{
+		(void)printf("Streaming needs the IIO driver; \"%s\" reads each frame in one transaction already.\n", pBackend->getName());
+		return false;
 	}
-	return;
+
+	pStream = new IioBuffer(pSysfsPath, pDevicePath);
+
+	bool bSuccess = true;
+
+	for ( int32_t i = 0 ; bSuccess && ( i < NUMBER_OF_STREAM_CHANNELS ) ; i++ )
+	{
+		aiStreamChannels[i] = pStream->addChannel(streamChannels[i].pName);
+		bSuccess = ( 0 <= aiStreamChannels[i] );
+	}
+
+	if ( !bSuccess )
+		;						// Already reported.
+
+	else if ( 0 > pStream->addChannel("in_timestamp") )
+		bSuccess = false;
+
+	else if ( ( NULL != pTriggerName ) && !pStream->setTrigger(pTriggerName) )
+		bSuccess = false;
+
+	else if ( !( bKernelMonotonic = pStream->setTimestampClock("monotonic") ) )
+		(void)printf("Converting the scan timestamps from CLOCK_REALTIME instead.\n");
+
+	else if ( !pStream->enable() )
+		bSuccess = false;
+
+	else if ( bDebug )
+		(void)printf("Streaming %u byte scans from \"%s.\"\n", pStream->getScanSize(), pDevicePath);
+
+	else
+		;
+
+	if ( !bSuccess )
+		stopStreaming();
+
+	return bSuccess;
+}
+
+void BNO055::stopStreaming(void)
+{
+	if ( NULL == pStream )
+		return;
+
+	delete pStream;
+	pStream = NULL;
 }
 
-BNO055::BNO055() :
-	bCalibrated(false), pHandle(NULL),
+// How far CLOCK_REALTIME is ahead of CLOCK_MONOTONIC right now.
+static int64_t realtimeOffsetNs(void)
+{
+	struct timespec realtime, monotonic;
+
+	(void)clock_gettime(CLOCK_REALTIME, &realtime);
+	(void)clock_gettime(CLOCK_MONOTONIC, &monotonic);
+
+	return ( (int64_t)( realtime.tv_sec - monotonic.tv_sec ) * 1000000000LL ) + ( realtime.tv_nsec - monotonic.tv_nsec );
+}
+
+bool BNO055::readFrame(const int32_t iTimeoutMs /*= -1*/)
+{
+	if ( !streaming() )
+		return false;
+
+	if ( !pStream->readScan(iTimeoutMs) )
+	{
+		if ( pStream->timedOut() )
+			uTimeouts++;
+		return false;
+	}
+
+	for ( int32_t i = 0 ; i < NUMBER_OF_STREAM_CHANNELS ; i++ )
+	{
+		for ( int32_t j = 0 ; j < streamChannels[i].nValues ; j++ )
+			aiFrame[streamChannels[i].iFrameIndex + j] = (int32_t)pStream->getValue(aiStreamChannels[i], j);
+	}
+
+	iFrameTimestamp = pStream->getTimestamp();
+
+	if ( !bKernelMonotonic )
+		iFrameTimestamp -= realtimeOffsetNs();
+
+	return true;
+}
+
+BNO055::BNO055(const char *pProfilePath /*= BNO055_PROFILE_PATH*/, BNO055Backend *pBackend /*= NULL*/) :
+	bCalibrated(false), pStream(NULL), bKernelMonotonic(false), eMode(E_BNO055_FUSION_MODE), pBackend(pBackend), iFrameTimestamp(0), uSampleSequence(0), uSampleChannels(E_SAMPLE_ALL), uTimeouts(0), uRepeatedSamples(0),
+	uCalibrationPercent(0), uCalibrationSamples(0), uRejectedSamples(0),
 	in_accel_scale(0.0), in_magn_scale(0.0), in_anglvel_scale(0.0), 
 	in_gravity_scale(0.0), in_rot_scale(0.0), 
 	
@@ -143,31 +354,63 @@ BNO055::BNO055() :
 	in_orientation_roll_offset(0), in_orientation_pitch_offset(0), in_orientation_yaw_offset(0)
 
 {
-	// 03/11/2024: I don't know why the sensor stops producing output and this fixes it.
-    (void)system("sudo modprobe -r bno055_i2c");
-    (void)system("sudo modprobe bno055_i2c");
+	(void)memset(achDeviceName, '\0', sizeof(achDeviceName));
+	(void)memset(aiStreamChannels, 0, sizeof(aiStreamChannels));
+	(void)memset(aiFrame, 0, sizeof(aiFrame));
+	(void)memset(aiLastRaw, 0, sizeof(aiLastRaw));
+	(void)memset(&calibrationNoise, 0, sizeof(calibrationNoise));
 
+	if ( NULL != pBackend )
+	{
+		if ( !pBackend->open() )
+			return;				// Reported by the backend; the readings stay zero.
 
-	(void)memset(achDeviceName, '\0', sizeof(achDeviceName));
+		(void)getName();
+		pBackend->getScaleFactors(in_accel_scale, in_magn_scale, in_anglvel_scale, in_gravity_scale, in_rot_scale);
+	}
+	else
+	{
+		(void)getName();
 
-	(void)getName();
-	getScaleFactors();
-	getOffsets(NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_SECOND);
+		// 03/11/2024: I don't know why the sensor stops producing output and this fixes it.
+		//	Reloading takes seconds, so only do it when the device isn't answering.
+		if ( '\0' == achDeviceName[0] )
+		{
+			(void)system("sudo modprobe -r bno055_i2c");
+			(void)system("sudo modprobe bno055_i2c");
+			(void)getName();
+		}
+
+		getScaleFactors();
+		openChannels();
+	}
+
+	if ( ( NULL != pProfilePath ) && loadProfile(pProfilePath) && checkDrift() )
+	{
+		if ( bDebug )
+			(void)printf("Using the calibration profile \"%s.\"\n", pProfilePath);
+	}
+	else
+	{
+		getOffsets(NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_SECOND);
+
+		if ( bCalibrated && ( NULL != pProfilePath ) )
+			(void)saveProfile(pProfilePath);
+	}
 }
 
 BNO055::~BNO055() 
 {	
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;
+	stopStreaming();
+	closeChannels();
 	bCalibrated = false;
 }
 
-const int32_t BNO055::NUMBER_OF_ANGLES		=3;
+const int32_t BNO055::NUMBER_OF_ANGLES;
 
-const int32_t BNO055::NUMBER_OF_AXES		= 3;
+const int32_t BNO055::NUMBER_OF_AXES;
 
-const int32_t BNO055::NUMBER_OF_QUATERNIONS	= 4;
+const int32_t BNO055::NUMBER_OF_QUATERNIONS;
 
 void BNO055::readGyroscope(double_t &x, double_t &y, double_t &z)
 {
@@ -178,9 +421,9 @@ void BNO055::readGyroscope(double_t &x, double_t &y, double_t &z)
 		&x, &y, &z
 	};
 
-	double_t *pXYZ[NUMBER_OF_ANGLES] =
+	int32_t *pXYZ[NUMBER_OF_ANGLES] =
 	{
-		(double_t *)&ix, (double_t *)&iy, (double_t *)&iz
+		&ix, &iy, &iz
 	};
 
 	int32_t *prXYZOffsets[NUMBER_OF_ANGLES] =
@@ -212,275 +455,341 @@ const uint32_t BNO055::NUMBER_OF_OFFSET_SAMPLES_FOR_FIVE_MINUTES	= ( 5 * NUMBER_
 
 // Todo: review gain and offset calculations for references.
 
+const uint32_t BNO055::MIN_CALIBRATION_SAMPLES						= ( 100 );
 
-#define SIGNED_ROUND(x) if(x<0)x-=(uN/2);else x+=(uN/2);
+const double_t BNO055::CALIBRATION_TOLERANCE_LSB					= 0.5;
 
-void BNO055::getOffsets(const uint32_t uN /*= NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_MINUTE*/)
-{
-	bCalibrated = false;
+const double_t BNO055::CALIBRATION_CONFIDENCE_Z						= 1.96;
 
-	int64_t x_sum = 0, y_sum = 0, z_sum = 0,
-		xx_sum = 0, yy_sum = 0, zz_sum = 0,
-		xxx_sum = 0, yyy_sum = 0, zzz_sum = 0,
-		xxxx_sum = 0, yyyy_sum = 0, zzzz_sum = 0,
-		xxxxx_sum = 0, yyyyy_sum = 0, zzzzz_sum = 0,
-		qw_sum = 0, qx_sum = 0, qy_sum = 0, qz_sum = 0,
-		pitch_sum = 0, roll_sum = 0, yaw_sum = 0;
+const double_t BNO055::OUTLIER_SIGMAS								= 6.0;
 
-	int32_t ix = 0, iy = 0, iz = 0,
-		iqw = 0, iqx = 0, iqy = 0, iqz =0,
-		ip = 0, ir =0;
+const double_t BNO055::OUTLIER_FLOOR_LSB							= 3.0;
 
-	for ( uint32_t i = 0 ; i < uN ; i++ )
-	{
-		int32_t x = 0, y = 0, z = 0, 
-			xx = 0, yy = 0, zz = 0, 
-			xxx = 0, yyy = 0, zzz = 0,
-			xxxx = 0, yyyy = 0, zzzz = 0,
-			xxxxx = 0, yyyyy = 0, zzzzz = 0,
-			qw = 0, qx = 0, qy = 0, qz = 0,
-			pitch = 0, roll = 0, yaw = 0;
-		readRawGyroscopeValues(x, y, z);
-		readRawAccelerations(xx, yy, zz);
-		readRawLinearAccelerations(xxx, yyy, zzz);
-		readRawGravityValues(xxxx, yyyy, zzzz);
-		readRawCompassAngles(xxxxx, yyyyy, zzzzz);
-		readRawQuaternions(qw, qx, qy, qz);
-		readRawOrientation(pitch, roll, yaw);
-		pitch_sum += pitch, roll_sum += roll, yaw_sum += yaw;
-		qw_sum += qw, qx_sum += qx, qy_sum += qy, qz_sum += qz;
-		xxxxx_sum += xxxxx, yyyyy_sum += yyyyy, zzzzz_sum += zzzzz;
-		xxxx_sum += xxxx, yyyy_sum += yyyy, zzzz_sum += zzzz;
-		xxx_sum += xxx, yyy_sum += yyy, zzz_sum += zzz;
-		xx_sum += xx, yy_sum += yy, zz_sum += zz;
-		x_sum += x, y_sum += y, z_sum += z;
-		(void)usleep(BNO055_SAMPLE_DELAY_US);
-	}
+// Welford's running mean and variance, kept in Q8 fixed point in 64-bit integers.
+//	The raw values are at most 16 bits, so even the squared differences fit easily.
+static const int32_t WELFORD_Q = 8;
 
-	SIGNED_ROUND(x_sum)
-	x_sum /= (int64_t)uN;
+static void welfordAdd(WelfordState &state, const int32_t iValue)
+{
+	state.n++;
 
-	SIGNED_ROUND(y_sum)
-	y_sum /= (int64_t)uN;
+	const int64_t iValueQ = (int64_t)iValue * ( 1 << WELFORD_Q );
+	const int64_t iDelta = iValueQ - state.iMeanQ;
 
-	SIGNED_ROUND(z_sum)
-	z_sum /= (int64_t)uN;
+	state.iMeanQ += iDelta / state.n;
 
-	ix = x_sum, iy = y_sum, iz = z_sum;
+	const int64_t iDelta2 = iValueQ - state.iMeanQ;
 
-	writeRawGyroscopeOffsets(ix, iy, iz);
+	state.iM2Q += ( iDelta * iDelta2 ) >> WELFORD_Q;
+}
 
-	SIGNED_ROUND(xx_sum)
-	xx_sum /= (int64_t)uN;
+static double_t welfordMean(const WelfordState &state)
+{
+	return (double_t)state.iMeanQ / (double_t)( 1 << WELFORD_Q );
+}
 
-	SIGNED_ROUND(yy_sum)
-	yy_sum /= (int64_t)uN;
+static double_t welfordVariance(const WelfordState &state)
+{
+	if ( 2 > state.n )
+		return 0.0;
 
-	SIGNED_ROUND(zz_sum)
-	zz_sum /= (int64_t)uN;
+	return (double_t)state.iM2Q / (double_t)( 1 << WELFORD_Q ) / (double_t)( state.n - 1 );
+}
 
-	ix = xx_sum, iy = yy_sum, iz = zz_sum;
+static int32_t welfordRoundedMean(const WelfordState &state)
+{
+	const int64_t iHalf = (int64_t)1 << ( WELFORD_Q - 1 );
 
-	writeRawAccelerationOffsets(ix, iy, iz);
+	return (int32_t)( ( 0 > state.iMeanQ ) ? -( ( -state.iMeanQ + iHalf ) >> WELFORD_Q ) : ( ( state.iMeanQ + iHalf ) >> WELFORD_Q ) );
+}
 
-	SIGNED_ROUND(xxx_sum)
-	xxx_sum /= (int64_t)uN;
+void BNO055::getOffsets(const uint32_t uN /*= NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_MINUTE*/)
+{
+	bCalibrated = false;
 
-	SIGNED_ROUND(yyy_sum)
-	yyy_sum /= (int64_t)uN;
+	uCalibrationPercent = 0, uCalibrationSamples = 0, uRejectedSamples = 0;
 
-	SIGNED_ROUND(zzz_sum)
-	zzz_sum /= (int64_t)uN;
+	WelfordState states[NUMBER_OF_FRAME_VALUES];
 
-	ix = xxx_sum, iy = yyy_sum, iz = zzz_sum;
+	(void)memset(states, 0, sizeof(states));
 
-	writeRawLinearAccelerationOffsets(ix, iy, iz);
+	bool bConverged = false;
 
-	SIGNED_ROUND(xxxx_sum)
-	xxxx_sum /= (int64_t)uN;
+	// uN is the most samples to take; it stops once every mean is known well enough.
+	for ( uint32_t i = 0 ; ( i < uN ) && !bConverged ; i++ )
+	{
+		// In streaming mode, each scan paces the loop instead of the sleep.
+		if ( streaming() && !readFrame(STREAM_TIMEOUT_MS) )
+			continue;
 
-	SIGNED_ROUND(yyyy_sum)
-	yyyy_sum /= (int64_t)uN;
+		int32_t aiRaw[NUMBER_OF_FRAME_VALUES];
 
-	SIGNED_ROUND(zzzz_sum)
-	zzzz_sum /= (int64_t)uN;
+		if ( !readRawFrame(aiRaw) )
+			continue;
 
-	ix = xxxx_sum, iy = yyyy_sum, iz = zzzz_sum;
+		if ( !streaming() )
+			(void)usleep(BNO055_SAMPLE_DELAY_US);
 
-	writeRawGravityOffsets(ix, iy, iz);
+		// Once the statistics settle, a sample far from the mean is the pad moving; skip it.
+		//	The quaternion and the orientation wrap (the heading at 360 degrees, the quaternion
+		//	to its negative), so their spread says nothing about the pad; they're left out.
+		bool bOutlier = false;
 
-	SIGNED_ROUND(xxxxx_sum)
-	xxxxx_sum /= (int64_t)uN;
+		for ( int32_t j = 0 ; ( j < FRAME_QUATERNION ) && ( MIN_CALIBRATION_SAMPLES <= states[0].n ) ; j++ )
+		{
+			double_t dLimit = ( OUTLIER_SIGMAS * sqrt(welfordVariance(states[j])) ) + OUTLIER_FLOOR_LSB;
 
-	SIGNED_ROUND(yyyyy_sum)
-	yyyyy_sum /= (int64_t)uN;
+			if ( fabs((double_t)aiRaw[j] - welfordMean(states[j])) > dLimit )
+			{
+				bOutlier = true;
+				break;
+			}
+		}
 
-	SIGNED_ROUND(zzzzz_sum)
-	zzzzz_sum /= (int64_t)uN;
+		if ( bOutlier )
+		{
+			uRejectedSamples++;
+			continue;
+		}
+
+		for ( int32_t j = 0 ; j < NUMBER_OF_FRAME_VALUES ; j++ )
+			welfordAdd(states[j], aiRaw[j]);
+
+		uCalibrationSamples = (uint32_t)states[0].n;
 
-	ix = xxxxx_sum, iy = yyyyy_sum, iz = zzzzz_sum;
+		// The samples the noisiest channel needs for its confidence interval to fit the tolerance;
+		//	again not the wrapping ones.
+		double_t dNeeded = (double_t)MIN_CALIBRATION_SAMPLES;
 
-	writeRawCompassOffsets(ix, iy, iz);
+		for ( int32_t j = 0 ; j < FRAME_QUATERNION ; j++ )
+		{
+			double_t dSamples = CALIBRATION_CONFIDENCE_Z * CALIBRATION_CONFIDENCE_Z * welfordVariance(states[j]) /
+				( CALIBRATION_TOLERANCE_LSB * CALIBRATION_TOLERANCE_LSB );
 
-	SIGNED_ROUND(qw_sum)
-	qw_sum /= (int64_t)uN;
+			if ( dSamples > dNeeded )
+				dNeeded = dSamples;
+		}
 
-	SIGNED_ROUND(qx_sum)
-	qx_sum /= (int64_t)uN;
+		if ( (double_t)uN < dNeeded )
+			dNeeded = (double_t)uN;
 
-	SIGNED_ROUND(qy_sum)
-	qy_sum /= (int64_t)uN;
+		uint32_t uPercent = (uint32_t)( ( 100.0 * (double_t)states[0].n ) / dNeeded );
 
-	SIGNED_ROUND(qz_sum)
-	qz_sum /= (int64_t)uN;
+		uCalibrationPercent = ( 100 < uPercent ) ? 100 : uPercent;
 
-	iqw = qw_sum, iqx = qx_sum, iqy = qy_sum, iqz = qz_sum; 
+		bConverged = ( MIN_CALIBRATION_SAMPLES <= states[0].n ) && ( (double_t)states[0].n >= dNeeded );
+	}
 
-	writeRawQuaternionOffsets(iqw, iqx, iqy, iqz);
+	if ( 0 == states[0].n )
+	{
+		(void)printf("%s: there were no samples to calibrate with!\n", __FUNCTION__);
+		return;
+	}
 
-	SIGNED_ROUND(pitch_sum)
-	pitch_sum /= (int64_t)uN;
+	int32_t aiOffsets[NUMBER_OF_FRAME_VALUES];
+	double_t adScales[NUMBER_OF_FRAME_VALUES];
+	double_t *pNoise[NUMBER_OF_FRAME_VALUES];
 
-	SIGNED_ROUND(roll_sum)
-	roll_sum /= (int64_t)uN;
+	getFrameScales(adScales);
+	getSampleValues(calibrationNoise, pNoise);
 
-	SIGNED_ROUND(yaw_sum)
-	yaw_sum /= (int64_t)uN;
+	for ( int32_t j = 0 ; j < NUMBER_OF_FRAME_VALUES ; j++ )
+	{
+		aiOffsets[j] = welfordRoundedMean(states[j]);
+		*pNoise[j] = adScales[j] * sqrt(welfordVariance(states[j]));
+	}
 
-	ip = pitch_sum, ir = roll_sum, iy = yaw_sum;
+	calibrationNoise.iTimestampNs = timestampNow();
+	calibrationNoise.uSequence = uCalibrationSamples;
 
-	writeRawOrientationOffsets(ip, ir, iy);
+	setFrameOffsets(aiOffsets);
 
+	uCalibrationPercent = 100;
 
-	if ( bDebug )
+	if ( bDebug || !bConverged )
 	{
-		(void)printf("\nThe gyroscope offsets are %d (x) %d (y) %d (z)\n", (int32_t)x_sum, (int32_t)y_sum, (int32_t)z_sum);
-		(void)printf("The acceleration offsets are %d (x) %d (y) %d (z)\n", (int32_t)xx_sum, (int32_t)yy_sum, (int32_t)zz_sum);	
-		(void)printf("The linear acceleration offsets are %d (x) %d (y) %d (z)\n", (int32_t)xxx_sum, (int32_t)yyy_sum, (int32_t)zzz_sum);		
-		(void)printf("The gravity offsets are %d (x) %d (y) %d (z)\n", (int32_t)xxxx_sum, (int32_t)yyyy_sum, (int32_t)zzzz_sum);		
-		(void)printf("The magnetometer offsets are %d (x) %d (y) %d (z)\n", (int32_t)xxxxx_sum, (int32_t)yyyyy_sum, (int32_t)zzzzz_sum);			
-		(void)printf("The quaternion offsets are %d (w) %d (x) %d (y) %d (z)\n", (int32_t)qw_sum, (int32_t)qx_sum, (int32_t)qy_sum, (int32_t)qz_sum);			
-		(void)printf("The orientation (rotation) offsets are %d (pitch) %d (roll) %d (yaw)\n\n", (int32_t)pitch_sum, (int32_t)roll_sum, (int32_t)yaw_sum);
+		(void)printf("\n%s: %u samples (%u rejected) %s.\n", __FUNCTION__, getCalibrationSamples(), getRejectedSamples(),
+			bConverged ? "converged" : "did not converge");
+		(void)printf("The gyroscope offsets are %d (x) %d (y) %d (z); noise %lf %lf %lf\n",
+			aiOffsets[0], aiOffsets[1], aiOffsets[2], *pNoise[0], *pNoise[1], *pNoise[2]);
+		(void)printf("The acceleration offsets are %d (x) %d (y) %d (z); noise %lf %lf %lf\n",
+			aiOffsets[3], aiOffsets[4], aiOffsets[5], *pNoise[3], *pNoise[4], *pNoise[5]);
+		(void)printf("The magnetometer offsets are %d (x) %d (y) %d (z); noise %lf %lf %lf\n",
+			aiOffsets[12], aiOffsets[13], aiOffsets[14], *pNoise[12], *pNoise[13], *pNoise[14]);
+		(void)printf("The orientation (rotation) offsets are %d (pitch) %d (roll) %d (yaw); noise %lf %lf %lf\n\n",
+			aiOffsets[19], aiOffsets[20], aiOffsets[21], *pNoise[19], *pNoise[20], *pNoise[21]);
 	}
 
 	bCalibrated = true;
 
 }
 
-void BNO055::writeRawGyroscopeOffsets(int32_t &x, int32_t &y, int32_t &z)
+const uint32_t BNO055::DRIFT_CHECK_SAMPLES							= ( 20 );
+
+const double_t BNO055::DRIFT_TOLERANCE_LSB							= 5.0;
+
+const uint32_t BNO055::PROFILE_MAGIC								= 0x35354f42;	// "BO55"
+
+const uint32_t BNO055::PROFILE_VERSION								= 1;
+
+bool BNO055::saveProfile(const char *pPath /*= BNO055_PROFILE_PATH*/)
 {
-	in_anglvel_x_offset = x;
-	in_anglvel_y_offset = y;
-	in_anglvel_z_offset = z;
+	if ( !bCalibrated )
+		return false;
+
+	Profile profile;
+	double_t *pNoise[NUMBER_OF_FRAME_VALUES];
+
+	(void)memset(&profile, 0, sizeof(profile));
+
+	getFrameOffsets(profile.aiOffsets);
+	getFrameScales(profile.adScales);
+	getSampleValues(calibrationNoise, pNoise);
+
+	for ( int32_t j = 0 ; j < NUMBER_OF_FRAME_VALUES ; j++ )
+		profile.adNoiseLsb[j] = ( 0.0 != profile.adScales[j] ) ? ( *pNoise[j] / profile.adScales[j] ) : 0.0;
+
+	profile.uSamples = uCalibrationSamples;
+
+	return CalibrationProfile::save(pPath, PROFILE_MAGIC, PROFILE_VERSION, &profile, sizeof(profile));
 }
 
-void BNO055::readRawGyroscopeValues(int32_t &x, int32_t &y, int32_t &z)
+bool BNO055::loadProfile(const char *pPath /*= BNO055_PROFILE_PATH*/)
 {
-	x = y = z = 0;
+	Profile profile;
+
+	if ( !CalibrationProfile::load(pPath, PROFILE_MAGIC, PROFILE_VERSION, &profile, sizeof(profile)) )
+		return false;
+
+	double_t adScales[NUMBER_OF_FRAME_VALUES];
+
+	getFrameScales(adScales);
 
-	const char *pAngles[NUMBER_OF_ANGLES] =
+	// A different range or unit setting in the driver makes the offsets meaningless.
+	for ( int32_t j = 0 ; j < NUMBER_OF_FRAME_VALUES ; j++ )
 	{
-		{ IIO_PATH_PREFACE "/in_anglvel_x_raw"   },
-		{ IIO_PATH_PREFACE "/in_anglvel_y_raw"   },
-		{ IIO_PATH_PREFACE "/in_anglvel_z_raw"	}
-	};
+		if ( fabs(adScales[j] - profile.adScales[j]) > ( 1e-9 * fabs(adScales[j]) ) )
+		{
+			(void)printf("The scale factors changed since \"%s\" was saved; recalibrating.\n", pPath);
+			return false;
+		}
+	}
 
-	int32_t *pXYZ[NUMBER_OF_ANGLES] =
+	double_t *pNoise[NUMBER_OF_FRAME_VALUES];
+
+	getSampleValues(calibrationNoise, pNoise);
+
+	for ( int32_t j = 0 ; j < NUMBER_OF_FRAME_VALUES ; j++ )
+		*pNoise[j] = profile.adNoiseLsb[j] * adScales[j];
+
+	calibrationNoise.iTimestampNs = timestampNow();
+	calibrationNoise.uSequence = profile.uSamples;
+
+	setFrameOffsets(profile.aiOffsets);
+
+	uCalibrationSamples = profile.uSamples, uRejectedSamples = 0, uCalibrationPercent = 100;
+
+	bCalibrated = true;
+
+	return true;
+}
+
+bool BNO055::checkDrift(void)
+{
+	// The channels that read the same whenever the rocket sits on the pad.
+	static const int32_t aiChecked[] =
 	{
-		(int32_t *)&x, (int32_t *)&y, (int32_t *)&z
+		FRAME_GYROSCOPE, FRAME_GYROSCOPE + 1, FRAME_GYROSCOPE + 2,
+		FRAME_ACCELERATION, FRAME_ACCELERATION + 1, FRAME_ACCELERATION + 2,
+		FRAME_GRAVITY, FRAME_GRAVITY + 1, FRAME_GRAVITY + 2
 	};
 
-	for ( int32_t i = 0 ; i < NUMBER_OF_ANGLES ; i++ )
+	static const int32_t NUMBER_CHECKED = sizeof(aiChecked) / sizeof(aiChecked[0]);
+
+	int64_t aiSums[NUMBER_CHECKED] = { 0 };
+
+	uint32_t n = 0;
+
+	for ( uint32_t i = 0 ; i < DRIFT_CHECK_SAMPLES ; i++ )
 	{
-		if ( bDebug )
-			(void)printf("\nTrying to open \"%s.\"\n", pAngles[i]);
+		if ( streaming() && !readFrame(STREAM_TIMEOUT_MS) )
+			continue;
 
-		pHandle = fopen(pAngles[i],"r");
-		
-		if ( NULL == pHandle )
-		{	
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pAngles[i], strerror(errno));	
-			break;		
-		}
+		int32_t aiRaw[NUMBER_OF_FRAME_VALUES];
 
-		else if ( bDebug )
-			(void)printf("Successfully opened \"%s.\"\n", pAngles[i]);	
-		else
-			;
-		
-		*pXYZ[i] = 0;
-		
-		if ( 1 != fscanf(pHandle, "%i", pXYZ[i]) )
-		{
-			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pAngles[i], strerror(errno));
-		}
-		else if ( bDebug )
+		if ( !readRawFrame(aiRaw) )
+			continue;
+
+		if ( !streaming() )
+			(void)usleep(BNO055_SAMPLE_DELAY_US);
+
+		for ( int32_t k = 0 ; k < NUMBER_CHECKED ; k++ )
+			aiSums[k] += aiRaw[aiChecked[k]];
+
+		n++;
+	}
+
+	if ( 0 == n )
+		return false;
+
+	int32_t aiOffsets[NUMBER_OF_FRAME_VALUES];
+	double_t adScales[NUMBER_OF_FRAME_VALUES];
+	double_t *pNoise[NUMBER_OF_FRAME_VALUES];
+
+	getFrameOffsets(aiOffsets);
+	getFrameScales(adScales);
+	getSampleValues(calibrationNoise, pNoise);
+
+	bool bSteady = true;
+
+	for ( int32_t k = 0 ; k < NUMBER_CHECKED ; k++ )
+	{
+		const int32_t j = aiChecked[k];
+
+		double_t dNoiseLsb = ( 0.0 != adScales[j] ) ? ( *pNoise[j] / adScales[j] ) : 0.0;
+		double_t dLimit = ( OUTLIER_SIGMAS * dNoiseLsb / sqrt((double_t)n) ) + DRIFT_TOLERANCE_LSB;
+		double_t dDrift = ( (double_t)aiSums[k] / (double_t)n ) - (double_t)aiOffsets[j];
+
+		if ( fabs(dDrift) > dLimit )
 		{
-			(void)printf("The raw Gyroscope value from \"%s\" is \"%i.\"\n", pAngles[i], *pXYZ[i]);
+			if ( bDebug )
+				(void)printf("Frame value %d drifted %lf counts (limit %lf).\n", j, dDrift, dLimit);
+			bSteady = false;
 		}
-		else
-			;
-
-		if ( NULL!=pHandle )
-			(void)fclose(pHandle);
-		pHandle = NULL;	
 	}
 
-	return;
+	if ( !bSteady )
+		(void)printf("The BNO055 drifted from its calibration profile; recalibrating.\n");
+
+	return bSteady;
 }
 
-// That is, acceleration due to forces excluding gravity.
-void BNO055::readRawLinearAccelerations(int32_t &x, int32_t &y, int32_t &z)
+void BNO055::writeRawGyroscopeOffsets(int32_t &x, int32_t &y, int32_t &z)
 {
-	const char *pAccels[NUMBER_OF_AXES] =
+	in_anglvel_x_offset = x;
+	in_anglvel_y_offset = y;
+	in_anglvel_z_offset = z;
+}
+
+void BNO055::readRawGyroscopeValues(int32_t &x, int32_t &y, int32_t &z)
+{
+	int32_t *pXYZ[NUMBER_OF_ANGLES] =
 	{
-		{ IIO_PATH_PREFACE "/in_accel_linear_x_raw"	},
-		{ IIO_PATH_PREFACE "/in_accel_linear_y_raw" },
-		{ IIO_PATH_PREFACE "/in_accel_linear_z_raw"	}
+		(int32_t *)&x, (int32_t *)&y, (int32_t *)&z
 	};
 
+	readRawChannels(gyroscopeAttributes, pXYZ, NUMBER_OF_ANGLES, FRAME_GYROSCOPE, "Gyroscope");
+}
+
+// That is, acceleration due to forces excluding gravity.
+void BNO055::readRawLinearAccelerations(int32_t &x, int32_t &y, int32_t &z)
+{
 	int32_t *pXYZ[NUMBER_OF_AXES] =
 	{
 		(int32_t *)&x, (int32_t *)&y, (int32_t *)&z
 	};
 
-	for ( int32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
-	{
-		if ( bDebug )
-			(void)printf("\nTrying to open \"%s.\"\n", pAccels[i]);
-
-		pHandle = fopen(pAccels[i],"r");
-		
-		if ( NULL == pHandle )
-		{	
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pAccels[i], strerror(errno));	
-			break;		
-		}
-
-		else if ( bDebug )
-			(void)printf("Successfully opened \"%s.\"\n", pAccels[i]);	
-		else
-			;
-		
-		*pXYZ[i] = 0;
-		
-		if ( 1 != fscanf(pHandle, "%i", pXYZ[i]) )
-		{
-			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pAccels[i], strerror(errno));
-		}
-		else if ( bDebug )
-		{
-			(void)printf("The raw linear acceleration value from \"%s\" is \"%i.\"\n", pAccels[i], *pXYZ[i]);
-		}
-		else
-			;
-
-		if ( NULL!=pHandle )
-			(void)fclose(pHandle);
-		pHandle = NULL;	
-	}
-
-	return;
+	readRawChannels(linearAccelerationAttributes, pXYZ, NUMBER_OF_AXES, FRAME_LINEAR_ACCELERATION, "linear acceleration");
 }
 
 void BNO055::readLinearAccelerations(double_t &x, double_t &y, double_t &z)
@@ -524,55 +833,12 @@ void BNO055::writeRawLinearAccelerationOffsets(int32_t &x, int32_t &y, int32_t &
 
 void BNO055::readRawAccelerations(int32_t &x, int32_t &y, int32_t &z)
 {
-	const char *pAccels[NUMBER_OF_AXES] =
-	{
-		{ IIO_PATH_PREFACE "/in_accel_x_raw"	},
-		{ IIO_PATH_PREFACE "/in_accel_y_raw"   	},
-		{ IIO_PATH_PREFACE "/in_accel_z_raw"	}
-	};
-
 	int32_t *pXYZ[NUMBER_OF_AXES] =
 	{
 		(int32_t *)&x, (int32_t *)&y, (int32_t *)&z
 	};
 
-	for ( int32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
-	{
-		if ( bDebug )
-			(void)printf("\nTrying to open \"%s.\"\n", pAccels[i]);
-
-		pHandle = fopen(pAccels[i],"r");
-		
-		if ( NULL == pHandle )
-		{	
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pAccels[i], strerror(errno));	
-			break;		
-		}
-
-		else if ( bDebug )
-			(void)printf("Successfully opened \"%s.\"\n", pAccels[i]);	
-		else
-			;
-		
-		*pXYZ[i] = 0;
-		
-		if ( 1 != fscanf(pHandle, "%i", pXYZ[i]) )
-		{
-			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pAccels[i], strerror(errno));
-		}
-		else if ( bDebug )
-		{
-			(void)printf("The raw acceleration value from \"%s\" is \"%i.\"\n", pAccels[i], *pXYZ[i]);
-		}
-		else
-			;
-
-		if ( NULL!=pHandle )
-			(void)fclose(pHandle);
-		pHandle = NULL;	
-	}
-
-	return;
+	readRawChannels(accelerationAttributes, pXYZ, NUMBER_OF_AXES, FRAME_ACCELERATION, "acceleration");
 }
 
 void BNO055::readAccelerations(double_t &x, double_t &y, double_t &z)
@@ -616,55 +882,12 @@ void BNO055::writeRawAccelerationOffsets(int32_t &x, int32_t &y, int32_t &z)
 
 void BNO055::readRawGravityValues(int32_t &x, int32_t &y, int32_t &z)
 {
-	const char *pGees[NUMBER_OF_AXES] =
-	{
-		{ IIO_PATH_PREFACE "/in_gravity_x_raw"	},
-		{ IIO_PATH_PREFACE "/in_gravity_y_raw"  },
-		{ IIO_PATH_PREFACE "/in_gravity_z_raw"	}
-	};
-
 	int32_t *pXYZ[NUMBER_OF_AXES] =
 	{
 		(int32_t *)&x, (int32_t *)&y, (int32_t *)&z
 	};
 
-	for ( int32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
-	{
-		if ( bDebug )
-			(void)printf("\nTrying to open \"%s.\"\n", pGees[i]);
-
-		pHandle = fopen(pGees[i],"r");
-		
-		if ( NULL == pHandle )
-		{	
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pGees[i], strerror(errno));	
-			break;		
-		}
-
-		else if ( bDebug )
-			(void)printf("Successfully opened \"%s.\"\n", pGees[i]);	
-		else
-			;
-		
-		*pXYZ[i] = 0;
-		
-		if ( 1 != fscanf(pHandle, "%i", pXYZ[i]) )
-		{
-			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pGees[i], strerror(errno));
-		}
-		else if ( bDebug )
-		{
-			(void)printf("The raw gravity value from \"%s\" is \"%i.\"\n", pGees[i], *pXYZ[i]);
-		}
-		else
-			;
-
-		if ( NULL!=pHandle )
-			(void)fclose(pHandle);
-		pHandle = NULL;	
-	}
-
-	return;
+	readRawChannels(gravityAttributes, pXYZ, NUMBER_OF_AXES, FRAME_GRAVITY, "gravity");
 }
 
 void BNO055::writeRawGravityOffsets(int32_t &x, int32_t &y, int32_t &z)
@@ -706,55 +929,12 @@ void BNO055::readGravities(double_t &x, double_t &y, double_t &z)
 
 void BNO055::readRawCompassAngles(int32_t &x, int32_t &y, int32_t &z)
 {
-	const char *pCompass[NUMBER_OF_AXES] =
-	{
-		{ IIO_PATH_PREFACE "/in_magn_x_raw" },
-		{ IIO_PATH_PREFACE "/in_magn_y_raw" },
-		{ IIO_PATH_PREFACE "/in_magn_z_raw"	}
-	};
-
 	int32_t *pXYZ[NUMBER_OF_AXES] =
 	{
 		(int32_t *)&x, (int32_t *)&y, (int32_t *)&z
 	};
 
-	for ( int32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
-	{
-		if ( bDebug )
-			(void)printf("\nTrying to open \"%s.\"\n", pCompass[i]);
-
-		pHandle = fopen(pCompass[i],"r");
-		
-		if ( NULL == pHandle )
-		{	
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pCompass[i], strerror(errno));	
-			break;		
-		}
-
-		else if ( bDebug )
-			(void)printf("Successfully opened \"%s.\"\n", pCompass[i]);	
-		else
-			;
-		
-		*pXYZ[i] = 0;
-		
-		if ( 1 != fscanf(pHandle, "%i", pXYZ[i]) )
-		{
-			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pCompass[i], strerror(errno));
-		}
-		else if ( bDebug )
-		{
-			(void)printf("The raw Magnetometer value from \"%s\" is \"%i.\"\n", pCompass[i], *pXYZ[i]);
-		}
-		else
-			;
-
-		if ( NULL!=pHandle )
-			(void)fclose(pHandle);
-		pHandle = NULL;	
-	}
-
-	return;
+	readRawChannels(compassAttributes, pXYZ, NUMBER_OF_AXES, FRAME_COMPASS, "Magnetometer");
 }
 
 void BNO055::readCompass(double_t &x, double_t &y, double_t &z)
@@ -796,44 +976,35 @@ void BNO055::writeRawCompassOffsets(int32_t &x, int32_t &y, int32_t &z)
 
 void BNO055::readRawQuaternions(int32_t &w, int32_t &x, int32_t &y, int32_t &z)
 {
-	const char *pQuaternions = IIO_PATH_PREFACE "/in_rot_quaternion_raw";
-
-	w = x = y =z = 0;
-
-	if ( bDebug )
-		(void)printf("\nTrying to open \"%s.\"\n", pQuaternions);
+	int32_t aiWXYZ[NUMBER_OF_QUATERNIONS] =
+	{
+		0, 0, 0, 0
+	};
 
-	pHandle = fopen(pQuaternions,"r");
-	
-	if ( NULL == pHandle )
-	{	
-		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pQuaternions, strerror(errno));
-		w = x = y =z = 0;
+	if ( streaming() || ( ( NULL != pBackend ) && readBackendFrame() ) )
+	{
+		w = aiFrame[FRAME_QUATERNION], x = aiFrame[FRAME_QUATERNION + 1],
+			y = aiFrame[FRAME_QUATERNION + 2], z = aiFrame[FRAME_QUATERNION + 3];
 		return;
 	}
 
-	else if ( bDebug )
-		(void)printf("Successfully opened \"%s.\"\n", pQuaternions);	
-	else
-		;
-	
-	
-	if ( NUMBER_OF_QUATERNIONS != fscanf(pHandle, "%i%i%i%i", &w, &x, &y, &z) )
-	{
-		(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pQuaternions, strerror(errno));
-	}
-	else if ( bDebug )
+	w = x = y = z = 0;
+
+	if ( !quaternionAttribute.isOpen() )
+		return;					// Reported when opened.
+
+	if ( NUMBER_OF_QUATERNIONS != quaternionAttribute.readIntegers(aiWXYZ, NUMBER_OF_QUATERNIONS) )
 	{
-		(void)printf("The raw Quaternion values (w, x, y, z) from \"%s\" are \"%i %i %i %i.\"\n", pQuaternions, w, x, y, z);
+		(void)printf("Unable to read the quaternions from \"%s!\"\n", pQuaternionPath);
+		return;
 	}
-	else
-		;
 
-	if ( NULL!=pHandle )
-		(void)fclose(pHandle);
-	pHandle = NULL;	
+	w = aiWXYZ[0], x = aiWXYZ[1], y = aiWXYZ[2], z = aiWXYZ[3];
 
-	return;
+	if ( bDebug )
+	{
+		(void)printf("The raw Quaternion values (w, x, y, z) from \"%s\" are \"%i %i %i %i.\"\n", pQuaternionPath, w, x, y, z);
+	}
 }
 
 void BNO055::writeRawQuaternionOffsets(int32_t &w, int32_t &x, int32_t &y, int32_t &z)
@@ -875,58 +1046,12 @@ void BNO055::readQuaternions(double_t &w, double_t &x, double_t &y, double_t &z)
 
 void BNO055::readRawOrientation(int32_t &pitch, int32_t &roll, int32_t &yaw)
 {
-	const char *pOrientation[NUMBER_OF_AXES] =
-	{
-		{ IIO_PATH_PREFACE "/in_rot_pitch_raw"  },
-		{ IIO_PATH_PREFACE "/in_rot_roll_raw"   },
-		{ IIO_PATH_PREFACE "/in_rot_yaw_raw"	}
-	};
-
 	int32_t *pXYZ[NUMBER_OF_AXES] =
 	{
 		(int32_t *)&pitch, (int32_t *)&roll, (int32_t *)&yaw
 	};
 
-	for ( int32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
-	{
-		if ( bDebug )
-			(void)printf("\nTrying to open \"%s.\"\n", pOrientation[i]);
-
-		pHandle = fopen(pOrientation[i],"r");
-		
-		if ( NULL == pHandle )
-		{	
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pOrientation[i], strerror(errno));
-			if ( NULL!=pHandle )
-				(void)fclose(pHandle);
-			pHandle = NULL;					
-			break;		
-		}
-
-		else if ( bDebug )
-			(void)printf("Successfully opened \"%s.\"\n", pOrientation[i]);	
-		else
-			;
-		
-		*pXYZ[i] = 0;
-		
-		if ( 1 != fscanf(pHandle, "%i", pXYZ[i]) )
-		{
-			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pOrientation[i], strerror(errno));
-		}
-		else if ( bDebug )
-		{
-			(void)printf("The raw rotation (orientation) value from \"%s\" is \"%i.\"\n", pOrientation[i], *pXYZ[i]);
-		}
-		else
-			;
-
-		if ( NULL!=pHandle )
-			(void)fclose(pHandle);
-		pHandle = NULL;	
-	}
-
-	return;
+	readRawChannels(orientationAttributes, pXYZ, NUMBER_OF_AXES, FRAME_ORIENTATION, "rotation (orientation)");
 }
 
 void BNO055::writeRawOrientationOffsets(int32_t &pitch, int32_t &roll, int32_t &yaw)
@@ -967,3 +1092,248 @@ void BNO055::readOrientation(double_t &pitch, double_t &roll, double_t &yaw)
 		(void)printf("The orientation (rotation) values (pitch, roll, yaw) are %lf, %lf, %lf.\n", pitch, roll, yaw);
 	}	
 }
+
+int64_t BNO055::timestampNow(void)
+{
+	struct timespec now;
+
+	(void)clock_gettime(IMU_TIMESTAMP_CLOCK, &now);
+
+	return ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec;
+}
+
+bool BNO055::readBackendFrame(void)
+{
+	if ( !pBackend->readFrame(aiFrame) )
+		return false;
+
+	iFrameTimestamp = timestampNow();
+
+	return true;
+}
+
+bool BNO055::setOperatingMode(const E_BNO055_MODE eNewMode)
+{
+	if ( streaming() )
+	{
+		(void)printf("Stop streaming before changing the BNO055's mode.\n");
+		return false;
+	}
+
+	bool bSuccess = true;
+
+	if ( NULL != pBackend )
+		bSuccess = pBackend->setOperatingMode(eNewMode);
+
+	else
+	{
+		// The driver runs AMG without fusion; the filter bandwidths set the data rates.
+		const bool bRaw = ( E_BNO055_RAW_MODE == eNewMode );
+
+		SysfsAttribute fusionAttribute(IIO_PATH_PREFACE "/fusion_enable", O_RDWR);
+
+		bSuccess = fusionAttribute.isOpen() && fusionAttribute.writeString(bRaw ? "0" : "1");
+
+		if ( bSuccess && bRaw )
+		{
+			SysfsAttribute gyroscopeBandwidth(IIO_PATH_PREFACE "/in_anglvel_filter_low_pass_3db_frequency", O_RDWR);
+			SysfsAttribute accelerationBandwidth(IIO_PATH_PREFACE "/in_accel_filter_low_pass_3db_frequency", O_RDWR);
+
+			bSuccess = gyroscopeBandwidth.isOpen() && gyroscopeBandwidth.writeString("523") &&
+				accelerationBandwidth.isOpen() && accelerationBandwidth.writeString("1000");
+		}
+
+		if ( !bSuccess )
+			(void)printf("You might need to be root to change the BNO055's mode.\n");
+	}
+
+	if ( bSuccess )
+		eMode = eNewMode;
+
+	else if ( bDebug )
+		(void)printf("The BNO055 stays in mode %d.\n", (int32_t)eMode);
+
+	else
+		;
+
+	return bSuccess;
+}
+
+bool BNO055::readRawFrame(int32_t *piRaw, const uint32_t uChannels /*= E_SAMPLE_ALL*/)
+{
+	// A backend reads everything in one transaction.
+	if ( ( NULL != pBackend ) && !streaming() && !readBackendFrame() )
+		return false;
+
+	if ( streaming() || ( NULL != pBackend ) )
+	{
+		(void)memcpy(piRaw, aiFrame, sizeof(aiFrame));
+		return true;
+	}
+
+	int32_t *p = piRaw;
+	uint32_t u = uChannels;
+
+	// Without fusion only the raw sensors change; skip the other sysfs reads.
+	if ( E_BNO055_RAW_MODE == eMode )
+		u &= ( E_SAMPLE_GYROSCOPE | E_SAMPLE_ACCELERATION | E_SAMPLE_COMPASS );
+
+	(void)memset(piRaw, 0, NUMBER_OF_FRAME_VALUES * sizeof(int32_t));
+
+	if ( u & E_SAMPLE_GYROSCOPE )
+		readRawGyroscopeValues(p[FRAME_GYROSCOPE], p[FRAME_GYROSCOPE + 1], p[FRAME_GYROSCOPE + 2]);
+	if ( u & E_SAMPLE_ACCELERATION )
+		readRawAccelerations(p[FRAME_ACCELERATION], p[FRAME_ACCELERATION + 1], p[FRAME_ACCELERATION + 2]);
+	if ( u & E_SAMPLE_LINEAR_ACCELERATION )
+		readRawLinearAccelerations(p[FRAME_LINEAR_ACCELERATION], p[FRAME_LINEAR_ACCELERATION + 1], p[FRAME_LINEAR_ACCELERATION + 2]);
+	if ( u & E_SAMPLE_GRAVITY )
+		readRawGravityValues(p[FRAME_GRAVITY], p[FRAME_GRAVITY + 1], p[FRAME_GRAVITY + 2]);
+	if ( u & E_SAMPLE_COMPASS )
+		readRawCompassAngles(p[FRAME_COMPASS], p[FRAME_COMPASS + 1], p[FRAME_COMPASS + 2]);
+	if ( u & E_SAMPLE_QUATERNION )
+		readRawQuaternions(p[FRAME_QUATERNION], p[FRAME_QUATERNION + 1], p[FRAME_QUATERNION + 2], p[FRAME_QUATERNION + 3]);
+	if ( u & E_SAMPLE_ORIENTATION )
+		readRawOrientation(p[FRAME_ORIENTATION], p[FRAME_ORIENTATION + 1], p[FRAME_ORIENTATION + 2]);
+
+	return true;
+}
+
+void BNO055::getFrameOffsets(int32_t *piOffsets)
+{
+	const int32_t aiOffsets[NUMBER_OF_FRAME_VALUES] =
+	{
+		in_anglvel_x_offset, in_anglvel_y_offset, in_anglvel_z_offset,
+		in_accel_x_offset, in_accel_y_offset, in_accel_z_offset,
+		in_linear_accel_x_offset, in_linear_accel_y_offset, in_linear_accel_z_offset,
+		in_gravity_x_offset, in_gravity_y_offset, in_gravity_z_offset,
+		in_magn_x_offset, in_magn_y_offset, in_magn_z_offset,
+		in_quaternion_w_offset, in_quaternion_x_offset, in_quaternion_y_offset, in_quaternion_z_offset,
+		in_orientation_pitch_offset, in_orientation_roll_offset, in_orientation_yaw_offset
+	};
+
+	(void)memcpy(piOffsets, aiOffsets, sizeof(aiOffsets));
+}
+
+void BNO055::setFrameOffsets(const int32_t *piOffsets)
+{
+	int32_t aiOffsets[NUMBER_OF_FRAME_VALUES];
+
+	(void)memcpy(aiOffsets, piOffsets, sizeof(aiOffsets));
+
+	int32_t *p = aiOffsets;
+
+	writeRawGyroscopeOffsets(p[0], p[1], p[2]), p += NUMBER_OF_ANGLES;
+	writeRawAccelerationOffsets(p[0], p[1], p[2]), p += NUMBER_OF_AXES;
+	writeRawLinearAccelerationOffsets(p[0], p[1], p[2]), p += NUMBER_OF_AXES;
+	writeRawGravityOffsets(p[0], p[1], p[2]), p += NUMBER_OF_AXES;
+	writeRawCompassOffsets(p[0], p[1], p[2]), p += NUMBER_OF_AXES;
+	writeRawQuaternionOffsets(p[0], p[1], p[2], p[3]), p += NUMBER_OF_QUATERNIONS;
+	writeRawOrientationOffsets(p[0], p[1], p[2]);
+}
+
+void BNO055::getFrameScales(double_t *pdScales)
+{
+	const double_t adScales[NUMBER_OF_FRAME_VALUES] =
+	{
+		in_anglvel_scale, in_anglvel_scale, in_anglvel_scale,
+		in_accel_scale, in_accel_scale, in_accel_scale,
+		in_accel_scale, in_accel_scale, in_accel_scale,
+		in_gravity_scale, in_gravity_scale, in_gravity_scale,
+		in_magn_scale, in_magn_scale, in_magn_scale,
+		in_rot_scale, in_rot_scale, in_rot_scale, in_rot_scale,
+		in_rot_scale, in_rot_scale, in_rot_scale
+	};
+
+	(void)memcpy(pdScales, adScales, sizeof(adScales));
+}
+
+void BNO055::getSampleValues(ImuSample &sample, double_t *pValues[])
+{
+	double_t *pSampleValues[NUMBER_OF_FRAME_VALUES] =
+	{
+		&sample.dGyroscope[0], &sample.dGyroscope[1], &sample.dGyroscope[2],
+		&sample.dAcceleration[0], &sample.dAcceleration[1], &sample.dAcceleration[2],
+		&sample.dLinearAcceleration[0], &sample.dLinearAcceleration[1], &sample.dLinearAcceleration[2],
+		&sample.dGravity[0], &sample.dGravity[1], &sample.dGravity[2],
+		&sample.dCompass[0], &sample.dCompass[1], &sample.dCompass[2],
+		&sample.dQuaternion[0], &sample.dQuaternion[1], &sample.dQuaternion[2], &sample.dQuaternion[3],
+		&sample.dOrientation[0], &sample.dOrientation[1], &sample.dOrientation[2]
+	};
+
+	(void)memcpy(pValues, pSampleValues, sizeof(pSampleValues));
+}
+
+// The E_SAMPLE_CHANNELS group of a frame value.
+static uint32_t frameChannel(const int32_t iFrameIndex)
+{
+	if ( BNO055::FRAME_ACCELERATION > iFrameIndex )
+		return E_SAMPLE_GYROSCOPE;
+	else if ( BNO055::FRAME_LINEAR_ACCELERATION > iFrameIndex )
+		return E_SAMPLE_ACCELERATION;
+	else if ( BNO055::FRAME_GRAVITY > iFrameIndex )
+		return E_SAMPLE_LINEAR_ACCELERATION;
+	else if ( BNO055::FRAME_COMPASS > iFrameIndex )
+		return E_SAMPLE_GRAVITY;
+	else if ( BNO055::FRAME_QUATERNION > iFrameIndex )
+		return E_SAMPLE_COMPASS;
+	else if ( BNO055::FRAME_ORIENTATION > iFrameIndex )
+		return E_SAMPLE_QUATERNION;
+	else
+		return E_SAMPLE_ORIENTATION;
+}
+
+bool BNO055::readSample(ImuSample &sample, const int32_t iTimeoutMs /*= -1*/)
+{
+	int32_t aiRaw[NUMBER_OF_FRAME_VALUES];
+
+	if ( streaming() )
+	{
+		if ( !readFrame(iTimeoutMs) )
+			return false;
+
+		sample.iTimestampNs = iFrameTimestamp;
+	}
+	else
+		sample.iTimestampNs = timestampNow();
+
+	// Without fusion the fused channels aren't produced; they read zero, not less their offsets.
+	uint32_t uChannels = uSampleChannels;
+
+	if ( E_BNO055_RAW_MODE == eMode )
+		uChannels &= ( E_SAMPLE_GYROSCOPE | E_SAMPLE_ACCELERATION | E_SAMPLE_COMPASS );
+
+	if ( !readRawFrame(aiRaw, uChannels) )
+		return false;
+
+	// The fusion output only changes at UPDATE_RATE; reading faster gets the same values again.
+	if ( uSampleSequence && ( 0 == memcmp(aiRaw, aiLastRaw, sizeof(aiRaw)) ) )
+		uRepeatedSamples++;
+
+	(void)memcpy(aiLastRaw, aiRaw, sizeof(aiLastRaw));
+
+	// The offsets and scales in frame order, so one loop converts everything.
+	int32_t aiOffsets[NUMBER_OF_FRAME_VALUES];
+	double_t adScales[NUMBER_OF_FRAME_VALUES];
+	double_t *pValues[NUMBER_OF_FRAME_VALUES];
+
+	getFrameOffsets(aiOffsets);
+	getFrameScales(adScales);
+	getSampleValues(sample, pValues);
+
+	for ( int32_t i = 0 ; i < NUMBER_OF_FRAME_VALUES ; i++ )
+	{
+		*pValues[i] = ( uChannels & frameChannel(i) ) ? adScales[i] * (double_t)( aiRaw[i] - aiOffsets[i] ) : 0.0;
+	}
+
+	sample.uSequence = uSampleSequence++;
+
+	if ( bDebug )
+	{
+		(void)printf("Sample %u at %" PRId64 " ns: orientation (pitch, roll, yaw) %lf, %lf, %lf; gyroscope (x,y,z) %lf, %lf, %lf.\n",
+			sample.uSequence, sample.iTimestampNs,
+			sample.dOrientation[0], sample.dOrientation[1], sample.dOrientation[2],
+			sample.dGyroscope[0], sample.dGyroscope[1], sample.dGyroscope[2]);
+	}
+
+	return true;
+}
@@ -12,18 +12,105 @@ BNO055.h - Header file for the Bosch BNO055 Intelligent 9-axis absolute orientat
 #include <inttypes.h>
 #include <math.h>
 #include <unistd.h>
+#include <time.h>
+#include <atomic>
+#include "SysfsAttribute.h"
+#include "IioBuffer.h"
+#include "BNO055Backend.h"
 
 #define IIO_PATH_PREFACE	"/sys/bus/iio/devices/iio:device1"
+#define IIO_DEVICE_PATH		"/dev/iio:device1"
+
+// Where the last calibration is kept between runs; NULL to the constructor skips it.
+#define BNO055_PROFILE_PATH	"/var/tmp/bno055.profile"
+
+// The clock for ImuSample timestamps. Streaming switches the IIO device to it, or, if that
+//	isn't allowed, converts the kernel's CLOCK_REALTIME timestamps.
+#define IMU_TIMESTAMP_CLOCK	CLOCK_MONOTONIC
+
+// A scan element and where its values go in the decoded frame.
+typedef struct sStreamChannel
+{
+	const char *pName;
+	int32_t iFrameIndex;
+	int32_t nValues;
+} StreamChannel;
+
+// The channel groups of a sample, as bits; see BNO055::setSampleChannels().
+typedef enum
+{
+	E_SAMPLE_GYROSCOPE				= 0x01,
+	E_SAMPLE_ACCELERATION			= 0x02,
+	E_SAMPLE_LINEAR_ACCELERATION	= 0x04,
+	E_SAMPLE_GRAVITY				= 0x08,
+	E_SAMPLE_COMPASS				= 0x10,
+	E_SAMPLE_QUATERNION				= 0x20,
+	E_SAMPLE_ORIENTATION			= 0x40,
+
+	E_SAMPLE_ALL					= 0x7f
+
+} E_SAMPLE_CHANNELS;
+
+// Every channel from one read, with the offsets and scales applied; see BNO055::readSample().
+typedef struct sImuSample
+{
+	int64_t iTimestampNs;					// The kernel's scan timestamp when streaming; else when it was read.
+	uint32_t uSequence;						// Counts samples read.
+
+	double_t dGyroscope[3];					// x, y, z radians per second.
+	double_t dAcceleration[3];				// x, y, z
+	double_t dLinearAcceleration[3];		// x, y, z; acceleration excluding gravity.
+	double_t dGravity[3];					// x, y, z
+	double_t dCompass[3];					// x, y, z
+	double_t dQuaternion[4];				// w, x, y, z
+	double_t dOrientation[3];				// pitch, roll, yaw
+} ImuSample;
+
+// Running statistics for one raw channel during calibration; see BNO055::getOffsets().
+typedef struct sWelfordState
+{
+	int64_t n;
+	int64_t iMeanQ;							// Q8 fixed point.
+	int64_t iM2Q;							// The sum of squared differences from the mean; Q8.
+} WelfordState;
 
 class BNO055
 {
     public:
-		BNO055();
+		// With pBackend (e.g., BNO055I2cBackend), reads through it instead of the IIO
+		//	driver; the caller keeps ownership and deletes it after the BNO055.
+		BNO055(const char *pProfilePath = BNO055_PROFILE_PATH, BNO055Backend *pBackend = NULL);
 		~BNO055();
 		
 		const char *getName(void);
 		void getOffsets(const uint32_t uN = NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_MINUTE);		
 									// It's implicit that we are zeroing the sensor.
+									// uN is the most samples; it stops as soon as every channel's
+									//	mean is within CALIBRATION_TOLERANCE_LSB (95% confidence),
+									//	but for the quaternion's and orientation's, which wrap.
+
+		// While getOffsets() runs (e.g., in another thread): 0 to 100.
+		inline uint32_t getCalibrationProgress(void)
+		{
+			return uCalibrationPercent;
+		}
+
+		inline uint32_t getCalibrationSamples(void)
+		{
+			return uCalibrationSamples;
+		}
+
+		// Samples skipped because the sensor moved.
+		inline uint32_t getRejectedSamples(void)
+		{
+			return uRejectedSamples;
+		}
+
+		// The standard deviation of every channel, in its scaled units, from the last calibration.
+		inline void getNoise(ImuSample &noise)
+		{
+			noise = calibrationNoise;
+		}
 
 		void readLinearAccelerations(double_t &x, double_t &y, double_t &z);
 		void readAccelerations(double_t &x, double_t &y, double_t &z);
@@ -35,36 +122,216 @@ class BNO055
 		void readQuaternions(double_t &w, double_t &x, double_t &y, double_t &z);
 		void readOrientation(double_t &pitch, double_t &roll, double_t &yaw);
 
+		// One coherent sample of the sample channels; in streaming mode it waits, up to the
+		//	timeout (negative is forever), for the next scan.
+		bool readSample(ImuSample &sample, const int32_t iTimeoutMs = -1);
+
+		// The channel groups (E_SAMPLE_CHANNELS) readSample() fills; the others read zero.
+		//	Without streaming or a backend, every value is its own sysfs file, a read() and
+		//	an I2C transfer each, 22 of them for every channel; fewer channels, fewer reads.
+		//	Streaming or a backend gets every channel at once, so it saves nothing there.
+		inline void setSampleChannels(const uint32_t uChannels)
+		{
+			uSampleChannels = uChannels & E_SAMPLE_ALL;
+		}
+
+		inline uint32_t getSampleChannels(void)
+		{
+			return uSampleChannels;
+		}
+
+		// Now, in nanoseconds, on the same clock as ImuSample::iTimestampNs.
+		static int64_t timestampNow(void);
+
+		// True when a sample is older than the given age, e.g., the data stopped.
+		static inline bool isStale(const ImuSample &sample, const int64_t iMaxAgeNs = STALE_SAMPLE_AGE_NS)
+		{
+			return ( timestampNow() - sample.iTimestampNs ) > iMaxAgeNs;
+		}
+
+		// Reads that waited longer than their timeout.
+		inline uint32_t getTimeouts(void)
+		{
+			return uTimeouts;
+		}
+
+		// Samples whose raw values all matched the one before; i.e., the same data read twice.
+		inline uint32_t getRepeatedSamples(void)
+		{
+			return uRepeatedSamples;
+		}
+
 		inline bool calibrated(void)
 		{
 			return bCalibrated;
 		}
 
+		// E_BNO055_RAW_MODE trades the fused outputs (orientation, quaternion, linear
+		//	acceleration, gravity) for the raw gyroscope and accelerometer at RAW_UPDATE_RATE;
+		//	the fused outputs read zero in a sample. ImuDecimator brings them down for slower
+		//	consumers. Not while streaming.
+		bool setOperatingMode(const E_BNO055_MODE eMode);
+
+		inline E_BNO055_MODE getOperatingMode(void)
+		{
+			return eMode;
+		}
+
+		// How often the outputs change in the current mode.
+		inline double_t getUpdateRate(void)
+		{
+			return ( E_BNO055_RAW_MODE == eMode ) ? RAW_UPDATE_RATE : UPDATE_RATE;
+		}
+
+		// The offsets, scale factors, and noise from the last calibration. Loading
+		//	refuses a profile taken with different scale factors.
+		bool saveProfile(const char *pPath = BNO055_PROFILE_PATH);
+		bool loadProfile(const char *pPath = BNO055_PROFILE_PATH);
+
+		// A fraction of a second at rest; false if the gyroscope, acceleration, or gravity
+		//	means moved away from the offsets, i.e., the profile no longer fits.
+		bool checkDrift(void);
+
+		// Streaming mode: every channel is captured at the same trigger instant and read
+		//	as one packed scan from the character device. The trigger, e.g., an hrtimer
+		//	trigger, has to exist already; NULL keeps the current one. The paths can name a
+		//	fake tree and a FIFO.
+		bool startStreaming(const char *pTriggerName = NULL,
+			const char *pSysfsPath = IIO_PATH_PREFACE, const char *pDevicePath = IIO_DEVICE_PATH);
+		void stopStreaming(void);
+
+		inline bool streaming(void)
+		{
+			return ( NULL != pStream ) && pStream->isEnabled();
+		}
+
+		// Waits for the next scan; the read functions then return its values.
+		bool readFrame(const int32_t iTimeoutMs = -1);
+
+		// The kernel timestamp of the current scan in nanoseconds.
+		inline int64_t getFrameTimestamp(void)
+		{
+			return iFrameTimestamp;
+		}
+
+		// A frame (the decoded scan, or a backend's burst read), in the order gyroscope, acceleration, linear acceleration, gravity,
+		//	magnetometer, quaternion (w, x, y, z), and orientation (pitch, roll, yaw).
+		enum
+		{
+			FRAME_GYROSCOPE				= 0,
+			FRAME_ACCELERATION			= 3,
+			FRAME_LINEAR_ACCELERATION	= 6,
+			FRAME_GRAVITY				= 9,
+			FRAME_COMPASS				= 12,
+			FRAME_QUATERNION			= 15,
+			FRAME_ORIENTATION			= 19,
+			NUMBER_OF_FRAME_VALUES		= 22
+		};
+
 		static const uint32_t BNO055_SAMPLE_DELAY_US;
 		static const uint32_t NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_SECOND;
 		static const uint32_t NUMBER_OF_OFFSET_SAMPLES_FOR_ONE_MINUTE;
 		static const uint32_t NUMBER_OF_OFFSET_SAMPLES_FOR_FIVE_MINUTES;
 
+		static const uint32_t MIN_CALIBRATION_SAMPLES;
+		static const double_t CALIBRATION_TOLERANCE_LSB;	// Half a count; the offsets are integers.
+		static const double_t CALIBRATION_CONFIDENCE_Z;		// 1.96 for 95 percent.
+		static const double_t OUTLIER_SIGMAS;
+		static const double_t OUTLIER_FLOOR_LSB;			// So quiet channels tolerate a count or two.
+
+		static const uint32_t DRIFT_CHECK_SAMPLES;
+		static const double_t DRIFT_TOLERANCE_LSB;
+
+		static const uint32_t PROFILE_MAGIC;
+		static const uint32_t PROFILE_VERSION;
+
 		static const double_t UPDATE_RATE;
+		static const double_t RAW_UPDATE_RATE;
+
+		// Three sample periods; long enough for scheduling jitter, short enough to notice a stall.
+		static const int32_t STREAM_TIMEOUT_MS		= 30;
+		static const int64_t STALE_SAMPLE_AGE_NS	= 30000000LL;
 
 	protected:
 
 		bool bCalibrated;
 
     private:
-    	FILE *pHandle;					// Used to access the "/sys/bus/iio/device0" BNO055 abstraction.
-		
 		char achDeviceName[100];
 		
 		static const bool bDebug;
 
 		static const int32_t NUMBER_OF_SCALE_FACTORS;
 
-		static const int32_t NUMBER_OF_ANGLES;
+		static const int32_t NUMBER_OF_ANGLES		= 3;
+
+		static const int32_t NUMBER_OF_AXES			= 3;
+
+		static const int32_t NUMBER_OF_QUATERNIONS	= 4;
+
+		// The "/sys/bus/iio/devices/iio:device1" channels are opened once and re-read with pread.
+		static const char *pGyroscopePaths[NUMBER_OF_ANGLES];
+		static const char *pAccelerationPaths[NUMBER_OF_AXES];
+		static const char *pLinearAccelerationPaths[NUMBER_OF_AXES];
+		static const char *pGravityPaths[NUMBER_OF_AXES];
+		static const char *pCompassPaths[NUMBER_OF_AXES];
+		static const char *pQuaternionPath;
+		static const char *pOrientationPaths[NUMBER_OF_AXES];
+
+		SysfsAttribute gyroscopeAttributes[NUMBER_OF_ANGLES];
+		SysfsAttribute accelerationAttributes[NUMBER_OF_AXES];
+		SysfsAttribute linearAccelerationAttributes[NUMBER_OF_AXES];
+		SysfsAttribute gravityAttributes[NUMBER_OF_AXES];
+		SysfsAttribute compassAttributes[NUMBER_OF_AXES];
+		SysfsAttribute quaternionAttribute;
+		SysfsAttribute orientationAttributes[NUMBER_OF_AXES];
+
+		void openChannels(void);
+		void closeChannels(void);
+
+		void readRawChannels(SysfsAttribute *pAttributes, int32_t *pValues[], const int32_t nValues,
+			const int32_t iFrameIndex, const char *pDescription);
+
+		// The saved calibration; bump PROFILE_VERSION when it changes.
+		typedef struct sProfile
+		{
+			int32_t aiOffsets[NUMBER_OF_FRAME_VALUES];
+			double_t adScales[NUMBER_OF_FRAME_VALUES];
+			double_t adNoiseLsb[NUMBER_OF_FRAME_VALUES];	// Standard deviations in counts.
+			uint32_t uSamples;
+		} Profile;
+
+		static const int32_t NUMBER_OF_STREAM_CHANNELS = 19;
+
+		static const StreamChannel streamChannels[NUMBER_OF_STREAM_CHANNELS];
+
+		IioBuffer *pStream;
+		bool bKernelMonotonic;					// The scan timestamps are already on IMU_TIMESTAMP_CLOCK.
+
+		E_BNO055_MODE eMode;
+		BNO055Backend *pBackend;
+		int32_t aiStreamChannels[NUMBER_OF_STREAM_CHANNELS];
+		int32_t aiFrame[NUMBER_OF_FRAME_VALUES];
+		int64_t iFrameTimestamp;
+
+		uint32_t uSampleSequence;
+		uint32_t uSampleChannels;
+
+		uint32_t uTimeouts, uRepeatedSamples;
+
+		int32_t aiLastRaw[NUMBER_OF_FRAME_VALUES];
+
+		std::atomic<uint32_t> uCalibrationPercent, uCalibrationSamples, uRejectedSamples;
 
-		static const int32_t NUMBER_OF_AXES;
+		ImuSample calibrationNoise;
 
-		static const int32_t NUMBER_OF_QUATERNIONS;
+		// All channels in frame order; see the enumeration above.
+		bool readRawFrame(int32_t *piRaw, const uint32_t uChannels = E_SAMPLE_ALL);
+		bool readBackendFrame(void);				// Into aiFrame.
+		void getFrameOffsets(int32_t *piOffsets);
+		void setFrameOffsets(const int32_t *piOffsets);
+		void getFrameScales(double_t *pdScales);
+		static void getSampleValues(ImuSample &sample, double_t *pValues[]);
 
 		// Note: these match the names provided by the IIO driver. They are writable by root.
 		double_t in_accel_scale,
@@ -0,0 +1,66 @@
+/*
+	BNO055Backend.h - Register access behind the BNO055 class for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	By default BNO055 reads the kernel's bno055_i2c IIO driver (sysfs, or its scan buffer
+	when streaming). Given a backend instead, BNO055 gets each whole frame from it; e.g.,
+	BNO055I2cBackend reads every data register in one transaction over "/dev/i2c-N."
+
+*/
+
+#ifndef _BNO055_BACKEND_H
+#define _BNO055_BACKEND_H
+
+#include <inttypes.h>
+#include <math.h>
+
+#define BNO055_BACKEND_VERSION	1     		// software version of this library
+
+typedef enum
+{
+	E_BNO055_FUSION_MODE	= 0,			// NDOF: every channel, fused at 100 Hz.
+	E_BNO055_RAW_MODE		= 1,			// AMG: the accelerometer, magnetometer, and gyroscope only,
+											//	at the highest bandwidth; no fused outputs.
+	NUM_BNO055_MODES		= 2
+
+} E_BNO055_MODE;
+
+class BNO055Backend
+{
+public:
+	virtual ~BNO055Backend()
+	{
+	}
+
+	virtual const char *getName(void) = 0;
+
+	// Finds and configures the device; BNO055 calls it once.
+	virtual bool open(void) = 0;
+
+	virtual bool setOperatingMode(const E_BNO055_MODE eMode) = 0;
+
+	// Every raw value, BNO055::NUMBER_OF_FRAME_VALUES of them in BNO055's frame order; in
+	//	E_BNO055_RAW_MODE the fused values are zero.
+	virtual bool readFrame(int32_t *piFrame) = 0;
+
+	// What one count is worth, as for the IIO driver's in_*_scale attributes.
+	virtual void getScaleFactors(double_t &dAcceleration, double_t &dCompass, double_t &dAngularVelocity,
+		double_t &dGravity, double_t &dRotation) = 0;
+};
+
+#endif	// _BNO055_BACKEND_H
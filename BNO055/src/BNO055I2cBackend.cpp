@@ -0,0 +1,188 @@
+/*
+	BNO055I2cBackend.cpp - BNO055 registers over i2c-dev for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "BNO055.h"
+#include "BNO055I2cBackend.h"
+
+const bool BNO055I2cBackend::bDebug = false;
+
+const uint8_t BNO055I2cBackend::CHIP_ID_REGISTER;
+const uint8_t BNO055I2cBackend::DATA_REGISTER;
+const uint8_t BNO055I2cBackend::PAGE_ID_REGISTER;
+const uint8_t BNO055I2cBackend::UNIT_SELECT_REGISTER;
+const uint8_t BNO055I2cBackend::OPERATION_MODE_REGISTER;
+const uint8_t BNO055I2cBackend::CHIP_ID;
+const uint8_t BNO055I2cBackend::CONFIG_MODE;
+const uint8_t BNO055I2cBackend::NDOF_MODE;
+const uint8_t BNO055I2cBackend::AMG_MODE;
+const uint8_t BNO055I2cBackend::ACC_CONFIG_REGISTER;
+const uint8_t BNO055I2cBackend::GYR_CONFIG_0_REGISTER;
+const uint8_t BNO055I2cBackend::GYR_CONFIG_1_REGISTER;
+const uint8_t BNO055I2cBackend::ACC_CONFIG_FAST;
+const uint8_t BNO055I2cBackend::GYR_CONFIG_0_FAST;
+const uint8_t BNO055I2cBackend::GYR_CONFIG_1_NORMAL;
+const uint32_t BNO055I2cBackend::RAW_DATA_SIZE;
+const uint8_t BNO055I2cBackend::UNITS;
+const uint32_t BNO055I2cBackend::DATA_SIZE;
+const uint32_t BNO055I2cBackend::MODE_SWITCH_DELAY_US;
+
+BNO055I2cBackend::BNO055I2cBackend(I2cBus *pBus, const uint8_t uAddress /*= BNO055_I2C_ADDRESS*/) :
+	pBus(pBus), uAddress(uAddress), uErrors(0), eMode(E_BNO055_FUSION_MODE)
+{
+}
+
+BNO055I2cBackend::~BNO055I2cBackend()
+{
+}
+
+const char *BNO055I2cBackend::getName(void)
+{
+	return "bno055-i2c-dev";
+}
+
+bool BNO055I2cBackend::open(void)
+{
+	if ( NULL == pBus )
+		return false;
+
+	uint8_t uChipId = 0;
+
+	if ( !pBus->readRegister(uAddress, CHIP_ID_REGISTER, uChipId) || ( CHIP_ID != uChipId ) )
+	{
+		(void)printf("There's no BNO055 at I2C address 0x%02x (chip ID 0x%02x).\n", uAddress, uChipId);
+		return false;
+	}
+
+	return setOperatingMode(eMode);
+}
+
+bool BNO055I2cBackend::setOperatingMode(const E_BNO055_MODE eNewMode)
+{
+	if ( NULL == pBus )
+		return false;
+
+	// The unit selection and sensor configuration can only change in config mode.
+	bool bSuccess = pBus->writeRegister(uAddress, PAGE_ID_REGISTER, 0) &&
+		pBus->writeRegister(uAddress, OPERATION_MODE_REGISTER, CONFIG_MODE);
+
+	(void)usleep(MODE_SWITCH_DELAY_US);
+
+	// The fusion modes set the bandwidths themselves.
+	if ( bSuccess && ( E_BNO055_RAW_MODE == eNewMode ) )
+	{
+		bSuccess = pBus->writeRegister(uAddress, PAGE_ID_REGISTER, 1) &&
+			pBus->writeRegister(uAddress, ACC_CONFIG_REGISTER, ACC_CONFIG_FAST) &&
+			pBus->writeRegister(uAddress, GYR_CONFIG_0_REGISTER, GYR_CONFIG_0_FAST) &&
+			pBus->writeRegister(uAddress, GYR_CONFIG_1_REGISTER, GYR_CONFIG_1_NORMAL) &&
+			pBus->writeRegister(uAddress, PAGE_ID_REGISTER, 0);
+	}
+
+	bSuccess = bSuccess && pBus->writeRegister(uAddress, UNIT_SELECT_REGISTER, UNITS) &&
+		pBus->writeRegister(uAddress, OPERATION_MODE_REGISTER, ( E_BNO055_RAW_MODE == eNewMode ) ? AMG_MODE : NDOF_MODE);
+
+	(void)usleep(MODE_SWITCH_DELAY_US);
+
+	if ( !bSuccess )
+		(void)printf("Unable to configure the BNO055 at I2C address 0x%02x!\n", uAddress);
+
+	else if ( bDebug )
+		(void)printf("The BNO055 at I2C address 0x%02x is in %s mode.\n", uAddress, ( E_BNO055_RAW_MODE == eNewMode ) ? "AMG" : "NDOF");
+
+	else
+		;
+
+	if ( bSuccess )
+		eMode = eNewMode;
+
+	return bSuccess;
+}
+
+static int32_t signedWord(const uint8_t *p)
+{
+	return (int16_t)( (uint16_t)p[0] | ( (uint16_t)p[1] << 8 ) );
+}
+
+void BNO055I2cBackend::decodeFrame(const uint8_t *pBlock, int32_t *piFrame)
+{
+	// Where each frame value is in the data block, and how many in a row.
+	static const struct
+	{
+		int32_t iFrameIndex;
+		int32_t iBlockOffset;
+		int32_t nValues;
+	} layout[] =
+	{
+		{ BNO055::FRAME_ACCELERATION,			0,	3 },
+		{ BNO055::FRAME_COMPASS,				6,	3 },
+		{ BNO055::FRAME_GYROSCOPE,				12,	3 },
+		{ BNO055::FRAME_QUATERNION,				24,	4 },
+		{ BNO055::FRAME_LINEAR_ACCELERATION,	32,	3 },
+		{ BNO055::FRAME_GRAVITY,				38,	3 }
+	};
+
+	for ( uint32_t i = 0 ; i < sizeof(layout) / sizeof(layout[0]) ; i++ )
+	{
+		for ( int32_t j = 0 ; j < layout[i].nValues ; j++ )
+			piFrame[layout[i].iFrameIndex + j] = signedWord(&pBlock[layout[i].iBlockOffset + ( 2 * j )]);
+	}
+
+	// The Euler angles are heading, roll, pitch; the frame wants pitch, roll, yaw. The
+	//	heading is 0 to 360 degrees, so it's unsigned, as with the IIO driver.
+	piFrame[BNO055::FRAME_ORIENTATION] = signedWord(&pBlock[22]);
+	piFrame[BNO055::FRAME_ORIENTATION + 1] = signedWord(&pBlock[20]);
+	piFrame[BNO055::FRAME_ORIENTATION + 2] = (uint16_t)signedWord(&pBlock[18]);
+}
+
+bool BNO055I2cBackend::readFrame(int32_t *piFrame)
+{
+	uint8_t auBlock[DATA_SIZE];
+
+	// Without fusion only the first part of the block changes; read just that.
+	const uint32_t uSize = ( E_BNO055_RAW_MODE == eMode ) ? RAW_DATA_SIZE : DATA_SIZE;
+
+	(void)memset(auBlock, 0, sizeof(auBlock));
+
+	if ( ( NULL == pBus ) || !pBus->readRegisters(uAddress, DATA_REGISTER, auBlock, uSize) )
+	{
+		uErrors++;
+		return false;
+	}
+
+	decodeFrame(auBlock, piFrame);
+
+	return true;
+}
+
+void BNO055I2cBackend::getScaleFactors(double_t &dAcceleration, double_t &dCompass, double_t &dAngularVelocity,
+	double_t &dGravity, double_t &dRotation)
+{
+	// From the data sheet for UNITS.
+	dAcceleration = 1.0 / 100.0;			// m/s^2
+	dCompass = 1.0 / 16.0;					// micro-Tesla
+	dAngularVelocity = 1.0 / 900.0;			// radians/second
+	dGravity = 1.0 / 100.0;					// m/s^2
+	dRotation = 1.0 / 16.0;					// degrees
+}
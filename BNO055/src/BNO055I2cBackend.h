@@ -0,0 +1,98 @@
+/*
+	BNO055I2cBackend.h - BNO055 registers over i2c-dev for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	Bypasses the kernel driver: one I2C transaction reads the whole data block, 0x08 through
+	0x33 (acceleration, magnetometer, gyroscope, Euler angles, quaternion, linear acceleration,
+	and gravity; 44 bytes), so every channel comes from the same fusion update.
+
+	The kernel driver must not be bound to the device at the same time (modprobe -r
+	bno055_i2c). Any I2cBus works; MockI2cBus runs it without hardware.
+
+*/
+
+#ifndef _BNO055_I2C_BACKEND_H
+#define _BNO055_I2C_BACKEND_H
+
+#include "BNO055Backend.h"
+#include "I2cBus.h"
+
+#define BNO055_I2C_BACKEND_VERSION	1     	// software version of this library
+
+#define BNO055_I2C_ADDRESS	0x28			// 0x29 with COM3 high.
+
+class BNO055I2cBackend : public BNO055Backend
+{
+public:
+	BNO055I2cBackend(I2cBus *pBus, const uint8_t uAddress = BNO055_I2C_ADDRESS);
+	virtual ~BNO055I2cBackend();
+
+	virtual const char *getName(void);
+	virtual bool open(void);
+	virtual bool setOperatingMode(const E_BNO055_MODE eMode);
+	virtual bool readFrame(int32_t *piFrame);
+	virtual void getScaleFactors(double_t &dAcceleration, double_t &dCompass, double_t &dAngularVelocity,
+		double_t &dGravity, double_t &dRotation);
+
+	// Decodes a data block read from DATA_REGISTER into a frame; public for tests.
+	static void decodeFrame(const uint8_t *pBlock, int32_t *piFrame);
+
+	inline uint32_t getErrors(void)
+	{
+		return uErrors;
+	}
+
+	// The registers (page 0) from the data sheet.
+	static const uint8_t CHIP_ID_REGISTER		= 0x00;
+	static const uint8_t DATA_REGISTER			= 0x08;		// ACC_DATA_X_LSB
+	static const uint8_t PAGE_ID_REGISTER		= 0x07;
+	static const uint8_t UNIT_SELECT_REGISTER	= 0x3b;
+	static const uint8_t OPERATION_MODE_REGISTER	= 0x3d;
+
+	// Page 1; only writable in config mode, and only used outside the fusion modes.
+	static const uint8_t ACC_CONFIG_REGISTER	= 0x08;
+	static const uint8_t GYR_CONFIG_0_REGISTER	= 0x0a;
+	static const uint8_t GYR_CONFIG_1_REGISTER	= 0x0b;
+
+	static const uint8_t CHIP_ID				= 0xa0;
+	static const uint8_t CONFIG_MODE			= 0x00;
+	static const uint8_t NDOF_MODE				= 0x0c;
+	static const uint8_t AMG_MODE				= 0x07;
+	static const uint8_t ACC_CONFIG_FAST		= 0x1d;		// 4 g, 1000 Hz bandwidth, normal power.
+	static const uint8_t GYR_CONFIG_0_FAST		= 0x00;		// 2000 degrees/s, 523 Hz bandwidth.
+	static const uint8_t GYR_CONFIG_1_NORMAL	= 0x00;
+	static const uint8_t UNITS					= 0x02;		// m/s^2, rad/s, degrees, Celsius.
+
+	static const uint32_t DATA_SIZE				= 0x34 - 0x08;
+	static const uint32_t RAW_DATA_SIZE			= 0x1a - 0x08;	// Just the accelerometer, magnetometer, and gyroscope.
+
+	static const uint32_t MODE_SWITCH_DELAY_US	= 20000;	// 19 ms into config mode, 7 ms out.
+
+private:
+	I2cBus *pBus;
+
+	uint8_t uAddress;
+
+	uint32_t uErrors;
+
+	E_BNO055_MODE eMode;
+
+	static const bool bDebug;
+};
+
+#endif	// _BNO055_I2C_BACKEND_H
@@ -0,0 +1,240 @@
+/*
+	ImuAcquisition.cpp - Background BNO055 sampling thread for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#include "ImuAcquisition.h"
+
+const bool ImuAcquisition::bDebug = false;
+
+ImuAcquisition::ImuAcquisition(BNO055 *pSensor, const double_t dRate /*= 0.0*/) :
+	pSensor(pSensor), dRate(dRate),
+	iPeriodNs((int64_t)( 1e9 / ( ( 0.0 < dRate ) ? dRate : ( ( NULL != pSensor ) ? pSensor->getUpdateRate() : BNO055::UPDATE_RATE ) ) )),
+	bRunning(false), uSamples(0), uMissed(0), uLate(0), uErrors(0),
+	iEventFd(-1), uLastWaitedWrites(0)
+{
+	(void)memset(&sAcquisitionThread, 0, sizeof(pthread_t));
+
+	iEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if ( 0 > iEventFd )
+		(void)printf("Unable to create the IMU sample event!\n\t\"%s\"\n", strerror(errno));
+}
+
+ImuAcquisition::~ImuAcquisition()
+{
+	stop();
+
+	if ( 0 <= iEventFd )
+		(void)close(iEventFd);
+	iEventFd = -1;
+}
+
+bool ImuAcquisition::start(void)
+{
+	if ( running() || ( NULL == pSensor ) )
+		return running();
+
+	uSamples = uMissed = uLate = uErrors = 0;
+
+	// The sensor's mode may have changed since; e.g., to E_BNO055_RAW_MODE.
+	iPeriodNs = (int64_t)( 1e9 / ( ( 0.0 < dRate ) ? dRate : pSensor->getUpdateRate() ) );
+
+	bRunning = true;
+
+	int32_t iRet = pthread_create(&sAcquisitionThread, NULL, acquisitionBackground, (void *)this);
+
+	if ( 0 != iRet )
+	{
+		(void)fprintf(stderr, "%s: thread creation error!\n\t\"%s\"", __FUNCTION__, strerror(iRet));
+		bRunning = false;
+		return false;
+	}
+	else if ( bDebug )
+		(void)printf("IMU acquisition thread created successfully.\n");
+	else
+		;
+
+	return true;
+}
+
+void ImuAcquisition::stop(void)
+{
+	if ( !running() )
+		return;
+
+	bRunning = false;
+
+	(void)pthread_join(sAcquisitionThread, NULL);
+
+	if ( bDebug )
+		(void)printf("IMU acquisition stopped: %u samples, %u missed, %u late, %u errors.\n",
+			getSamples(), getMissed(), getLate(), getErrors());
+}
+
+bool ImuAcquisition::getLatest(ImuSample &sample)
+{
+	if ( 0 == latestSample.writes() )
+		return false;
+
+	latestSample.read(sample);
+
+	return true;
+}
+
+bool ImuAcquisition::waitForSample(ImuSample &sample, const int32_t iTimeoutMs)
+{
+	struct pollfd sPoll;
+
+	sPoll.fd = iEventFd, sPoll.events = POLLIN, sPoll.revents = 0;
+
+	while ( latestSample.writes() == uLastWaitedWrites )
+	{
+		if ( 0 > iEventFd )
+			return false;
+
+		int32_t iReady = poll(&sPoll, 1, iTimeoutMs);
+
+		if ( ( 0 > iReady ) && ( EINTR == errno ) )
+			continue;
+
+		else if ( 0 >= iReady )
+			return false;
+
+		else
+		{
+			uint64_t uCount = 0;
+			(void)!read(iEventFd, &uCount, sizeof(uCount));
+		}
+	}
+
+	uLastWaitedWrites = latestSample.writes();
+
+	latestSample.read(sample);
+
+	return true;
+}
+
+void *ImuAcquisition::acquisitionBackground(void *pContext)
+{
+	ImuAcquisition *pThis = (ImuAcquisition *)pContext;
+	pThis->acquire();
+	return NULL;
+}
+
+static void addNanoseconds(struct timespec &t, const int64_t iNs)
+{
+	int64_t iTotal = (int64_t)t.tv_nsec + iNs;
+
+	t.tv_sec += (time_t)( iTotal / 1000000000LL );
+	t.tv_nsec = (long)( iTotal % 1000000000LL );
+}
+
+static int64_t differenceNanoseconds(const struct timespec &a, const struct timespec &b)
+{
+	return ( (int64_t)( a.tv_sec - b.tv_sec ) * 1000000000LL ) + ( a.tv_nsec - b.tv_nsec );
+}
+
+void ImuAcquisition::acquire(void)
+{
+	struct timespec deadline, now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+	int64_t iLastTimestampNs = 0;
+
+	while ( running() )
+	{
+		const bool bStreaming = pSensor->streaming();
+
+		if ( !bStreaming )
+		{
+			addNanoseconds(deadline, iPeriodNs);
+
+			while ( EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) )
+				;
+		}
+
+		ImuSample sample;
+
+		(void)memset(&sample, 0, sizeof(sample));
+
+		// The timeout lets stop() finish even if the scans stop coming.
+		if ( !pSensor->readSample(sample, BNO055::STREAM_TIMEOUT_MS) )
+		{
+			// A streaming timeout shows up as a timestamp gap, and is counted then.
+			if ( !bStreaming || !pSensor->streaming() )
+				uErrors++;
+
+			// Don't spin if the device went away.
+			if ( bStreaming && !pSensor->streaming() )
+				(void)usleep((useconds_t)( iPeriodNs / 1000 ));
+			continue;
+		}
+
+		latestSample.write(sample);
+		uSamples++;
+
+		if ( 0 <= iEventFd )
+		{
+			const uint64_t uOne = 1;
+			(void)!write(iEventFd, &uOne, sizeof(uOne));
+		}
+
+		if ( bStreaming )
+		{
+			// The kernel timestamps show any gap; its buffer absorbs our jitter.
+			if ( iLastTimestampNs )
+			{
+				int64_t iGapNs = sample.iTimestampNs - iLastTimestampNs;
+
+				if ( iGapNs > ( iPeriodNs + ( iPeriodNs / 2 ) ) )
+					uMissed += (uint32_t)( ( iGapNs + ( iPeriodNs / 2 ) ) / iPeriodNs ) - 1;
+			}
+
+			if ( ( BNO055::timestampNow() - sample.iTimestampNs ) > iPeriodNs )
+				uLate++;
+
+			iLastTimestampNs = sample.iTimestampNs;
+		}
+		else
+		{
+			(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+			int64_t iLateNs = differenceNanoseconds(now, deadline);
+
+			if ( iLateNs > iPeriodNs )
+			{
+				// Skip the deadlines that already went by rather than bursting to catch up.
+				uint32_t uSkipped = (uint32_t)( iLateNs / iPeriodNs );
+
+				uLate++;
+				uMissed += uSkipped;
+				addNanoseconds(deadline, (int64_t)uSkipped * iPeriodNs);
+			}
+		}
+	}
+}
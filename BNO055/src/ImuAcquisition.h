@@ -0,0 +1,113 @@
+/*
+	ImuAcquisition.h - Background BNO055 sampling thread for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	The thread samples the BNO055 at its update rate and publishes each ImuSample through a
+	seqlock, so control, telemetry, and the UI get the newest sample without blocking in the
+	sensor's file I/O. In streaming mode the kernel's scans pace the thread; otherwise it
+	sleeps to absolute deadlines on CLOCK_MONOTONIC.
+
+	While the thread runs, it owns the sensor; read the sensor only through getLatest() or
+	waitForSample(). The latter sleeps in poll() on an eventfd that the thread signals
+	after each sample, so a control loop wakes when a sample lands instead of spinning.
+
+*/
+
+#ifndef _IMU_ACQUISITION_H
+#define _IMU_ACQUISITION_H
+
+#include <pthread.h>
+#include <atomic>
+#include "BNO055.h"
+#include "SeqLock.h"
+
+#define IMU_ACQUISITION_VERSION	1     		// software version of this library
+
+class ImuAcquisition
+{
+public:
+	// Zero samples at the sensor's rate when started; see BNO055::getUpdateRate().
+	ImuAcquisition(BNO055 *pSensor, const double_t dRate = 0.0);
+	~ImuAcquisition();
+
+	bool start(void);
+	void stop(void);
+
+	inline bool running(void)
+	{
+		return bRunning.load(std::memory_order_relaxed);
+	}
+
+	// The newest sample; false until the first one is published.
+	bool getLatest(ImuSample &sample);
+
+	// Waits for a sample newer than the one this returned last time; false on a timeout
+	//	(negative waits forever). Meant for one consumer, e.g., the control loop.
+	bool waitForSample(ImuSample &sample, const int32_t iTimeoutMs);
+
+	// The eventfd; for a caller that polls it along with its own descriptors.
+	inline int32_t getEventFd(void)
+	{
+		return iEventFd;
+	}
+
+	inline uint32_t getSamples(void)
+	{
+		return uSamples.load(std::memory_order_relaxed);
+	}
+
+	// Sample periods that went by without a sample.
+	inline uint32_t getMissed(void)
+	{
+		return uMissed.load(std::memory_order_relaxed);
+	}
+
+	// Samples that came in more than a period after they were due (or, when streaming,
+	//	more than a period after the kernel took them).
+	inline uint32_t getLate(void)
+	{
+		return uLate.load(std::memory_order_relaxed);
+	}
+
+	inline uint32_t getErrors(void)
+	{
+		return uErrors.load(std::memory_order_relaxed);
+	}
+
+private:
+	BNO055 *pSensor;
+
+	double_t dRate;
+	int64_t iPeriodNs;
+
+	SeqLock<ImuSample> latestSample;
+
+	std::atomic<bool> bRunning;
+	std::atomic<uint32_t> uSamples, uMissed, uLate, uErrors;
+
+	pthread_t sAcquisitionThread;
+
+	int32_t iEventFd;
+	uint32_t uLastWaitedWrites;			// For waitForSample().
+
+	static const bool bDebug;
+
+	static void *acquisitionBackground(void *pContext);
+	void acquire(void);
+};
+
+#endif	// _IMU_ACQUISITION_H
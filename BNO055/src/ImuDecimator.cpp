@@ -0,0 +1,98 @@
+/*
+	ImuDecimator.cpp - Rate reduction for BNO055 samples on Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ImuDecimator.h"
+
+const int32_t ImuDecimator::NUMBER_OF_AVERAGED_VALUES;
+
+ImuDecimator::ImuDecimator(const uint32_t uFactor /*= 1*/) :
+	uFactor(1), uCount(0), uOutputs(0)
+{
+	setFactor(uFactor);
+}
+
+ImuDecimator::~ImuDecimator()
+{
+}
+
+void ImuDecimator::setFactor(const uint32_t uNewFactor)
+{
+	uFactor = ( 0 < uNewFactor ) ? uNewFactor : 1;
+	reset();
+}
+
+void ImuDecimator::reset(void)
+{
+	uCount = 0;
+	(void)memset(&sum, 0, sizeof(sum));
+}
+
+// The values that average; in ImuSample order.
+static void averagedValues(ImuSample &sample, double_t *pValues[])
+{
+	int32_t n = 0;
+
+	for ( int32_t i = 0 ; i < 3 ; i++ )
+		pValues[n++] = &sample.dGyroscope[i];
+	for ( int32_t i = 0 ; i < 3 ; i++ )
+		pValues[n++] = &sample.dAcceleration[i];
+	for ( int32_t i = 0 ; i < 3 ; i++ )
+		pValues[n++] = &sample.dLinearAcceleration[i];
+	for ( int32_t i = 0 ; i < 3 ; i++ )
+		pValues[n++] = &sample.dGravity[i];
+	for ( int32_t i = 0 ; i < 3 ; i++ )
+		pValues[n++] = &sample.dCompass[i];
+}
+
+bool ImuDecimator::add(const ImuSample &input, ImuSample &output)
+{
+	ImuSample in = input;
+
+	double_t *pSum[NUMBER_OF_AVERAGED_VALUES], *pIn[NUMBER_OF_AVERAGED_VALUES];
+
+	averagedValues(sum, pSum);
+	averagedValues(in, pIn);
+
+	for ( int32_t i = 0 ; i < NUMBER_OF_AVERAGED_VALUES ; i++ )
+		*pSum[i] += *pIn[i];
+
+	if ( ++uCount < uFactor )
+		return false;
+
+	// The newest input, then the averages over it.
+	output = input;
+	output.uSequence = uOutputs++;
+
+	double_t *pOut[NUMBER_OF_AVERAGED_VALUES];
+
+	averagedValues(output, pOut);
+
+	for ( int32_t i = 0 ; i < NUMBER_OF_AVERAGED_VALUES ; i++ )
+		*pOut[i] = *pSum[i] / (double_t)uFactor;
+
+	reset();
+
+	return true;
+}
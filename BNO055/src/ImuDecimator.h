@@ -0,0 +1,67 @@
+/*
+	ImuDecimator.h - Rate reduction for BNO055 samples on Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	Turns a fast sample stream (e.g., E_BNO055_RAW_MODE at 400 Hz) into a slower one for a
+	consumer that doesn't need every sample (e.g., a 50 Hz outer loop or telemetry). Each
+	output averages the gyroscope, acceleration, linear acceleration, gravity, and compass
+	over the last uFactor inputs, which also filters out what the slower rate can't represent.
+	The quaternion and the orientation angles wrap, so they're taken from the newest input.
+
+	The output has the newest input's timestamp; the averaged values lag it by about
+	( uFactor - 1 ) / 2 input periods.
+
+*/
+
+#ifndef _IMU_DECIMATOR_H
+#define _IMU_DECIMATOR_H
+
+#include "BNO055.h"
+
+#define IMU_DECIMATOR_VERSION	1     		// software version of this library
+
+class ImuDecimator
+{
+public:
+	ImuDecimator(const uint32_t uFactor = 1);
+	~ImuDecimator();
+
+	// E.g., ( BNO055::RAW_UPDATE_RATE / 50.0 ) for 50 Hz out; at least one.
+	void setFactor(const uint32_t uFactor);
+
+	inline uint32_t getFactor(void)
+	{
+		return uFactor;
+	}
+
+	// True, with output set, on every uFactor-th input.
+	bool add(const ImuSample &input, ImuSample &output);
+
+	void reset(void);
+
+private:
+	uint32_t uFactor;
+	uint32_t uCount;
+	uint32_t uOutputs;
+
+	ImuSample sum;
+
+	static const int32_t NUMBER_OF_AVERAGED_VALUES = 15;
+};
+
+#endif	// _IMU_DECIMATOR_H
@@ -0,0 +1,151 @@
+/*
+	BenchmarkControlCore.cpp - Time a control tick, per axis and in a ControlCore.
+
+	Steps the same PIDs on the same inputs as separate DiscretePids and as ControlCores of
+	doubles and floats, checks that they agree, and prints each one's nanoseconds per tick.
+	No hardware; build it with optimization, e.g., "make benchmark."
+
+	Usage: BenchmarkControlCore [number of ticks]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "DiscretePid.h"
+#include "ControlCore.h"
+
+extern const char* __progname;			// The program name is provided by libc.
+#define PROGRAM_NAME __progname
+
+static const uint32_t NUMBER_OF_AXES = 3;
+
+static const double_t SAMPLE_TIME = 0.02;
+
+// A big enough setpoint for the limits to come into play.
+static const double_t SETPOINT = 0.4, LIMIT = 0.26;
+
+// Keeps the compiler from dropping the work.
+static volatile double_t dSink = 0.0;
+
+static double_t nowNanoseconds(void)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ( (double_t)now.tv_sec * 1e9 ) + (double_t)now.tv_nsec;
+}
+
+// Measurements that move, the same for each of them; from a table, so the sin() isn't timed.
+static const uint32_t TABLE_SIZE = 1024;
+
+static double_t adMeasurements[TABLE_SIZE][NUMBER_OF_AXES];
+
+static void makeMeasurements(void)
+{
+	for ( uint32_t n = 0 ; n < TABLE_SIZE ; n++ )
+		for ( uint32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+			adMeasurements[n][i] = 0.1 * sin(( 2.0 * M_PI * n / TABLE_SIZE ) + i);
+}
+
+static inline double_t measurement(const uint32_t uTick, const uint32_t uAxis)
+{
+	return adMeasurements[uTick % TABLE_SIZE][uAxis];
+}
+
+static void setUp(DiscretePid *pPids)
+{
+	for ( uint32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+	{
+		pPids[i].setGains(0.300, 0.330, 0.230);
+		pPids[i].setSampleTime(SAMPLE_TIME);
+		pPids[i].setOutputLimits(-LIMIT, LIMIT);
+		pPids[i].reset();
+	}
+}
+
+template <typename Scalar>
+static double_t timeCore(const uint32_t nTicks, double_t *pdOutputs)
+{
+	DiscretePid pids[NUMBER_OF_AXES];
+	ControlCore<NUMBER_OF_AXES, Scalar> core;
+
+	setUp(pids);
+
+	for ( uint32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+	{
+		core.setAxis(i, pids[i]);
+		core.setMode(i, true, false);
+	}
+
+	const double_t dStart = nowNanoseconds();
+
+	for ( uint32_t n = 0 ; n < nTicks ; n++ )
+	{
+		for ( uint32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+			core.setInput(i, (Scalar)SETPOINT, (Scalar)measurement(n, i));
+
+		core.step();
+
+		dSink = core.getOutput(0);
+	}
+
+	const double_t dElapsed = nowNanoseconds() - dStart;
+
+	for ( uint32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+		pdOutputs[i] = core.getOutput(i);
+
+	return dElapsed / nTicks;
+}
+
+static double_t timePids(const uint32_t nTicks, double_t *pdOutputs)
+{
+	DiscretePid pids[NUMBER_OF_AXES];
+
+	setUp(pids);
+
+	const double_t dStart = nowNanoseconds();
+
+	for ( uint32_t n = 0 ; n < nTicks ; n++ )
+	{
+		for ( uint32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+			pdOutputs[i] = pids[i].step(SETPOINT, measurement(n, i));
+
+		dSink = pdOutputs[0];
+	}
+
+	return ( nowNanoseconds() - dStart ) / nTicks;
+}
+
+int main(int argc, char *argv[])
+{
+	const uint32_t nTicks = ( 1 < argc ) ? (uint32_t)atoi(argv[1]) : 10000000;
+
+	double_t adPids[NUMBER_OF_AXES], adDoubles[NUMBER_OF_AXES], adFloats[NUMBER_OF_AXES];
+
+	makeMeasurements();
+
+	const double_t dPids = timePids(nTicks, adPids);
+	const double_t dDoubles = timeCore<double>(nTicks, adDoubles);
+	const double_t dFloats = timeCore<float>(nTicks, adFloats);
+
+	double_t dDoubleError = 0.0, dFloatError = 0.0;
+
+	for ( uint32_t i = 0 ; i < NUMBER_OF_AXES ; i++ )
+	{
+		dDoubleError = fmax(dDoubleError, fabs(adDoubles[i] - adPids[i]));
+		dFloatError = fmax(dFloatError, fabs(adFloats[i] - adPids[i]));
+	}
+
+	(void)printf("%s: %u axes, %u ticks; nanoseconds per tick:\n", PROGRAM_NAME, NUMBER_OF_AXES, nTicks);
+	(void)printf("\tDiscretePid per axis              %8.2f\n", dPids);
+	(void)printf("\tControlCore<%u, double> (%u lanes) %8.2f\tdiffers by %g\n", NUMBER_OF_AXES,
+		ControlCore<NUMBER_OF_AXES, double>::LANES, dDoubles, dDoubleError);
+	(void)printf("\tControlCore<%u, float>  (%u lanes) %8.2f\tdiffers by %g\n", NUMBER_OF_AXES,
+		ControlCore<NUMBER_OF_AXES, float>::LANES, dFloats, dFloatError);
+
+	// The same equation; only the rounding differs.
+	return ( ( 1e-9 > dDoubleError ) && ( 1e-3 > dFloatError ) ) ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/*
+	CascadedControl.cpp - Cascaded attitude angle and body rate control for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "CascadedControl.h"
+#include "BNO055.h"
+
+const double_t CascadedControl::ANGLE_SAMPLE_TIME		= 0.02;		// 50 Hz, as RockHopperControl's.
+const double_t CascadedControl::RATE_LIMIT				= 2.0;		// About 115 degrees per second.
+const double_t CascadedControl::RATE_DERIVATIVE_FILTER	= 0.02;
+
+CascadedControl::CascadedControl(const char *ControlName /*= "cascaded attitude angle and body rate control."*/) :
+	Control(ControlName),
+	dAngleSampleTime(ANGLE_SAMPLE_TIME), dAngleElapsed(ANGLE_SAMPLE_TIME),
+	dRateDerivativeFilter(RATE_DERIVATIVE_FILTER)
+{
+	sampleTime = 1.0 / BNO055::UPDATE_RATE;
+										// The inner loop runs on every sample, at 100 Hz.
+
+	bDiscretePid = true;
+
+	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+	{
+		eControlled[i] = E_FEEDBACK_OFF;
+
+		// Starting points, not a tune; the outer loop wants a fifth or less of the inner's bandwidth.
+		Kp[i] = 4.0;
+		Ki[i] = 0.5;
+		Kd[i] = 0.0;
+
+		KpRate[i] = 0.150;
+		KiRate[i] = 0.300;
+		KdRate[i] = 0.005;
+
+		dRateLimits[i] = RATE_LIMIT;
+
+		dControlRadiansSettings[i] 			= 0.0;
+		dSensorRadiansValues[i] 			= 0.0;
+		dSensorRadiansPerSecondValues[i]	= 0.0;
+		dOutputValues[i]					= 0.0;
+		dDeltaValues[i]						= 0.0;
+
+		dRateSetpoints[i] = 0.0;
+	}
+
+	dControlRadiansLowerLimits[E_PITCH_AXIS] = K9_MIN_PITCH_ANGLE_RADIANS, dControlRadiansUpperLimits[E_PITCH_AXIS] = K9_MAX_PITCH_ANGLE_RADIANS;
+	dControlRadiansLowerLimits[E_ROLL_AXIS] = K9_MIN_PITCH_ANGLE_RADIANS, dControlRadiansUpperLimits[E_ROLL_AXIS] = K9_MAX_PITCH_ANGLE_RADIANS;
+	dControlRadiansLowerLimits[E_YAW_AXIS] = K9_MIN_YAW_ANGLE_RADIANS, dControlRadiansUpperLimits[E_YAW_AXIS] = K9_MAX_YAW_ANGLE_RADIANS;
+
+	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+		configurePid(i);
+}
+
+CascadedControl::~CascadedControl()
+{
+	;
+}
+
+void CascadedControl::setAngleGains(const E_CONTROLLED_AXES e, const double_t dKp, const double_t dKi)
+{
+	Kp[e] = dKp, Ki[e] = dKi;
+	configurePid(e);
+}
+
+void CascadedControl::setRateGains(const E_CONTROLLED_AXES e, const double_t dKp, const double_t dKi, const double_t dKd)
+{
+	KpRate[e] = dKp, KiRate[e] = dKi, KdRate[e] = dKd;
+	configurePid(e);
+}
+
+void CascadedControl::setRateLimit(const E_CONTROLLED_AXES e, const double_t dRadiansPerSecond)
+{
+	dRateLimits[e] = fabs(dRadiansPerSecond);
+	configurePid(e);
+}
+
+void CascadedControl::setAngleSampleTime(const double_t dSeconds)
+{
+	dAngleSampleTime = fmax(dSeconds, sampleTime);
+
+	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+		configurePid(i);
+}
+
+void CascadedControl::setRateDerivativeFilter(const double_t dSeconds)
+{
+	dRateDerivativeFilter = dSeconds;
+
+	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+		configurePid(i);
+}
+
+void CascadedControl::SetDiscretePid(const bool b)
+{
+	if ( !b && bDebug )
+		(void)printf("%s: the cascade's loops are always discrete PIDs.\n", __FUNCTION__);
+}
+
+void CascadedControl::GetRateSetpointRadiansPerSecondValues(double_t &dPitchRate, double_t &dRollRate, double_t &dYawRate)
+{
+	dPitchRate	= dRateSetpoints[E_PITCH_AXIS];
+	dRollRate	= dRateSetpoints[E_ROLL_AXIS];
+	dYawRate	= dRateSetpoints[E_YAW_AXIS];
+}
+
+void CascadedControl::configurePid(const int32_t i)
+{
+	// The outer loop has no derivative; the inner loop damps.
+	pid[i].setGains(Kp[i], Ki[i], 0.0);
+	pid[i].setSampleTime(dAngleSampleTime);
+	pid[i].setOutputLimits(-dRateLimits[i], dRateLimits[i]);
+
+	ratePid[i].setGains(KpRate[i], KiRate[i], KdRate[i]);
+	ratePid[i].setSampleTime(sampleTime);
+	ratePid[i].setDerivativeFilter(dRateDerivativeFilter);
+	ratePid[i].setOutputLimits(dControlRadiansLowerLimits[i], dControlRadiansUpperLimits[i]);
+}
+
+void CascadedControl::step(const double_t deltaT)
+{
+	dAngleElapsed += deltaT;
+
+	// The first step, and any after a period or more, runs the outer loop too.
+	const bool bAngle = ( ( dAngleElapsed + SAMPLE_TIME_TOLERANCE ) >= dAngleSampleTime );
+
+	if ( bAngle )
+		dAngleElapsed = 0.0;
+
+	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+	{
+		if ( E_FEEDBACK_FOLLOW == eControlled[i] )
+		{
+			dOutputValues[i] = dSensorRadiansValues[i];
+			dRateSetpoints[i] = 0.0;
+			pid[i].reset(), ratePid[i].reset();
+			continue;
+		}
+
+		else if ( E_FEEDBACK_OFF == eControlled[i] )
+		{
+			dOutputValues[i] = dControlRadiansSettings[i];
+			dRateSetpoints[i] = 0.0;
+			pid[i].reset(), ratePid[i].reset();
+			continue;
+		}
+		else
+			;						// Default to E_FEEDBACK_ON.
+
+		if ( bAngle )
+		{
+			dDeltaValues[i] = dControlRadiansSettings[i] - dSensorRadiansValues[i];
+			dRateSetpoints[i] = pid[i].step(dControlRadiansSettings[i], dSensorRadiansValues[i]);
+		}
+
+		// Its derivative is on the measured rate, so a new setpoint doesn't kick the gimbal.
+		dOutputValues[i] = ratePid[i].step(dRateSetpoints[i], dSensorRadiansPerSecondValues[i]);
+	}
+}
@@ -0,0 +1,112 @@
+/*
+	CascadedControl.h - Cascaded attitude angle and body rate control for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	Two loops per axis. The outer one runs on the attitude at 50 Hz, as RockHopperControl
+	does, but its output is a body rate, not a gimbal angle: a PI on the angle error, limited
+	to a rate the vehicle can follow. The inner one runs at the IMU's sample rate (100 Hz) on
+	the gyroscope's rates and drives the gimbal: a PID on the rate error, with its derivative
+	taken on the measured rate and low pass filtered. A torque from the EDF shows up in the
+	rates a sample after it starts, so the inner loop pushes back long before the angle moves
+	enough for the outer loop to see it.
+
+	getSampleTime() is the inner loop's period, since that's how often the outputs change;
+	both update()s step it, and the outer loop runs on every step that completes its period.
+	The rates have to be in the rocket's axes, and of the same sign as the angles' changes.
+
+	Both loops are DiscretePids, always; the outer one limited to the rate limit and the
+	inner one to the gimbal's range, so a saturated gimbal doesn't wind up either loop.
+
+*/
+
+#ifndef	_CASCADED_CONTROL_H
+#define _CASCADED_CONTROL_H
+
+#include "K_9_TVC_Gimbal_Generation_2.h"
+#include "Control.h"
+
+class CascadedControl : public Control
+{
+public:
+	CascadedControl(const char *ControlName = "cascaded attitude angle and body rate control.");
+	~CascadedControl();
+
+	// The outer loop: body rate (radians per second) per radian of angle error, and per
+	//	radian second of its integral. Kd isn't used; the inner loop damps.
+	virtual void setAngleGains(const E_CONTROLLED_AXES e, const double_t dKp, const double_t dKi);
+
+	// The inner loop: gimbal radians per radian per second of rate error, its integral, and
+	//	its derivative.
+	virtual void setRateGains(const E_CONTROLLED_AXES e, const double_t dKp, const double_t dKi, const double_t dKd);
+
+	// The largest rate the outer loop asks for, radians per second.
+	virtual void setRateLimit(const E_CONTROLLED_AXES e, const double_t dRadiansPerSecond);
+
+	// The outer loop's period, seconds; a multiple of the inner loop's.
+	virtual void setAngleSampleTime(const double_t dSeconds);
+
+	// The rate derivative's filter time constant, seconds; zero for DiscretePid's default.
+	virtual void setRateDerivativeFilter(const double_t dSeconds);
+
+	// The loops are always DiscretePids.
+	virtual void SetDiscretePid(const bool b);
+
+	// An axis' inner loop; the outer loop's is GetPid().
+	inline DiscretePid &GetRatePid(const E_CONTROLLED_AXES e)
+	{
+		return ratePid[e];
+	}
+
+	// The outer loop's last output, the inner loop's setpoint.
+	virtual void GetRateSetpointRadiansPerSecondValues(double_t &dPitchRate, double_t &dRollRate, double_t &dYawRate);
+
+	inline double_t getAngleSampleTime(void)
+	{
+		return dAngleSampleTime;
+	}
+
+	static const double_t ANGLE_SAMPLE_TIME;		// The outer loop's default period, seconds.
+	static const double_t RATE_LIMIT;				// The default rate limit, radians per second.
+	static const double_t RATE_DERIVATIVE_FILTER;	// The default filter time constant, seconds.
+
+protected:
+	// Both loops, from the base class' update()s.
+	virtual void step(const double_t deltaT);
+
+	// Loads an axis' loops from the gains, the sample times, and the limits.
+	virtual void configurePid(const int32_t i);
+
+	double_t dAngleSampleTime;
+	double_t dAngleElapsed;				// Since the outer loop last stepped.
+
+	double_t dRateSetpoints[NUM_AXES];
+	double_t dRateLimits[NUM_AXES];
+
+	DiscretePid ratePid[NUM_AXES];
+
+	double_t KpRate[NUM_AXES],
+		KiRate[NUM_AXES],
+		KdRate[NUM_AXES];
+
+	double_t dRateDerivativeFilter;
+
+private:
+
+
+};
+
+#endif	// _CASCADED_CONTROL_H
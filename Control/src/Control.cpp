@@ -21,6 +21,11 @@
 
 const bool Control::bDebug = true;
 
+const double_t Control::MAX_DELTA_T				= 0.1;
+
+// Sample timestamps jitter a little; don't skip a whole sample for it.
+const double_t Control::SAMPLE_TIME_TOLERANCE	= 0.001;
+
 Control::Control(const char *ControlName) 
 {
 	if ( NULL!=ControlName )
@@ -28,12 +33,17 @@ Control::Control(const char *ControlName)
 	else
 		(void)memset(achControlName, '\0', sizeof(achControlName));
 
-	(void)clock_gettime(CLOCK_REALTIME, &thisTime);
-	(void)clock_gettime(CLOCK_REALTIME, &lastTime);	
+	(void)clock_gettime(CLOCK_MONOTONIC, &thisTime);
+	(void)clock_gettime(CLOCK_MONOTONIC, &lastTime);	
 
 	sampleTime = 0.0;
 
-	for ( int32_t i = E_PITCH_AXIS; i < E_ROLL_AXIS ; i++ )
+	iSampleTimestampNs = 0;
+	iStepTimestampNs = 0;
+
+	bDiscretePid = false;
+
+	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
 	{
 
 		eControlled[i] = E_FEEDBACK_OFF;
@@ -128,6 +138,14 @@ void Control::SetInputAngularVelocityRadiansPerSecondValues(double_t dPitchRate,
 	dSensorRadiansPerSecondValues[E_YAW_AXIS]	= dYawRate;
 }
 
+void Control::SetInputSample(const ImuSample &sample)
+{
+	SetInputAngleDegreesValues(sample.dOrientation[E_PITCH_AXIS], sample.dOrientation[E_ROLL_AXIS], sample.dOrientation[E_YAW_AXIS]);
+	SetInputAngularVelocityRadiansPerSecondValues(sample.dGyroscope[E_PITCH_AXIS], sample.dGyroscope[E_ROLL_AXIS], sample.dGyroscope[E_YAW_AXIS]);
+
+	iSampleTimestampNs = sample.iTimestampNs;
+}
+
 void Control::GetControlledOutputAngleRadiansValues(double_t &dPitch, double_t &dRoll, double_t &dYaw)
 {
 	dPitch = dOutputValues[E_PITCH_AXIS];
@@ -144,7 +162,7 @@ void Control::GetControlledOutputAngleDegreesValues(double_t &dPitch, double_t &
 
 void Control::update(void)
 {
-	(void)clock_gettime(CLOCK_REALTIME, &thisTime);
+	(void)clock_gettime(CLOCK_MONOTONIC, &thisTime);
 
 	double_t deltaT = 0.0;
 
@@ -160,6 +178,35 @@ void Control::update(void)
 
 	lastTime = thisTime;
 
+	step(deltaT);
+}
+
+void Control::update(const ImuSample &sample)
+{
+	SetInputSample(sample);
+
+	if ( 0 == iStepTimestampNs )
+	{
+		iStepTimestampNs = sample.iTimestampNs;
+		return;
+	}
+
+	double_t deltaT = (double_t)( sample.iTimestampNs - iStepTimestampNs ) / 1e9;
+
+	// The same sample again, or not yet a sample time since the last step.
+	if ( ( 0.0 >= deltaT ) || ( ( deltaT + SAMPLE_TIME_TOLERANCE ) < sampleTime ) )
+		return;
+
+	iStepTimestampNs = sample.iTimestampNs;
+
+	if ( deltaT > MAX_DELTA_T )
+		deltaT = MAX_DELTA_T;
+
+	step(deltaT);
+}
+
+void Control::step(const double_t deltaT)
+{
 	double_t dProportional[NUM_AXES] = 
 	{
 		0.0, 0.0, 0.0
@@ -171,12 +218,20 @@ void Control::update(void)
 		{
 			dOutputValues[i] = dSensorRadiansValues[i];
 			dSensorRadiansIntegratedValues[i] = 0.0;
+			pid[i].reset();
 			continue;
 		}
 
 		else if ( E_FEEDBACK_OFF == eControlled[i] )
 		{
 			dSensorRadiansIntegratedValues[i] = 0.0;
+			pid[i].reset();
+			continue;
+		}
+
+		else if ( bDiscretePid )
+		{
+			dOutputValues[i] = pid[i].step(dControlRadiansSettings[i], dSensorRadiansValues[i]);
 			continue;
 		}
 
@@ -198,6 +253,44 @@ void Control::update(void)
 
 }
 
+void Control::SetGains(const E_CONTROLLED_AXES e, const double_t dKp, const double_t dKi, const double_t dKd)
+{
+	Kp[e] = dKp, Ki[e] = dKi, Kd[e] = dKd;
+	configurePid(e);
+}
+
+void Control::SetOutputLimitsRadians(const E_CONTROLLED_AXES e, const double_t dLower, const double_t dUpper)
+{
+	dControlRadiansLowerLimits[e] = fmin(dLower, dUpper), dControlRadiansUpperLimits[e] = fmax(dLower, dUpper);
+	configurePid(e);
+}
+
+void Control::SetDiscretePid(const bool b)
+{
+	if ( b && !bDiscretePid )
+	{
+		for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+		{
+			configurePid(i);
+			pid[i].reset();
+		}
+	}
+
+	bDiscretePid = b;
+}
+
+void Control::configurePid(const int32_t i)
+{
+	pid[i].setGains(Kp[i], Ki[i], Kd[i]);
+	pid[i].setSampleTime(sampleTime);
+
+	// No range set, no limit.
+	if ( dControlRadiansUpperLimits[i] > dControlRadiansLowerLimits[i] )
+		pid[i].setOutputLimits(dControlRadiansLowerLimits[i], dControlRadiansUpperLimits[i]);
+	else
+		pid[i].setOutputLimits(-DBL_MAX, DBL_MAX);
+}
+
 void Control::SetControlledAxes(const E_FEEDBACK_MODE &ePitch, const E_FEEDBACK_MODE &eRoll, const E_FEEDBACK_MODE &eYaw)
 {
 	eControlled[E_PITCH_AXIS]	= ePitch,
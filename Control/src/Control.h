@@ -33,6 +33,8 @@
 #include <errno.h>
 #include <float.h>
 #include "Gimbal.h"
+#include "BNO055.h"
+#include "DiscretePid.h"
 #include "Control.h"
 
 #define CONTROL_VERSION	2     			// the software version of this library
@@ -82,10 +84,57 @@ public:
 
 	virtual void GetControlledOutputAngleDegreesValues(double_t &dPitch, double_t &dRoll, double_t &dYaw);
 
+	// The attitude (degrees) and rates (radians per second) from one IMU sample, already in
+	//	the rocket's axes; replaces the separate angle and angular velocity calls.
+	virtual void SetInputSample(const ImuSample &sample);
+
 	virtual void update(void);
 
+	// Sets the inputs from the sample and steps the loop by the time since the sample it
+	//	last stepped on, from the samples' own timestamps; the scheduling jitter of the
+	//	caller and changes to the wall clock never reach the integral or derivative.
+	virtual void update(const ImuSample &sample);
+
+	// An axis' gains; the discrete PID's coefficients follow them.
+	virtual void SetGains(const E_CONTROLLED_AXES e, const double_t dKp, const double_t dKi, const double_t dKd);
+
+	// An axis' output range, radians; the discrete PID holds the output in it and unwinds
+	//	its integral against it.
+	virtual void SetOutputLimitsRadians(const E_CONTROLLED_AXES e, const double_t dLower, const double_t dUpper);
+
+	// Steps each axis as a DiscretePid, at the sample time: the coefficients are worked out
+	//	here and when the gains or limits change, and the derivative is filtered, the
+	//	integral can't wind up, and the setpoint can be weighted. Off, the original law.
+	virtual void SetDiscretePid(const bool b);
+
+	inline bool GetDiscretePid(void)
+	{
+		return bDiscretePid;
+	}
+
+	// An axis' PID; e.g., for its derivative filter, setpoint weights, or tracking time.
+	inline DiscretePid &GetPid(const E_CONTROLLED_AXES e)
+	{
+		return pid[e];
+	}
+
+	// The control period, in seconds; e.g., for shaping the outputs between steps.
+	inline double_t getSampleTime(void)
+	{
+		return sampleTime;
+	}
+
+	static const double_t MAX_DELTA_T;			// A longer gap (a stall) steps as if this long.
+	static const double_t SAMPLE_TIME_TOLERANCE;
+
 protected:
 
+	// The control law for one step of deltaT seconds; both update()s come here.
+	virtual void step(const double_t deltaT);
+
+	// Loads an axis' PID from the gains, the sample time, and the limits.
+	virtual void configurePid(const int32_t i);
+
 	char achControlName[FILENAME_MAX];
 
 	struct timespec thisTime, lastTime;
@@ -114,6 +163,12 @@ protected:
 
 	double_t sampleTime;				// in seconds.
 
+	int64_t iSampleTimestampNs;			// From the last SetInputSample().
+	int64_t iStepTimestampNs;			// The sample update(const ImuSample &) last stepped on.
+
+	DiscretePid pid[NUM_AXES];
+	bool bDiscretePid;
+
 
 private:
 
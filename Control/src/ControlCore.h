@@ -0,0 +1,187 @@
+/*
+	ControlCore.h - Multi-axis discrete PID core, structure of arrays, for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	DiscretePid's difference equation for all of a controller's axes at once. Each quantity
+	is an array over the axes (structure of arrays), padded out to whole 16 byte vectors and
+	aligned to them, and the step is one loop with no branches in it: the limits are a min and
+	a max, and the feedback modes are masks of ones and zeros that select each axis' output.
+	So the compiler can do two doubles or four floats a step with SSE2 or NEON (on 32 bit
+	ARM, NEON has no doubles, and floats need -mfpu=neon -funsafe-math-optimizations).
+
+	Axes is the number of axes and Scalar is float or double. The coefficients come from a
+	DiscretePid, set up as usual, with setAxis(); set the inputs, step(), and read the outputs.
+	An axis that's off outputs its setpoint, as RockHopperControl's do, and one that follows
+	outputs its measurement; neither keeps an integral or a derivative.
+
+	Header-only, as a template.
+
+*/
+
+#ifndef _CONTROL_CORE_H
+#define _CONTROL_CORE_H
+
+#include <inttypes.h>
+#include <string.h>
+#include <float.h>
+#include "DiscretePid.h"
+
+#define CONTROL_CORE_VERSION	1     		// software version of this library
+
+#define CONTROL_CORE_VECTOR_BYTES	16		// SSE2's and NEON's registers.
+
+template <uint32_t Axes, typename Scalar>
+class ControlCore
+{
+public:
+	// Axes rounded up to whole vectors; the padding has no mode, so it outputs zero.
+	static const uint32_t LANES = ( ( ( Axes * sizeof(Scalar) ) + CONTROL_CORE_VECTOR_BYTES - 1 ) /
+		CONTROL_CORE_VECTOR_BYTES ) * ( CONTROL_CORE_VECTOR_BYTES / sizeof(Scalar) );
+
+	ControlCore()
+	{
+		(void)memset((void *)this, 0, sizeof(*this));
+
+		for ( uint32_t i = 0 ; i < LANES ; i++ )
+			off[i] = ( i < Axes ) ? 1 : 0, lower[i] = -maximum(), upper[i] = maximum(), b[i] = 1;
+	}
+
+	// An axis' coefficients and limits, from a DiscretePid with the same sample time.
+	void setAxis(const uint32_t uAxis, DiscretePid &pid)
+	{
+		DiscretePidCoefficients coefficients;
+
+		pid.getCoefficients(coefficients);
+
+		kp[uAxis] = (Scalar)coefficients.Kp;
+		bi[uAxis] = (Scalar)coefficients.bi;
+		ad[uAxis] = (Scalar)coefficients.ad;
+		bd[uAxis] = (Scalar)coefficients.bd;
+		bdRate[uAxis] = (Scalar)coefficients.bdRate;
+		bt[uAxis] = (Scalar)coefficients.bt;
+		b[uAxis] = (Scalar)coefficients.dProportionalWeight;
+		c[uAxis] = (Scalar)coefficients.dDerivativeWeight;
+
+		// DBL_MAX, "no limit," is out of a float's range.
+		lower[uAxis] = (Scalar)fmax(coefficients.dLowerLimit, -(double_t)maximum());
+		upper[uAxis] = (Scalar)fmin(coefficients.dUpperLimit, (double_t)maximum());
+	}
+
+	// On, following (the output is the measurement), or neither (the output is the setpoint).
+	//	An axis that isn't on starts over when it's turned on.
+	void setMode(const uint32_t uAxis, const bool bOn, const bool bFollow)
+	{
+		on[uAxis]		= bOn ? 1 : 0;
+		follow[uAxis]	= ( !bOn && bFollow ) ? 1 : 0;
+		off[uAxis]		= ( !bOn && !bFollow ) ? 1 : 0;
+	}
+
+	inline void setInput(const uint32_t uAxis, const Scalar dSetpoint, const Scalar dMeasurement, const Scalar dRate = 0)
+	{
+		setpoint[uAxis] = dSetpoint, measurement[uAxis] = dMeasurement, rate[uAxis] = dRate;
+	}
+
+	inline Scalar getOutput(const uint32_t uAxis) const
+	{
+		return output[uAxis];
+	}
+
+	inline Scalar getIntegral(const uint32_t uAxis) const
+	{
+		return integral[uAxis];
+	}
+
+	// Clears every axis' integral and derivative.
+	void reset(void)
+	{
+		for ( uint32_t i = 0 ; i < LANES ; i++ )
+			integral[i] = derivative[i] = lastDerivativeError[i] = primed[i] = 0;
+	}
+
+	// One sample time's step, with the derivative from the difference of the measurements.
+	inline void step(void)
+	{
+		for ( uint32_t i = 0 ; i < LANES ; i++ )
+		{
+			const Scalar derivativeError = ( c[i] * setpoint[i] ) - measurement[i];
+			const Scalar derivativeNew = ( ad[i] * derivative[i] ) + ( primed[i] * bd[i] * ( derivativeError - lastDerivativeError[i] ) );
+
+			lastDerivativeError[i] = derivativeError;
+
+			finish(i, derivativeNew);
+		}
+	}
+
+	// The same, with the derivative from the measured rates; added, as DiscretePid's is.
+	inline void stepWithRates(void)
+	{
+		for ( uint32_t i = 0 ; i < LANES ; i++ )
+			finish(i, ( ad[i] * derivative[i] ) + ( bdRate[i] * rate[i] ));
+	}
+
+private:
+	static inline Scalar maximum(void)
+	{
+		return ( sizeof(Scalar) < sizeof(double) ) ? (Scalar)FLT_MAX : (Scalar)DBL_MAX;
+	}
+
+	// The rest of a step, given the new derivative; the modes' masks pick the output.
+	inline void finish(const uint32_t i, const Scalar derivativeNew)
+	{
+		const Scalar unlimited = ( kp[i] * ( ( b[i] * setpoint[i] ) - measurement[i] ) ) + integral[i] + derivativeNew;
+
+		Scalar limited = ( unlimited < upper[i] ) ? unlimited : upper[i];
+		limited = ( limited > lower[i] ) ? limited : lower[i];
+
+		integral[i] = on[i] * ( integral[i] + ( bi[i] * ( setpoint[i] - measurement[i] ) ) + ( bt[i] * ( limited - unlimited ) ) );
+		derivative[i] = on[i] * derivativeNew;
+		primed[i] = on[i];
+
+		output[i] = ( on[i] * limited ) + ( follow[i] * measurement[i] ) + ( off[i] * setpoint[i] );
+	}
+
+	// The inputs and outputs.
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar setpoint[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar measurement[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar rate[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar output[LANES];
+
+	// The coefficients and the limits.
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar kp[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar bi[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar ad[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar bd[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar bdRate[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar bt[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar b[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar c[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar lower[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar upper[LANES];
+
+	// The modes' masks; exactly one is one on each axis, none on the padding.
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar on[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar follow[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar off[LANES];
+
+	// The state.
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar integral[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar derivative[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar lastDerivativeError[LANES];
+	alignas(CONTROL_CORE_VECTOR_BYTES) Scalar primed[LANES];
+};
+
+#endif	// _CONTROL_CORE_H
@@ -0,0 +1,128 @@
+/*
+	DiscretePid.cpp - Precomputed discrete-time PID for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <stdio.h>
+#include <float.h>
+#include "DiscretePid.h"
+
+const bool DiscretePid::bDebug = false;
+
+const double_t DiscretePid::DEFAULT_SAMPLE_TIME			= 0.02;		// One 50 Hz control period.
+const double_t DiscretePid::DERIVATIVE_FILTER_DIVISOR	= 10.0;
+
+DiscretePid::DiscretePid(const double_t dKp /*= 0.0*/, const double_t dKi /*= 0.0*/, const double_t dKd /*= 0.0*/,
+	const double_t dSampleTime /*= DEFAULT_SAMPLE_TIME*/) :
+	Kp(dKp), Ki(dKi), Kd(dKd), dSampleTime(dSampleTime), dFilterTime(0.0), dTrackingTime(0.0),
+	dProportionalWeight(1.0), dDerivativeWeight(0.0), dLowerLimit(-DBL_MAX), dUpperLimit(DBL_MAX),
+	bi(0.0), ad(0.0), bd(0.0), bdRate(0.0), bt(0.0)
+{
+	reset();
+	compute();
+}
+
+void DiscretePid::setGains(const double_t dKp, const double_t dKi, const double_t dKd)
+{
+	Kp = dKp, Ki = dKi, Kd = dKd;
+	compute();
+}
+
+void DiscretePid::setSampleTime(const double_t dSeconds)
+{
+	dSampleTime = dSeconds;
+	compute();
+}
+
+void DiscretePid::setDerivativeFilter(const double_t dSeconds)
+{
+	dFilterTime = fmax(dSeconds, 0.0);
+	compute();
+}
+
+void DiscretePid::setSetpointWeights(const double_t dProportional, const double_t dDerivative)
+{
+	dProportionalWeight = dProportional, dDerivativeWeight = dDerivative;
+	bPrimed = false;
+}
+
+void DiscretePid::setOutputLimits(const double_t dLower, const double_t dUpper)
+{
+	dLowerLimit = fmin(dLower, dUpper), dUpperLimit = fmax(dLower, dUpper);
+}
+
+void DiscretePid::setTrackingTime(const double_t dSeconds)
+{
+	dTrackingTime = fmax(dSeconds, 0.0);
+	compute();
+}
+
+void DiscretePid::reset(void)
+{
+	dIntegral = dDerivative = dLastDerivativeError = dOutput = 0.0;
+	bPrimed = false;
+}
+
+void DiscretePid::getCoefficients(DiscretePidCoefficients &coefficients)
+{
+	coefficients.Kp = Kp;
+	coefficients.bi = bi, coefficients.ad = ad, coefficients.bd = bd, coefficients.bdRate = bdRate, coefficients.bt = bt;
+	coefficients.dProportionalWeight = dProportionalWeight, coefficients.dDerivativeWeight = dDerivativeWeight;
+	coefficients.dLowerLimit = dLowerLimit, coefficients.dUpperLimit = dUpperLimit;
+}
+
+void DiscretePid::compute(void)
+{
+	if ( 0.0 >= dSampleTime )
+	{
+		if ( bDebug )
+			(void)printf("%s: no sample time; the PID's output is zero.\n", __FUNCTION__);
+
+		bi = ad = bd = bdRate = bt = 0.0;
+		return;
+	}
+
+	const double_t Ts = dSampleTime;
+
+	// Td and Ti, where the gains give them; without Kp, a sample time each.
+	const double_t Td = ( ( 0.0 != Kp ) && ( 0.0 != Kd ) ) ? fabs(Kd / Kp) : 0.0;
+	const double_t Ti = ( ( 0.0 != Kp ) && ( 0.0 != Ki ) ) ? fabs(Kp / Ki) : Ts;
+
+	double_t Tf = dFilterTime;
+
+	if ( 0.0 == Tf )
+		Tf = ( 0.0 < Td ) ? ( Td / DERIVATIVE_FILTER_DIVISOR ) : Ts;
+
+	double_t Tt = dTrackingTime;
+
+	if ( 0.0 == Tt )
+		Tt = ( 0.0 < Td ) ? sqrt(Ti * Td) : Ti;
+
+	// Faster than a sample time would overcorrect, and ring.
+	if ( Tt < Ts )
+		Tt = Ts;
+
+	bi		= Ki * Ts;
+	ad		= Tf / ( Tf + Ts );
+	bd		= Kd / ( Tf + Ts );
+	bdRate	= bd * Ts;
+	bt		= ( 0.0 != Ki ) ? ( Ts / Tt ) : 0.0;
+
+	if ( bDebug )
+		(void)printf("%s: bi %f ad %f bd %f bt %f\n", __FUNCTION__, bi, ad, bd, bt);
+}
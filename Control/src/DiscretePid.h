@@ -0,0 +1,170 @@
+/*
+	DiscretePid.h - Precomputed discrete-time PID for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	A PID as a difference equation, for a loop that runs at a fixed sample time. The
+	coefficients are worked out when the gains, the sample time, or the time constants
+	change, so a step is a handful of multiply-adds and no divisions:
+
+		P(k)	= Kp * ( b * r(k) - y(k) )
+		D(k)	= ad * D(k-1) + bd * ( e_d(k) - e_d(k-1) ),	e_d = c * r - y
+		v(k)	= P(k) + I(k) + D(k),		u(k) = v(k) within the limits
+		I(k+1)	= I(k) + bi * ( r(k) - y(k) ) + bt * ( u(k) - v(k) )
+
+	with bi = Ki * Ts, ad = Tf / ( Tf + Ts ), bd = Kd / ( Tf + Ts ), and bt = Ts / Tt.
+
+	The derivative goes through a first order filter of time constant Tf (by default Td / 10,
+	where Td = Kd / Kp), so the sensor noise isn't amplified without bound. The setpoint
+	weights b and c scale how much of the setpoint the proportional and derivative terms
+	see; at the defaults (1 and 0) a setpoint step doesn't kick the output through the
+	derivative. The integral is only ever driven by the whole error.
+
+	When the output is limited, the difference is fed back into the integral with the
+	tracking time Tt (by default sqrt(Ti * Td), or Ti without a derivative), so the integral
+	unwinds rather than growing while the actuator is against its stop.
+
+	A step given the measured rate (e.g., a gyroscope's) uses it for the derivative in place
+	of the difference of the measurements; bd * Ts * rate, added as RockHopperControl's law
+	adds Kd * rate, with the setpoint's weight zero.
+
+*/
+
+#ifndef _DISCRETE_PID_H
+#define _DISCRETE_PID_H
+
+#include <inttypes.h>
+#include <math.h>
+
+#define DISCRETE_PID_VERSION	1     		// software version of this library
+
+// A step's coefficients and limits, as worked out from the parameters; e.g., for ControlCore.
+typedef struct sDiscretePidCoefficients
+{
+	double_t Kp;
+	double_t bi, ad, bd, bdRate, bt;
+	double_t dProportionalWeight, dDerivativeWeight;
+	double_t dLowerLimit, dUpperLimit;
+} DiscretePidCoefficients;
+
+class DiscretePid
+{
+public:
+	DiscretePid(const double_t dKp = 0.0, const double_t dKi = 0.0, const double_t dKd = 0.0,
+		const double_t dSampleTime = DEFAULT_SAMPLE_TIME);
+
+	void setGains(const double_t dKp, const double_t dKi, const double_t dKd);
+
+	// Seconds; the caller has to step it this often.
+	void setSampleTime(const double_t dSeconds);
+
+	// The derivative's filter time constant, seconds; zero for Td / DERIVATIVE_FILTER_DIVISOR.
+	void setDerivativeFilter(const double_t dSeconds);
+
+	// The proportional and derivative terms' shares of the setpoint.
+	void setSetpointWeights(const double_t dProportional, const double_t dDerivative);
+
+	// The actuator's range; the output stays inside it and the integral tracks it.
+	void setOutputLimits(const double_t dLower, const double_t dUpper);
+
+	// Seconds; zero for the default above.
+	void setTrackingTime(const double_t dSeconds);
+
+	// Clears the integral and the derivative; the next step starts the derivative over.
+	void reset(void);
+
+	// One sample time's step; returns the output.
+	inline double_t step(const double_t dSetpoint, const double_t dMeasurement)
+	{
+		const double_t dDerivativeError = ( dDerivativeWeight * dSetpoint ) - dMeasurement;
+
+		dDerivative = bPrimed ? ( ad * dDerivative ) + ( bd * ( dDerivativeError - dLastDerivativeError ) ) : 0.0;
+
+		dLastDerivativeError = dDerivativeError, bPrimed = true;
+
+		return output(dSetpoint, dMeasurement);
+	}
+
+	// The same, with the derivative from a measured rate; added, with RockHopperControl's sign.
+	inline double_t step(const double_t dSetpoint, const double_t dMeasurement, const double_t dRate)
+	{
+		dDerivative = ( ad * dDerivative ) + ( bdRate * dRate );
+
+		return output(dSetpoint, dMeasurement);
+	}
+
+	inline double_t getOutput(void)
+	{
+		return dOutput;
+	}
+
+	inline double_t getIntegral(void)
+	{
+		return dIntegral;
+	}
+
+	inline double_t getSampleTime(void)
+	{
+		return dSampleTime;
+	}
+
+	inline bool saturated(void)
+	{
+		return ( dOutput <= dLowerLimit ) || ( dOutput >= dUpperLimit );
+	}
+
+	void getCoefficients(DiscretePidCoefficients &coefficients);
+
+	static const double_t DEFAULT_SAMPLE_TIME;			// seconds.
+	static const double_t DERIVATIVE_FILTER_DIVISOR;	// N, in Tf = Td / N.
+
+private:
+	// Works out the coefficients from the parameters.
+	void compute(void);
+
+	inline double_t output(const double_t dSetpoint, const double_t dMeasurement)
+	{
+		const double_t dUnlimited = ( Kp * ( ( dProportionalWeight * dSetpoint ) - dMeasurement ) ) + dIntegral + dDerivative;
+
+		dOutput = ( dUnlimited > dUpperLimit ) ? dUpperLimit : ( ( dUnlimited < dLowerLimit ) ? dLowerLimit : dUnlimited );
+
+		dIntegral += ( bi * ( dSetpoint - dMeasurement ) ) + ( bt * ( dOutput - dUnlimited ) );
+
+		return dOutput;
+	}
+
+	// The parameters.
+	double_t Kp, Ki, Kd;
+	double_t dSampleTime;
+	double_t dFilterTime;					// Zero for the default.
+	double_t dTrackingTime;					// Zero for the default.
+	double_t dProportionalWeight, dDerivativeWeight;
+	double_t dLowerLimit, dUpperLimit;
+
+	// The coefficients.
+	double_t bi, ad, bd, bdRate, bt;
+
+	// The state.
+	double_t dIntegral;
+	double_t dDerivative;
+	double_t dLastDerivativeError;
+	double_t dOutput;
+	bool bPrimed;							// dLastDerivativeError is good.
+
+	static const bool bDebug;
+};
+
+#endif	// _DISCRETE_PID_H
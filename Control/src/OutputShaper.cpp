@@ -0,0 +1,131 @@
+/*
+	OutputShaper.cpp - Interpolation and slew and acceleration limits for actuator commands for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <stdio.h>
+#include "OutputShaper.h"
+
+const bool OutputShaper::bDebug = false;
+
+const double_t OutputShaper::DEFAULT_INTERPOLATION_TIME	= 0.02;		// One 50 Hz control period.
+const double_t OutputShaper::DEFAULT_SLEW_LIMIT			= 90.0;		// Gimbal degrees per second; about what an MG90S
+																	//	does through the K-9's linkage, unloaded.
+const double_t OutputShaper::DEFAULT_ACCELERATION_LIMIT	= 9000.0;	// To full slew in 10 ms.
+
+OutputShaper::OutputShaper(const double_t dInterpolationTime /*= DEFAULT_INTERPOLATION_TIME*/,
+	const double_t dSlewLimit /*= DEFAULT_SLEW_LIMIT*/, const double_t dAccelerationLimit /*= DEFAULT_ACCELERATION_LIMIT*/) :
+	dInterpolationTime(dInterpolationTime), dSlewLimit(dSlewLimit), dAccelerationLimit(dAccelerationLimit),
+	dTarget(0.0), dRampStart(0.0), iRampStartNs(0), dOutput(0.0), dVelocity(0.0), iOutputNs(0)
+{
+}
+
+void OutputShaper::reset(const double_t dValue, const int64_t iTimestampNs)
+{
+	dTarget = dRampStart = dOutput = dValue;
+	iRampStartNs = iOutputNs = iTimestampNs;
+	dVelocity = 0.0;
+}
+
+void OutputShaper::setTarget(const double_t dNewTarget, const int64_t iTimestampNs)
+{
+	if ( 0 == iOutputNs )
+	{
+		reset(dNewTarget, iTimestampNs);
+		return;
+	}
+
+	// From where the old line is now, so a command that comes mid-line doesn't kink it back.
+	dRampStart = reference(iTimestampNs);
+	iRampStartNs = iTimestampNs;
+	dTarget = dNewTarget;
+}
+
+double_t OutputShaper::reference(const int64_t iTimestampNs)
+{
+	const double_t dElapsed = ( iTimestampNs - iRampStartNs ) * 1e-9;
+
+	if ( ( 0.0 >= dInterpolationTime ) || ( dElapsed >= dInterpolationTime ) )
+		return dTarget;
+	else if ( 0.0 >= dElapsed )
+		return dRampStart;
+	else
+		return dRampStart + ( ( dTarget - dRampStart ) * ( dElapsed / dInterpolationTime ) );
+}
+
+double_t OutputShaper::step(const int64_t iTimestampNs)
+{
+	if ( 0 == iOutputNs )
+	{
+		reset(dTarget, iTimestampNs);
+		return dOutput;
+	}
+
+	const double_t dt = ( iTimestampNs - iOutputNs ) * 1e-9;
+
+	if ( 0.0 >= dt )
+		return dOutput;
+
+	iOutputNs = iTimestampNs;
+
+	// What would put the output on the line this frame,
+	double_t dWanted = ( reference(iTimestampNs) - dOutput ) / dt;
+
+	// no faster than the slew limit,
+	if ( ( 0.0 < dSlewLimit ) && ( fabs(dWanted) > dSlewLimit ) )
+		dWanted = copysign(dSlewLimit, dWanted);
+
+	if ( 0.0 < dAccelerationLimit )
+	{
+		// and slow enough to stop at the target, braking a frame at a time;
+		const double_t dRemaining = dTarget - dOutput,
+			dStopping = dAccelerationLimit * ( sqrt(( dt * dt / 4.0 ) + ( 2.0 * fabs(dRemaining) / dAccelerationLimit )) - ( dt / 2.0 ) );
+
+		if ( ( ( 0.0 < dRemaining ) && ( dWanted > dStopping ) ) || ( ( 0.0 > dRemaining ) && ( dWanted < -dStopping ) ) )
+			dWanted = copysign(dStopping, dRemaining);
+
+		// the change in speed no more than the acceleration limit allows.
+		const double_t dMaxChange = dAccelerationLimit * dt;
+
+		if ( dWanted > ( dVelocity + dMaxChange ) )
+			dWanted = dVelocity + dMaxChange;
+		else if ( dWanted < ( dVelocity - dMaxChange ) )
+			dWanted = dVelocity - dMaxChange;
+		else
+			;
+	}
+
+	const double_t dBefore = dTarget - dOutput;
+
+	dVelocity = dWanted;
+	dOutput += dVelocity * dt;
+
+	// Never past the target; the last bit of braking lands on it.
+	if ( ( ( 0.0 < dBefore ) && ( dOutput > dTarget ) ) || ( ( 0.0 > dBefore ) && ( dOutput < dTarget ) ) )
+		dOutput = dTarget, dVelocity = 0.0;
+
+	if ( bDebug )
+		(void)printf("%s: target %lf, output %lf, velocity %lf\n", __FUNCTION__, dTarget, dOutput, dVelocity);
+
+	return dOutput;
+}
+
+bool OutputShaper::settled(void)
+{
+	return ( dOutput == dTarget ) && ( 0.0 == dVelocity );
+}
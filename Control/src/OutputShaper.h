@@ -0,0 +1,125 @@
+/*
+	OutputShaper.h - Interpolation and slew and acceleration limits for actuator commands for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	The control loop runs at 50 Hz, while the servos take a new pulse width every 2.5 ms
+	(400 Hz); written as they come, its outputs move the gimbal in 20 ms steps, each one a
+	jolt to the horn and the nozzle. The shaper sits between the two rates: setTarget()
+	takes each new command, and step(), once per PWM frame, returns the value to write.
+
+	Each command is reached by a straight line from where the previous line was heading,
+	over the interpolation time (one control period, by default), so the output lags the
+	control by that much. The output then follows that line no faster than the slew limit
+	and speeds up or slows down no faster than the acceleration limit, braking so it
+	arrives without overshooting. A limit of zero turns it off.
+
+	Units are whatever the caller's are; for the gimbal, degrees, degrees per second, and
+	degrees per second squared. Timestamps are CLOCK_MONOTONIC nanoseconds.
+
+*/
+
+#ifndef _OUTPUT_SHAPER_H
+#define _OUTPUT_SHAPER_H
+
+#include <inttypes.h>
+#include <math.h>
+
+#define OUTPUT_SHAPER_VERSION	1     		// software version of this library
+
+class OutputShaper
+{
+public:
+	OutputShaper(const double_t dInterpolationTime = DEFAULT_INTERPOLATION_TIME,
+		const double_t dSlewLimit = DEFAULT_SLEW_LIMIT, const double_t dAccelerationLimit = DEFAULT_ACCELERATION_LIMIT);
+
+	// The output jumps to dValue and stays; e.g., at start up.
+	void reset(const double_t dValue, const int64_t iTimestampNs);
+
+	// A new command; the output heads for it from here.
+	void setTarget(const double_t dTarget, const int64_t iTimestampNs);
+
+	// The output at this frame's time; call once a frame.
+	double_t step(const int64_t iTimestampNs);
+
+	// At the last command, and not moving.
+	bool settled(void);
+
+	inline double_t getOutput(void)
+	{
+		return dOutput;
+	}
+
+	inline double_t getTarget(void)
+	{
+		return dTarget;
+	}
+
+	inline void setInterpolationTime(const double_t dSeconds)
+	{
+		dInterpolationTime = dSeconds;
+	}
+
+	inline double_t getInterpolationTime(void)
+	{
+		return dInterpolationTime;
+	}
+
+	inline void setSlewLimit(const double_t dLimit)
+	{
+		dSlewLimit = dLimit;
+	}
+
+	inline double_t getSlewLimit(void)
+	{
+		return dSlewLimit;
+	}
+
+	inline void setAccelerationLimit(const double_t dLimit)
+	{
+		dAccelerationLimit = dLimit;
+	}
+
+	inline double_t getAccelerationLimit(void)
+	{
+		return dAccelerationLimit;
+	}
+
+	static const double_t DEFAULT_INTERPOLATION_TIME;	// seconds.
+	static const double_t DEFAULT_SLEW_LIMIT;
+	static const double_t DEFAULT_ACCELERATION_LIMIT;
+
+private:
+	// Where the straight line is at a time.
+	double_t reference(const int64_t iTimestampNs);
+
+	double_t dInterpolationTime;
+	double_t dSlewLimit;
+	double_t dAccelerationLimit;
+
+	double_t dTarget;
+	double_t dRampStart;					// The line runs from here, at iRampStartNs, to dTarget.
+	int64_t iRampStartNs;
+
+	double_t dOutput;
+	double_t dVelocity;						// units per second.
+	int64_t iOutputNs;						// Zero before the first step() or reset().
+
+	static const bool bDebug;
+};
+
+#endif	// _OUTPUT_SHAPER_H
@@ -33,7 +33,7 @@ RockHopperControl::RockHopperControl(void) :
 
 	sampleTime = 0.02;					// We'll use 50 Hz.
 
-	for ( int32_t i = E_PITCH_AXIS; i < E_ROLL_AXIS ; i++ )
+	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
 	{
 		eControlled[i] = E_FEEDBACK_OFF;
 
@@ -42,6 +42,12 @@ RockHopperControl::RockHopperControl(void) :
 		Kd[i] = 0.230;
 	}
 
+	// The K-9's travel; the discrete PID unwinds its integral against it.
+	dControlRadiansLowerLimits[E_PITCH_AXIS]	= K9_MIN_PITCH_ANGLE_RADIANS;
+	dControlRadiansUpperLimits[E_PITCH_AXIS]	= K9_MAX_PITCH_ANGLE_RADIANS;
+	dControlRadiansLowerLimits[E_YAW_AXIS]		= K9_MIN_YAW_ANGLE_RADIANS;
+	dControlRadiansUpperLimits[E_YAW_AXIS]		= K9_MAX_YAW_ANGLE_RADIANS;
+
 }
 
 RockHopperControl::~RockHopperControl()
@@ -49,29 +55,27 @@ RockHopperControl::~RockHopperControl()
     ;
 }
 
-// Try to use base class' method!
-void RockHopperControl::update(void)
+// The base class' update()s time the steps; this is the law.
+void RockHopperControl::step(const double_t deltaT)
 {
-	(void)clock_gettime(CLOCK_REALTIME, &thisTime);
+	double_t dProportional[NUM_AXES] = 
+	{
+		0.0, 0.0, 0.0
+	};
 
-	double_t deltaT = 0.0;
+	// The IMU's rates are the derivatives, with the same sign as the law below gives Kd.
+	if ( bDiscretePid )
+	{
+		for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+			core.setInput(i, dControlRadiansSettings[i], dSensorRadiansValues[i], dSensorRadiansPerSecondValues[i]);
 
-	time_t tv_delta_sec = ( thisTime.tv_sec - lastTime.tv_sec );
-		long tv_delta_ns	= thisTime.tv_nsec - lastTime.tv_nsec;
+		core.stepWithRates();
 
-	deltaT = tv_delta_ns;
-	deltaT /= 1e9;
-	deltaT += tv_delta_sec;
+		for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+			dOutputValues[i] = core.getOutput(i);
 
-	if ( deltaT < sampleTime )
 		return;
-
-	lastTime = thisTime;
-
-	double_t dProportional[NUM_AXES] = 
-	{
-		0.0, 0.0, 0.0
-	};
+	}
 
 	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
 	{
@@ -110,4 +114,27 @@ void RockHopperControl::GetControlledAxes(E_FEEDBACK_MODE &ePitch, E_FEEDBACK_MO
 	ePitch	= eControlled[E_PITCH_AXIS],
 	eRoll 	= E_FEEDBACK_OFF,
 	eYaw 	= eControlled[E_YAW_AXIS];
-}
\ No newline at end of file
+}
+
+void RockHopperControl::SetControlledAxes(const E_FEEDBACK_MODE &ePitch, const E_FEEDBACK_MODE &eRoll, const E_FEEDBACK_MODE &eYaw)
+{
+	Control::SetControlledAxes(ePitch, eRoll, eYaw);
+
+	for ( int32_t i = E_PITCH_AXIS; i <= E_YAW_AXIS ; i++ )
+		core.setMode(i, E_FEEDBACK_ON == eControlled[i], E_FEEDBACK_FOLLOW == eControlled[i]);
+}
+
+void RockHopperControl::SetDiscretePid(const bool b)
+{
+	if ( b && !bDiscretePid )
+		core.reset();
+
+	Control::SetDiscretePid(b);
+}
+
+void RockHopperControl::configurePid(const int32_t i)
+{
+	Control::configurePid(i);
+
+	core.setAxis(i, pid[i]);
+}
@@ -24,6 +24,7 @@
 
 #include "K_9_TVC_Gimbal_Generation_2.h"
 #include "Control.h"
+#include "ControlCore.h"
 
 class RockHopperControl : public Control
 {
@@ -32,9 +33,19 @@ public:
 	~RockHopperControl();
 
 	virtual void GetControlledAxes(E_FEEDBACK_MODE &ePitch, E_FEEDBACK_MODE &eRoll, E_FEEDBACK_MODE &eYaw);
-	virtual void update(void);
+
+	virtual void SetControlledAxes(const E_FEEDBACK_MODE &ePitch, const E_FEEDBACK_MODE &eRoll, const E_FEEDBACK_MODE &eYaw);
+
+	// The discrete PIDs step together, in a ControlCore.
+	virtual void SetDiscretePid(const bool b);
 
 protected:
+	virtual void step(const double_t deltaT);
+
+	// Also loads the axis into the core.
+	virtual void configurePid(const int32_t i);
+
+	ControlCore<NUM_AXES, double_t> core;
 
 
 private:
@@ -58,8 +58,8 @@ const double_t DoBoFo70Pro12::setWeight = 182;      // g
 
 const double_t DoBoFo70Pro12::fanDiameter   = 69.4; // mm
 
-DoBoFo70Pro12::DoBoFo70Pro12(E_JETS sIndex/*=E_JET_0*/, E_SERVO_CHANNELS spIndex/*=E_PWM_0*/) :
-    EDF(DOBOFO70PRO12_NAME, sIndex, spIndex, DOBOFO70PRO12_MAX_THRUST)
+DoBoFo70Pro12::DoBoFo70Pro12(E_JETS sIndex/*=E_JET_0*/, E_SERVO_CHANNELS spIndex/*=E_PWM_0*/, PwmBackend *pBackend /*= NULL*/) :
+    EDF(DOBOFO70PRO12_NAME, sIndex, spIndex, DOBOFO70PRO12_MAX_THRUST, pBackend)
 {
 	maxThrust = DOBOFO70PRO12_MAX_THRUST;
 
@@ -75,7 +75,7 @@ class DoBoFo70Pro12 : public EDF
 {
 
 public:
-	DoBoFo70Pro12(E_JETS sIndex=E_JET_0, E_SERVO_CHANNELS spIndex=E_PWM_2);
+	DoBoFo70Pro12(E_JETS sIndex=E_JET_0, E_SERVO_CHANNELS spIndex=E_PWM_2, PwmBackend *pBackend = NULL);
 	~DoBoFo70Pro12();
 
 	virtual void throttle(double_t position = 0.0);
@@ -24,9 +24,9 @@
 #include <float.h>
 #include "EDF.h"
 
-EDF::EDF(const char *edfName, E_JETS sIndex/*=E_JET_0*/, E_SERVO_CHANNELS spIndex/*=E_PWM_0*/, double_t mThrust /*= DBL_MAX*/) :
+EDF::EDF(const char *edfName, E_JETS sIndex/*=E_JET_0*/, E_SERVO_CHANNELS spIndex/*=E_PWM_0*/, double_t mThrust /*= DBL_MAX*/, PwmBackend *pBackend /*= NULL*/) :
 	Jet(edfName, sIndex),
-	myControl(spIndex), maxThrust(mThrust),
+	myControl(spIndex, pBackend), maxThrust(mThrust),
 	myESC(NULL)
 {
 	throttle(0.0);
@@ -48,7 +48,7 @@ private:
 class EDF : public Jet
 {
 public:
-	EDF(const char *edfName, E_JETS sIndex=E_JET_0, E_SERVO_CHANNELS spIndex=E_PWM_0, double_t mThrust = DBL_MAX);
+	EDF(const char *edfName, E_JETS sIndex=E_JET_0, E_SERVO_CHANNELS spIndex=E_PWM_0, double_t mThrust = DBL_MAX, PwmBackend *pBackend = NULL);
 	~EDF();
 
 	virtual void throttle(double_t position = 0.0);
@@ -120,4 +120,18 @@ void Gimbal::writeAngleDegrees(E_CONTROLLED_AXES e, double_t dDegrees)
     ;
 }
 
+// Without an actuator model, it's where it was told to go, already.
+double_t Gimbal::estimatedAngleDegrees(E_CONTROLLED_AXES e, int64_t iTimestampNs /*= 0*/)
+{
+    return readAngleDegrees(e);
+}
+double_t Gimbal::estimatedAngleRadians(E_CONTROLLED_AXES e, int64_t iTimestampNs /*= 0*/)
+{
+    return readAngleRadians(e);
+}
+int64_t Gimbal::settledAt(E_CONTROLLED_AXES e)
+{
+    return 0;
+}
+
 
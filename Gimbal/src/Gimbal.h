@@ -71,6 +71,12 @@ public:
 	virtual void writeAngleCenterDegrees(E_CONTROLLED_AXES e, double_t dDegrees = CENTER_ANGLE_DEGREES);
 	virtual void writeAngleLowerLimitDegrees(E_CONTROLLED_AXES e, double_t dDegrees = MIN_ANGLE_DEGREES);    
 
+	// Where the actuator has got to at a CLOCK_MONOTONIC time (zero is now), rather than
+	//	where it was told to go, and when it gets there; see Servo::estimatedAngleDegrees().
+	virtual double_t estimatedAngleDegrees(E_CONTROLLED_AXES e, int64_t iTimestampNs = 0);
+	virtual double_t estimatedAngleRadians(E_CONTROLLED_AXES e, int64_t iTimestampNs = 0);
+	virtual int64_t settledAt(E_CONTROLLED_AXES e);
+
 protected:
 	char achGimbalName[FILENAME_MAX];
 
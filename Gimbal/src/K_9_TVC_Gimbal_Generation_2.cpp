@@ -73,15 +73,15 @@
 #define SERVO_CENTER_PITCH_ANGLE_RADIANS    (SERVO_CENTER_PITCH_ANGLE_DEGREES * M_PI / 180.0)
 #define SERVO_DEFAULT_PITCH_ANGLE_RADIANS   (SERVO_DEFAULT_PITCH_ANGLE_DEGREES * M_PI / 180.0)
 
-K9TvcGimbal::K9TvcGimbal(void) : Gimbal("K-9 TVC Gimbal Generation 2")
+K9TvcGimbal::K9TvcGimbal(PwmBackend *pBackend /*= NULL*/) : Gimbal("K-9 TVC Gimbal Generation 2")
 {
 
     bDebug = false;
 
     // Todo: change PWM numbers to pass parameters.
-    apcServos[E_PITCH_AXIS] = new Servo(E_PWM_0);
+    apcServos[E_PITCH_AXIS] = new Servo(E_PWM_0, pBackend);
     apcServos[E_ROLL_AXIS]  = NULL;
-    apcServos[E_YAW_AXIS]   = new Servo(E_PWM_1); 
+    apcServos[E_YAW_AXIS]   = new Servo(E_PWM_1, pBackend); 
 
     weight = 70.0;                      // g
     
@@ -157,6 +157,33 @@ double_t K9TvcGimbal::readAngleRadians(E_CONTROLLED_AXES e)
     return readAngleDegrees(e) * M_PI / MAX_ANGLE;
 }
 
+double_t K9TvcGimbal::estimatedAngleDegrees(E_CONTROLLED_AXES e, int64_t iTimestampNs /*= 0*/)
+{
+    if ( E_ROLL_AXIS == e )
+        return 0.0;
+
+    // The same mapping as readAngleDegrees().
+    return Jet::map(apcServos[e]->estimatedAngleDegrees(iTimestampNs),
+        apcServos[E_YAW_AXIS]->readAngleLowerLimitDegrees(), apcServos[E_YAW_AXIS]->readAngleUpperLimitDegrees(),
+        dAngleLowerLimits[e], dAngleUpperLimits[e]);
+}
+
+double_t K9TvcGimbal::estimatedAngleRadians(E_CONTROLLED_AXES e, int64_t iTimestampNs /*= 0*/)
+{
+    if ( E_ROLL_AXIS == e )
+        return 0.0;
+
+    return estimatedAngleDegrees(e, iTimestampNs) * M_PI / MAX_ANGLE;
+}
+
+int64_t K9TvcGimbal::settledAt(E_CONTROLLED_AXES e)
+{
+    if ( E_ROLL_AXIS == e )
+        return 0;
+
+    return apcServos[e]->settledAt();
+}
+
 void K9TvcGimbal::writeAngleDegrees(E_CONTROLLED_AXES e, double_t dDegrees)
 {
     if ( E_ROLL_AXIS == e )
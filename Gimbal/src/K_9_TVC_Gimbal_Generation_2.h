@@ -68,7 +68,8 @@
 class K9TvcGimbal : public Gimbal
 {
 public:
-	K9TvcGimbal(void);
+	// The servos write through pBackend, e.g., a PCA9685, if given; else sysfs.
+	K9TvcGimbal(PwmBackend *pBackend = NULL);
 	virtual ~K9TvcGimbal();  
 
 	// -180 to +180 degrees.
@@ -79,6 +80,11 @@ public:
 	virtual double_t readAngleRadians(E_CONTROLLED_AXES e);
 	virtual void writeAngleRadians(E_CONTROLLED_AXES e, double_t dRadians);
 
+	// From the servos' slew model.
+	virtual double_t estimatedAngleDegrees(E_CONTROLLED_AXES e, int64_t iTimestampNs = 0);
+	virtual double_t estimatedAngleRadians(E_CONTROLLED_AXES e, int64_t iTimestampNs = 0);
+	virtual int64_t settledAt(E_CONTROLLED_AXES e);
+
 protected:
 
     Servo *apcServos[NUM_AXES];
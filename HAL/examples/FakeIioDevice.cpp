@@ -0,0 +1,271 @@
+/*
+	FakeIioDevice.cpp - Exercise the IioBuffer scan decoder without hardware.
+
+	Builds a stand-in for "/sys/bus/iio/devices/iio:device1" under "/tmp," with the
+	scan elements the bno055 driver exposes, and a FIFO in place of "/dev/iio:device1."
+	A child process writes packed scans into the FIFO; the parent decodes and checks them.
+	The writer stalls before its last scan, so the reader's timeout has to fire once.
+
+	Usage: FakeIioDevice [number of scans]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "IioBuffer.h"
+
+#define FAKE_SYSFS_PATH		"/tmp/fake-iio-device1"
+#define FAKE_DEVICE_PATH	FAKE_SYSFS_PATH "/dev"
+
+typedef struct sFakeElement
+{
+	const char *pName;
+	int32_t iIndex;
+	const char *pType;
+} FakeElement;
+
+// The bno055 driver's scan elements.
+static const FakeElement fakeElements[] =
+{
+	{ "in_accel_x",			0,	"le:s16/16>>0"		},
+	{ "in_accel_y",			1,	"le:s16/16>>0"		},
+	{ "in_accel_z",			2,	"le:s16/16>>0"		},
+	{ "in_magn_x",			3,	"le:s16/16>>0"		},
+	{ "in_magn_y",			4,	"le:s16/16>>0"		},
+	{ "in_magn_z",			5,	"le:s16/16>>0"		},
+	{ "in_anglvel_x",		6,	"le:s16/16>>0"		},
+	{ "in_anglvel_y",		7,	"le:s16/16>>0"		},
+	{ "in_anglvel_z",		8,	"le:s16/16>>0"		},
+	{ "in_rot_yaw",			9,	"le:u16/16>>0"		},
+	{ "in_rot_roll",		10,	"le:s16/16>>0"		},
+	{ "in_rot_pitch",		11,	"le:s16/16>>0"		},
+	{ "in_rot_quaternion",	12,	"le:s16/16X4>>0"	},
+	{ "in_accel_linear_x",	13,	"le:s16/16>>0"		},
+	{ "in_accel_linear_y",	14,	"le:s16/16>>0"		},
+	{ "in_accel_linear_z",	15,	"le:s16/16>>0"		},
+	{ "in_gravity_x",		16,	"le:s16/16>>0"		},
+	{ "in_gravity_y",		17,	"le:s16/16>>0"		},
+	{ "in_gravity_z",		18,	"le:s16/16>>0"		},
+	{ "in_timestamp",		19,	"le:s64/64>>0"		}
+};
+
+static const int32_t NUMBER_OF_ELEMENTS = sizeof(fakeElements) / sizeof(fakeElements[0]);
+
+static const int32_t NUMBER_OF_SIXTEEN_BIT_VALUES = 22;		// 18 singles and 4 quaternion values.
+
+static const int32_t FAKE_SCAN_SIZE = 56;						// 44 bytes, aligned to 8, plus the timestamp.
+
+static const int32_t SCAN_TIMEOUT_MS = 50;
+
+static const useconds_t WRITER_STALL_US = 200000;
+
+static bool writeFile(const char *pRelativePath, const char *pValue)
+{
+	char achPath[FILENAME_MAX];
+
+	(void)snprintf(achPath, sizeof(achPath), "%s/%s", FAKE_SYSFS_PATH, pRelativePath);
+
+	FILE *pFile = fopen(achPath, "w");
+
+	if ( NULL == pFile )
+	{
+		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", achPath, strerror(errno));
+		return false;
+	}
+
+	(void)fprintf(pFile, "%s\n", pValue);
+	(void)fclose(pFile);
+
+	return true;
+}
+
+static bool makeFakeTree(void)
+{
+	(void)mkdir(FAKE_SYSFS_PATH, 0755);
+	(void)mkdir(FAKE_SYSFS_PATH "/scan_elements", 0755);
+	(void)mkdir(FAKE_SYSFS_PATH "/buffer", 0755);
+	(void)mkdir(FAKE_SYSFS_PATH "/trigger", 0755);
+
+	bool bSuccess = writeFile("name", "bno055") && writeFile("buffer/enable", "0") &&
+		writeFile("buffer/length", "0") && writeFile("trigger/current_trigger", "");
+
+	for ( int32_t i = 0 ; bSuccess && ( i < NUMBER_OF_ELEMENTS ) ; i++ )
+	{
+		char achPath[FILENAME_MAX], achIndex[16];
+
+		(void)snprintf(achIndex, sizeof(achIndex), "%i", fakeElements[i].iIndex);
+
+		(void)snprintf(achPath, sizeof(achPath), "scan_elements/%s_index", fakeElements[i].pName);
+		bSuccess = writeFile(achPath, achIndex);
+
+		(void)snprintf(achPath, sizeof(achPath), "scan_elements/%s_type", fakeElements[i].pName);
+		bSuccess = bSuccess && writeFile(achPath, fakeElements[i].pType);
+
+		(void)snprintf(achPath, sizeof(achPath), "scan_elements/%s_en", fakeElements[i].pName);
+		bSuccess = bSuccess && writeFile(achPath, "0");
+	}
+
+	(void)unlink(FAKE_DEVICE_PATH);
+
+	if ( bSuccess && ( 0 != mkfifo(FAKE_DEVICE_PATH, 0644) ) )
+	{
+		(void)printf("Unable to make \"%s!\"\n\t\"%s\"\n", FAKE_DEVICE_PATH, strerror(errno));
+		bSuccess = false;
+	}
+
+	return bSuccess;
+}
+
+// Sixteen bit value number j of scan n; negative values exercise the sign extension.
+static int16_t fakeValue(const int32_t n, const int32_t j)
+{
+	return (int16_t)( ( ( n * 100 ) + j ) * ( ( j & 1 ) ? -1 : 1 ) );
+}
+
+static int64_t fakeTimestamp(const int32_t n)
+{
+	return 1700000000000000000LL + ( (int64_t)n * 10000000LL );
+}
+
+static void writeScans(const int32_t nScans)
+{
+	int32_t iFd = open(FAKE_DEVICE_PATH, O_WRONLY);
+
+	if ( 0 > iFd )
+		_exit(1);
+
+	for ( int32_t n = 0 ; n < nScans ; n++ )
+	{
+		uint8_t auScan[FAKE_SCAN_SIZE];
+
+		(void)memset(auScan, 0, sizeof(auScan));
+
+		// The values are in index order and are all two bytes, so they're packed.
+		for ( int32_t j = 0 ; j < NUMBER_OF_SIXTEEN_BIT_VALUES ; j++ )
+		{
+			uint16_t u = (uint16_t)fakeValue(n, j);
+			auScan[2 * j] = (uint8_t)( u & 0xff );
+			auScan[( 2 * j ) + 1] = (uint8_t)( u >> 8 );
+		}
+
+		uint64_t uTimestamp = (uint64_t)fakeTimestamp(n);
+
+		for ( int32_t k = 0 ; k < 8 ; k++ )
+			auScan[48 + k] = (uint8_t)( uTimestamp >> ( 8 * k ) );
+
+		if ( ( nScans - 1 ) == n )
+			(void)usleep(WRITER_STALL_US);
+
+		// Odd-sized writes check that partial scans are put back together.
+		if ( ( FAKE_SCAN_SIZE / 2 ) != write(iFd, auScan, FAKE_SCAN_SIZE / 2) ||
+			( FAKE_SCAN_SIZE / 2 ) != write(iFd, &auScan[FAKE_SCAN_SIZE / 2], FAKE_SCAN_SIZE / 2) )
+			_exit(1);
+	}
+
+	(void)close(iFd);
+
+	_exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+	int32_t nScans = ( 1 < argc ) ? atoi(argv[1]) : 100;
+
+	if ( !makeFakeTree() )
+		return 1;
+
+	pid_t pid = fork();
+
+	if ( 0 > pid )
+	{
+		(void)printf("Unable to fork!\n\t\"%s\"\n", strerror(errno));
+		return 1;
+	}
+	else if ( 0 == pid )
+		writeScans(nScans);
+
+	else
+		;
+
+	IioBuffer buffer(FAKE_SYSFS_PATH, FAKE_DEVICE_PATH);
+
+	int32_t aiHandles[NUMBER_OF_ELEMENTS];
+
+	for ( int32_t i = 0 ; i < NUMBER_OF_ELEMENTS ; i++ )
+	{
+		aiHandles[i] = buffer.addChannel(fakeElements[i].pName);
+
+		if ( 0 > aiHandles[i] )
+		{
+			(void)kill(pid, SIGTERM);
+			return 1;
+		}
+	}
+
+	if ( !buffer.enable() )
+	{
+		(void)kill(pid, SIGTERM);
+		return 1;
+	}
+
+	(void)printf("The scan size is %u bytes.\n", buffer.getScanSize());
+
+	int32_t nGood = 0, nBad = 0, nTimeouts = 0;
+
+	for ( int32_t n = 0 ; n < nScans ; n++ )
+	{
+		bool bRead = buffer.readScan(SCAN_TIMEOUT_MS);
+
+		while ( !bRead && buffer.timedOut() )
+		{
+			nTimeouts++;
+			bRead = buffer.readScan(SCAN_TIMEOUT_MS);
+		}
+
+		if ( !bRead )
+			break;				// The writer went away.
+
+		bool bGood = ( fakeTimestamp(n) == buffer.getTimestamp() );
+
+		for ( int32_t i = 0, j = 0 ; i < ( NUMBER_OF_ELEMENTS - 1 ) ; i++ )
+		{
+			uint32_t uRepeat = ( 12 == fakeElements[i].iIndex ) ? 4 : 1;
+
+			for ( uint32_t k = 0 ; k < uRepeat ; k++, j++ )
+			{
+				int64_t iExpected = fakeValue(n, j);
+
+				// The yaw (heading) is unsigned.
+				if ( 9 == fakeElements[i].iIndex )
+					iExpected = (uint16_t)iExpected;
+
+				if ( iExpected != buffer.getValue(aiHandles[i], k) )
+				{
+					(void)printf("Scan %i, %s[%u]: expected %" PRId64 ", decoded %" PRId64 ".\n",
+						n, fakeElements[i].pName, k, iExpected, buffer.getValue(aiHandles[i], k));
+					bGood = false;
+				}
+			}
+		}
+
+		if ( bGood )
+			nGood++;
+		else
+			nBad++;
+	}
+
+	int iStatus = 0;
+	(void)waitpid(pid, &iStatus, 0);
+
+	buffer.disable();
+
+	(void)printf("Decoded %i scans; %i matched and %i did not. Timed out %i times.\n", nGood + nBad, nGood, nBad, nTimeouts);
+
+	return ( ( nScans == nGood ) && ( 0 == nBad ) && ( 0 < nTimeouts ) ) ? 0 : 1;
+}
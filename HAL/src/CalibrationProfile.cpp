@@ -0,0 +1,191 @@
+/*
+	CalibrationProfile.cpp - Small versioned binary calibration files for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "CalibrationProfile.h"
+
+const bool CalibrationProfile::bDebug = false;
+
+uint32_t CalibrationProfile::checksum(const void *pData, const uint32_t uSize)
+{
+	const uint8_t *p = (const uint8_t *)pData;
+
+	uint32_t uHash = 2166136261u;
+
+	for ( uint32_t i = 0 ; i < uSize ; i++ )
+	{
+		uHash ^= p[i];
+		uHash *= 16777619u;
+	}
+
+	return uHash;
+}
+
+static bool writeAll(const int32_t iFd, const void *pData, const uint32_t uSize)
+{
+	const uint8_t *p = (const uint8_t *)pData;
+
+	uint32_t uWritten = 0;
+
+	while ( uWritten < uSize )
+	{
+		ssize_t iRet = write(iFd, &p[uWritten], uSize - uWritten);
+
+		if ( ( 0 > iRet ) && ( EINTR == errno ) )
+			continue;
+
+		else if ( 0 >= iRet )
+			return false;
+
+		else
+			uWritten += (uint32_t)iRet;
+	}
+
+	return true;
+}
+
+static bool readAll(const int32_t iFd, void *pData, const uint32_t uSize)
+{
+	uint8_t *p = (uint8_t *)pData;
+
+	uint32_t uRead = 0;
+
+	while ( uRead < uSize )
+	{
+		ssize_t iRet = read(iFd, &p[uRead], uSize - uRead);
+
+		if ( ( 0 > iRet ) && ( EINTR == errno ) )
+			continue;
+
+		else if ( 0 >= iRet )
+			return false;
+
+		else
+			uRead += (uint32_t)iRet;
+	}
+
+	return true;
+}
+
+bool CalibrationProfile::save(const char *pPath, const uint32_t uMagic, const uint32_t uVersion,
+	const void *pPayload, const uint32_t uPayloadSize)
+{
+	if ( ( NULL == pPath ) || ( NULL == pPayload ) )
+		return false;
+
+	char achTemporaryPath[FILENAME_MAX];
+
+	(void)snprintf(achTemporaryPath, sizeof(achTemporaryPath), "%s.tmp", pPath);
+
+	int32_t iFd = open(achTemporaryPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+	if ( 0 > iFd )
+	{
+		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", achTemporaryPath, strerror(errno));
+		return false;
+	}
+
+	CalibrationProfileHeader header;
+
+	header.uMagic = uMagic, header.uVersion = uVersion, header.uPayloadSize = uPayloadSize;
+	header.uChecksum = checksum(pPayload, uPayloadSize);
+
+	bool bSuccess = writeAll(iFd, &header, sizeof(header)) && writeAll(iFd, pPayload, uPayloadSize) &&
+		( 0 == fsync(iFd) );
+
+	if ( !bSuccess )
+		(void)printf("Unable to write \"%s!\"\n\t\"%s\"\n", achTemporaryPath, strerror(errno));
+
+	(void)close(iFd);
+
+	if ( bSuccess && ( 0 != rename(achTemporaryPath, pPath) ) )
+	{
+		(void)printf("Unable to rename \"%s\" to \"%s!\"\n\t\"%s\"\n", achTemporaryPath, pPath, strerror(errno));
+		bSuccess = false;
+	}
+
+	if ( !bSuccess )
+		(void)unlink(achTemporaryPath);
+
+	else if ( bDebug )
+		(void)printf("Saved the calibration profile \"%s.\"\n", pPath);
+
+	else
+		;
+
+	return bSuccess;
+}
+
+bool CalibrationProfile::load(const char *pPath, const uint32_t uMagic, const uint32_t uVersion,
+	void *pPayload, const uint32_t uPayloadSize)
+{
+	if ( ( NULL == pPath ) || ( NULL == pPayload ) )
+		return false;
+
+	int32_t iFd = open(pPath, O_RDONLY | O_CLOEXEC);
+
+	if ( 0 > iFd )
+	{
+		// No profile yet is the normal first boot.
+		if ( ENOENT != errno )
+			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pPath, strerror(errno));
+		return false;
+	}
+
+	CalibrationProfileHeader header;
+
+	bool bSuccess = readAll(iFd, &header, sizeof(header));
+
+	if ( !bSuccess || ( uMagic != header.uMagic ) || ( uVersion != header.uVersion ) || ( uPayloadSize != header.uPayloadSize ) )
+	{
+		if ( bDebug )
+			(void)printf("\"%s\" is not a version %u profile for this sensor.\n", pPath, uVersion);
+
+		(void)close(iFd);
+		return false;
+	}
+
+	// Read into a scratch copy so a bad file doesn't clobber the caller's values.
+	uint8_t *pScratch = (uint8_t *)malloc(uPayloadSize);
+
+	uint8_t uExtra = 0;
+
+	bSuccess = ( NULL != pScratch ) && readAll(iFd, pScratch, uPayloadSize) &&
+		( header.uChecksum == checksum(pScratch, uPayloadSize) ) && !readAll(iFd, &uExtra, 1);
+
+	(void)close(iFd);
+
+	if ( bSuccess )
+		(void)memcpy(pPayload, pScratch, uPayloadSize);
+
+	else
+		(void)printf("The calibration profile \"%s\" is corrupt; ignoring it.\n", pPath);
+
+	free(pScratch);
+
+	return bSuccess;
+}
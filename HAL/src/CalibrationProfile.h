@@ -0,0 +1,65 @@
+/*
+	CalibrationProfile.h - Small versioned binary calibration files for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	A sensor saves its offsets, scale factors, and baselines after a calibration, and loads
+	them at the next startup instead of calibrating again. The file is a fixed header (magic,
+	version, payload size, checksum) and the sensor's own plain struct. Anything that doesn't
+	match exactly is refused, so a changed struct or a torn file just means recalibrating.
+
+	The file is written to a temporary name and renamed, so a power loss mid-save leaves the
+	old profile intact.
+
+*/
+
+#ifndef _CALIBRATION_PROFILE_H
+#define _CALIBRATION_PROFILE_H
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#define CALIBRATION_PROFILE_VERSION	1     	// software version of this library
+
+// On disk, followed by the payload.
+typedef struct sCalibrationProfileHeader
+{
+	uint32_t uMagic;						// Identifies the sensor.
+	uint32_t uVersion;						// The sensor's payload layout.
+	uint32_t uPayloadSize;
+	uint32_t uChecksum;						// Of the payload.
+} CalibrationProfileHeader;
+
+class CalibrationProfile
+{
+public:
+	// Returns false, with the reason printed, if the file can't be written.
+	static bool save(const char *pPath, const uint32_t uMagic, const uint32_t uVersion,
+		const void *pPayload, const uint32_t uPayloadSize);
+
+	// Returns false, leaving the payload alone, if there's no file or it doesn't match.
+	static bool load(const char *pPath, const uint32_t uMagic, const uint32_t uVersion,
+		void *pPayload, const uint32_t uPayloadSize);
+
+	// 32-bit FNV-1a.
+	static uint32_t checksum(const void *pData, const uint32_t uSize);
+
+private:
+	static const bool bDebug;
+};
+
+#endif	// _CALIBRATION_PROFILE_H
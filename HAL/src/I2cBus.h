@@ -0,0 +1,67 @@
+/*
+	I2cBus.h - Abstract I2C bus for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	A sensor driver talks to its registers through an I2cBus, so the same driver runs on
+	"/dev/i2c-N" (LinuxI2cBus) or against a register map in memory (MockI2cBus).
+
+*/
+
+#ifndef _I2C_BUS_H
+#define _I2C_BUS_H
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#define I2C_BUS_VERSION	1     				// software version of this library
+
+class I2cBus
+{
+public:
+	virtual ~I2cBus()
+	{
+	}
+
+	// Writes pWrite, then, after a repeated start, reads into pRead; one transaction.
+	//	Either length can be zero.
+	virtual bool transfer(const uint8_t uAddress, const uint8_t *pWrite, const uint32_t nWrite,
+		uint8_t *pRead, const uint32_t nRead) = 0;
+
+	// A burst read of consecutive registers; the device increments the register address.
+	inline bool readRegisters(const uint8_t uAddress, const uint8_t uRegister, uint8_t *pValues, const uint32_t nValues)
+	{
+		return transfer(uAddress, &uRegister, 1, pValues, nValues);
+	}
+
+	inline bool readRegister(const uint8_t uAddress, const uint8_t uRegister, uint8_t &uValue)
+	{
+		return readRegisters(uAddress, uRegister, &uValue, 1);
+	}
+
+	inline bool writeRegister(const uint8_t uAddress, const uint8_t uRegister, const uint8_t uValue)
+	{
+		const uint8_t auWrite[2] =
+		{
+			uRegister, uValue
+		};
+
+		return transfer(uAddress, auWrite, sizeof(auWrite), NULL, 0);
+	}
+};
+
+#endif	// _I2C_BUS_H
@@ -0,0 +1,420 @@
+/*
+	IioBuffer.cpp - Industrial I/O triggered-buffer reader for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+
+#include "IioBuffer.h"
+#include "SysfsAttribute.h"
+
+const bool IioBuffer::bDebug = false;
+
+const int32_t IioBuffer::MAX_CHANNELS;
+const uint32_t IioBuffer::DEFAULT_BUFFER_LENGTH;
+const uint32_t IioBuffer::SCANS_PER_READ;
+const uint32_t IioBuffer::MAX_SCAN_SIZE;
+
+IioBuffer::IioBuffer(const char *pSysfsPath, const char *pDevicePath) :
+	nChannels(0), iTimestampChannel(-1), uScanSize(0), iFd(-1),
+	uBytesBuffered(0), uScanOffset(0), bHaveScan(false), bTimedOut(false)
+{
+	(void)memset(achSysfsPath, '\0', sizeof(achSysfsPath));
+	(void)memset(achDevicePath, '\0', sizeof(achDevicePath));
+	(void)memset(channels, 0, sizeof(channels));
+
+	if ( NULL != pSysfsPath )
+		(void)strncpy(achSysfsPath, pSysfsPath, sizeof(achSysfsPath) - 1);
+
+	if ( NULL != pDevicePath )
+		(void)strncpy(achDevicePath, pDevicePath, sizeof(achDevicePath) - 1);
+}
+
+IioBuffer::~IioBuffer()
+{
+	disable();
+}
+
+bool IioBuffer::writeSysfs(const char *pRelativePath, const char *pValue)
+{
+	char achPath[FILENAME_MAX];
+
+	(void)snprintf(achPath, sizeof(achPath), "%s/%s", achSysfsPath, pRelativePath);
+
+	SysfsAttribute attribute(achPath, O_WRONLY);
+
+	if ( !attribute.isOpen() )
+		return false;			// Already reported.
+
+	return attribute.writeString(pValue);
+}
+
+bool IioBuffer::parseType(const char *pType, IioChannel &channel)
+{
+	// E.g., "le:s16/16X4>>0"; the "X4" repeat is optional.
+	char chEndian = '\0', chSign = '\0';
+	uint32_t uBits = 0, uStorageBits = 0, uShift = 0, uRepeat = 1;
+
+	if ( 6 == sscanf(pType, "%ce:%c%u/%uX%u>>%u", &chEndian, &chSign, &uBits, &uStorageBits, &uRepeat, &uShift) )
+		;
+
+	else if ( 5 == sscanf(pType, "%ce:%c%u/%u>>%u", &chEndian, &chSign, &uBits, &uStorageBits, &uShift) )
+		uRepeat = 1;
+
+	else
+		return false;
+
+	if ( ( ( 'l' != chEndian ) && ( 'b' != chEndian ) ) ||
+		( ( 's' != chSign ) && ( 'u' != chSign ) && ( 'S' != chSign ) && ( 'U' != chSign ) ) )
+		return false;
+
+	if ( ( 0 == uStorageBits ) || ( 64 < uStorageBits ) || ( 0 != ( uStorageBits % 8 ) ) ||
+		( 0 == uBits ) || ( uStorageBits < uBits ) || ( 0 == uRepeat ) )
+		return false;
+
+	channel.bBigEndian = ( 'b' == chEndian );
+	channel.bSigned = ( ( 's' == chSign ) || ( 'S' == chSign ) );
+	channel.uBits = uBits;
+	channel.uStorageBits = uStorageBits;
+	channel.uShift = uShift;
+	channel.uRepeat = uRepeat;
+
+	return true;
+}
+
+int32_t IioBuffer::addChannel(const char *pName)
+{
+	if ( ( NULL == pName ) || ( MAX_CHANNELS <= nChannels ) || isEnabled() )
+		return -1;
+
+	IioChannel &channel = channels[nChannels];
+
+	(void)memset(&channel, 0, sizeof(channel));
+	(void)strncpy(channel.achName, pName, sizeof(channel.achName) - 1);
+
+	char achPath[FILENAME_MAX];
+	char achType[SysfsAttribute::ATTRIBUTE_BUFFER_SIZE];
+
+	(void)snprintf(achPath, sizeof(achPath), "%s/scan_elements/%s_type", achSysfsPath, pName);
+
+	SysfsAttribute typeAttribute(achPath);
+
+	if ( !typeAttribute.isOpen() || !typeAttribute.readString(achType, sizeof(achType)) )
+		return -1;				// Already reported.
+
+	if ( !parseType(achType, channel) )
+	{
+		(void)printf("Unable to parse the scan type \"%s\" from \"%s!\"\n", achType, achPath);
+		return -1;
+	}
+
+	(void)snprintf(achPath, sizeof(achPath), "%s/scan_elements/%s_index", achSysfsPath, pName);
+
+	SysfsAttribute indexAttribute(achPath);
+
+	if ( !indexAttribute.isOpen() || !indexAttribute.readInteger(channel.iIndex) )
+		return -1;
+
+	(void)snprintf(achPath, sizeof(achPath), "scan_elements/%s_en", pName);
+
+	if ( !writeSysfs(achPath, "1") )
+		return -1;
+
+	if ( 0 == strcmp(pName, "in_timestamp") )
+		iTimestampChannel = nChannels;
+
+	if ( bDebug )
+		(void)printf("Channel \"%s\" is index %i, type \"%s.\"\n", pName, channel.iIndex, achType);
+
+	return nChannels++;
+}
+
+bool IioBuffer::setTrigger(const char *pTriggerName)
+{
+	if ( NULL == pTriggerName )
+		return false;
+
+	return writeSysfs("trigger/current_trigger", pTriggerName);
+}
+
+bool IioBuffer::setTimestampClock(const char *pClockName)
+{
+	if ( NULL == pClockName )
+		return false;
+
+	return writeSysfs("current_timestamp_clock", pClockName);
+}
+
+uint32_t IioBuffer::computeLayout(IioChannel *pChannels, const int32_t nChannels)
+{
+	int32_t aiOrder[MAX_CHANNELS];
+
+	// Insertion sort by scan index; there are only a handful of channels.
+	for ( int32_t i = 0 ; ( i < nChannels ) && ( i < MAX_CHANNELS ) ; i++ )
+	{
+		int32_t j = i;
+
+		while ( ( 0 < j ) && ( pChannels[aiOrder[j - 1]].iIndex > pChannels[i].iIndex ) )
+		{
+			aiOrder[j] = aiOrder[j - 1];
+			j--;
+		}
+		aiOrder[j] = i;
+	}
+
+	uint32_t uBytes = 0, uLargest = 1;
+
+	// Like the kernel's iio_compute_scan_bytes(): each element is aligned to its own size.
+	for ( int32_t i = 0 ; ( i < nChannels ) && ( i < MAX_CHANNELS ) ; i++ )
+	{
+		IioChannel &channel = pChannels[aiOrder[i]];
+
+		uint32_t uLength = ( channel.uStorageBits / 8 ) * channel.uRepeat;
+
+		if ( uBytes % uLength )
+			uBytes += uLength - ( uBytes % uLength );
+
+		channel.uOffset = uBytes;
+		uBytes += uLength;
+
+		if ( uLength > uLargest )
+			uLargest = uLength;
+	}
+
+	if ( uBytes % uLargest )
+		uBytes += uLargest - ( uBytes % uLargest );
+
+	return uBytes;
+}
+
+bool IioBuffer::enable(const uint32_t uLength /*= DEFAULT_BUFFER_LENGTH*/)
+{
+	if ( isEnabled() )
+		return true;
+
+	if ( 0 == nChannels )
+		return false;
+
+	uScanSize = computeLayout(channels, nChannels);
+
+	if ( ( 0 == uScanSize ) || ( MAX_SCAN_SIZE < uScanSize ) )
+	{
+		(void)printf("The %u byte scan from \"%s\" is not supported!\n", uScanSize, achSysfsPath);
+		return false;
+	}
+
+	char achLength[16];
+
+	(void)snprintf(achLength, sizeof(achLength), "%u", uLength);
+
+	// The length can only be changed while the buffer is disabled.
+	(void)writeSysfs("buffer/enable", "0");
+
+	if ( !writeSysfs("buffer/length", achLength) || !writeSysfs("buffer/enable", "1") )
+		return false;
+
+	iFd = ::open(achDevicePath, O_RDONLY | O_CLOEXEC);
+
+	if ( 0 > iFd )
+	{
+		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", achDevicePath, strerror(errno));
+		(void)writeSysfs("buffer/enable", "0");
+		return false;
+	}
+
+	uBytesBuffered = 0, uScanOffset = 0, bHaveScan = false;
+
+	if ( bDebug )
+		(void)printf("Streaming %u byte scans from \"%s.\"\n", uScanSize, achDevicePath);
+
+	return true;
+}
+
+void IioBuffer::disable(void)
+{
+	if ( !isEnabled() )
+		return;
+
+	(void)::close(iFd);
+	iFd = -1;
+
+	(void)writeSysfs("buffer/enable", "0");
+
+	uBytesBuffered = 0, uScanOffset = 0, bHaveScan = false;
+}
+
+int32_t IioBuffer::waitForData(const int32_t iTimeoutMs)
+{
+	struct pollfd sPoll;
+
+	sPoll.fd = iFd, sPoll.events = POLLIN, sPoll.revents = 0;
+
+	struct timespec start, now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &start);
+
+	int32_t iRemainingMs = iTimeoutMs;
+
+	while ( true )
+	{
+		int32_t iReady = poll(&sPoll, 1, iRemainingMs);
+
+		if ( 0 <= iReady )
+			return iReady;
+
+		else if ( EINTR != errno )
+		{
+			(void)printf("Unable to poll \"%s!\"\n\t\"%s\"\n", achDevicePath, strerror(errno));
+			return -1;
+		}
+
+		else if ( 0 > iTimeoutMs )
+			continue;
+
+		else
+			;
+
+		// Interrupted; wait only for what's left of the timeout.
+		(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+		int64_t iElapsedMs = ( (int64_t)( now.tv_sec - start.tv_sec ) * 1000 ) + ( ( now.tv_nsec - start.tv_nsec ) / 1000000 );
+
+		if ( iElapsedMs >= iTimeoutMs )
+			return 0;
+
+		iRemainingMs = iTimeoutMs - (int32_t)iElapsedMs;
+	}
+}
+
+bool IioBuffer::waitForScan(const int32_t iTimeoutMs)
+{
+	bTimedOut = false;
+
+	if ( !isEnabled() )
+		return false;
+
+	const uint32_t uNext = bHaveScan ? ( uScanOffset + uScanSize ) : uScanOffset;
+
+	if ( ( uBytesBuffered - uNext ) >= uScanSize )
+		return true;
+
+	int32_t iReady = waitForData(iTimeoutMs);
+
+	bTimedOut = ( 0 == iReady );
+
+	return 0 < iReady;
+}
+
+bool IioBuffer::readScan(const int32_t iTimeoutMs /*= -1*/)
+{
+	bTimedOut = false;
+
+	if ( !isEnabled() )
+		return false;
+
+	uint32_t uNext = bHaveScan ? ( uScanOffset + uScanSize ) : uScanOffset;
+
+	while ( ( uBytesBuffered - uNext ) < uScanSize )
+	{
+		// Wait for the trigger; on a timeout the current scan stays valid.
+		int32_t iReady = waitForData(iTimeoutMs);
+
+		if ( 0 >= iReady )
+		{
+			bTimedOut = ( 0 == iReady );
+			return false;
+		}
+
+		// Slide the current scan, and any partial one after it (only a FIFO
+		// leaves those), to the front and refill behind them; the current scan
+		// stays valid should the read fail.
+		if ( uScanOffset )
+		{
+			uBytesBuffered -= uScanOffset;
+
+			if ( uBytesBuffered )
+				(void)memmove(auReadBuffer, &auReadBuffer[uScanOffset], uBytesBuffered);
+
+			uNext -= uScanOffset, uScanOffset = 0;
+		}
+
+		ssize_t nRead = read(iFd, &auReadBuffer[uBytesBuffered], ( SCANS_PER_READ * uScanSize ) - uBytesBuffered);
+
+		if ( ( 0 > nRead ) && ( ( EINTR == errno ) || ( EAGAIN == errno ) ) )
+			continue;
+
+		else if ( 0 > nRead )
+		{
+			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", achDevicePath, strerror(errno));
+			return false;
+		}
+
+		else if ( 0 == nRead )
+			return false;		// The writer went away.
+
+		else
+			uBytesBuffered += (uint32_t)nRead;
+	}
+
+	uScanOffset = uNext;
+	bHaveScan = true;
+
+	return true;
+}
+
+int64_t IioBuffer::getValue(const int32_t iChannel, const uint32_t uElement /*= 0*/)
+{
+	if ( !bHaveScan || ( 0 > iChannel ) || ( nChannels <= iChannel ) )
+		return 0;
+
+	const IioChannel &channel = channels[iChannel];
+
+	if ( uElement >= channel.uRepeat )
+		return 0;
+
+	const uint32_t uStorageBytes = channel.uStorageBits / 8;
+	const uint8_t *p = &auReadBuffer[uScanOffset + channel.uOffset + ( uElement * uStorageBytes )];
+
+	uint64_t u = 0;
+
+	for ( uint32_t i = 0 ; i < uStorageBytes ; i++ )
+	{
+		if ( channel.bBigEndian )
+			u = ( u << 8 ) | p[i];
+		else
+			u |= (uint64_t)p[i] << ( 8 * i );
+	}
+
+	u >>= channel.uShift;
+
+	if ( 64 > channel.uBits )
+	{
+		u &= ( (uint64_t)1 << channel.uBits ) - 1;
+
+		if ( channel.bSigned && ( u & ( (uint64_t)1 << ( channel.uBits - 1 ) ) ) )
+			u |= ~( ( (uint64_t)1 << channel.uBits ) - 1 );
+	}
+
+	return (int64_t)u;
+}
@@ -0,0 +1,151 @@
+/*
+	IioBuffer.h - Industrial I/O triggered-buffer reader for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	Instead of reading every "in_*_raw" file, the IIO core can capture all of the enabled
+	channels at the same trigger instant and hand them out as one packed binary scan from
+	"/dev/iio:deviceN." The layout comes from the device's "scan_elements" directory:
+		in_anglvel_x_en		- write 1 to include the channel in the scan.
+		in_anglvel_x_index	- its position; scans are ordered by index.
+		in_anglvel_x_type	- e.g., "le:s16/16>>0" or "le:s16/16X4>>0" for the quaternion.
+	The trigger (e.g., an hrtimer trigger made under "/sys/kernel/config/iio/triggers/hrtimer/")
+	is named in "trigger/current_trigger."
+
+	Both paths are parameters, so a directory of ordinary files and a FIFO work as a stand-in
+	for the driver; see "examples/FakeIioDevice.cpp."
+
+*/
+
+#ifndef _IIO_BUFFER_H
+#define _IIO_BUFFER_H
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#define IIO_BUFFER_VERSION	1     			// software version of this library
+
+typedef struct sIioChannel
+{
+	char achName[64];						// e.g., "in_anglvel_x" or "in_timestamp."
+	int32_t iIndex;							// From "_index."
+	bool bSigned;
+	bool bBigEndian;
+	uint32_t uBits;							// Valid bits.
+	uint32_t uStorageBits;					// Bits used to store each value.
+	uint32_t uShift;
+	uint32_t uRepeat;						// E.g., 4 for a quaternion.
+	uint32_t uOffset;						// Byte offset in the scan; set by enable().
+} IioChannel;
+
+class IioBuffer
+{
+public:
+	IioBuffer(const char *pSysfsPath, const char *pDevicePath);
+	~IioBuffer();
+
+	// Add (and enable) a scan element before calling enable(); returns its handle or -1.
+	int32_t addChannel(const char *pName);
+
+	bool setTrigger(const char *pTriggerName);
+
+	// The clock for the scan timestamps, e.g., "monotonic"; the IIO core defaults to
+	//	"realtime," which jumps when NTP or the GPS sets the time. Call it before enable().
+	bool setTimestampClock(const char *pClockName);
+
+	// Computes the scan layout, sets the buffer length, enables the buffer, and opens the device.
+	bool enable(const uint32_t uLength = DEFAULT_BUFFER_LENGTH);
+	void disable(void);
+
+	inline bool isEnabled(void)
+	{
+		return 0 <= iFd;
+	}
+
+	// Waits for the next complete scan; one read() can return several. A negative timeout
+	//	waits forever. Returns false on a timeout (see timedOut()), and the current scan stays.
+	bool readScan(const int32_t iTimeoutMs = -1);
+
+	// Waits, without consuming anything, until a scan is ready to read.
+	bool waitForScan(const int32_t iTimeoutMs);
+
+	inline bool timedOut(void)
+	{
+		return bTimedOut;
+	}
+
+	// The value of a channel in the current scan; uElement selects a repeated value.
+	int64_t getValue(const int32_t iChannel, const uint32_t uElement = 0);
+
+	// The kernel timestamp of the current scan in nanoseconds, or 0 without one.
+	inline int64_t getTimestamp(void)
+	{
+		return ( 0 <= iTimestampChannel ) ? getValue(iTimestampChannel) : 0;
+	}
+
+	inline uint32_t getScanSize(void)
+	{
+		return uScanSize;
+	}
+
+	inline int32_t getFd(void)
+	{
+		return iFd;
+	}
+
+	// Parses a "_type" string like "le:s16/16X4>>0."
+	static bool parseType(const char *pType, IioChannel &channel);
+
+	// Places the channels the way the IIO core does; returns the scan size in bytes.
+	static uint32_t computeLayout(IioChannel *pChannels, const int32_t nChannels);
+
+	static const int32_t MAX_CHANNELS = 32;
+	static const uint32_t DEFAULT_BUFFER_LENGTH = 16;	// Scans held by the kernel.
+	static const uint32_t SCANS_PER_READ = 8;
+	static const uint32_t MAX_SCAN_SIZE = 256;
+
+private:
+	static const size_t PATH_SIZE = 256;
+
+	char achSysfsPath[PATH_SIZE];
+	char achDevicePath[PATH_SIZE];
+
+	IioChannel channels[MAX_CHANNELS];
+	int32_t nChannels;
+	int32_t iTimestampChannel;
+
+	uint32_t uScanSize;
+
+	int32_t iFd;
+
+	// Scans are read in bunches; these track the unconsumed bytes.
+	uint8_t auReadBuffer[SCANS_PER_READ * MAX_SCAN_SIZE];
+	uint32_t uBytesBuffered;
+	uint32_t uScanOffset;
+	bool bHaveScan;
+
+	bool bTimedOut;
+
+	static const bool bDebug;
+
+	// poll() for the device to become readable: 1 when it is, 0 on a timeout, and -1 on an error.
+	int32_t waitForData(const int32_t iTimeoutMs);
+
+	bool writeSysfs(const char *pRelativePath, const char *pValue);
+};
+
+#endif	// _IIO_BUFFER_H
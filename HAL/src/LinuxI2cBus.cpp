@@ -0,0 +1,130 @@
+/*
+	LinuxI2cBus.cpp - I2C through the Linux i2c-dev interface for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "LinuxI2cBus.h"
+
+const bool LinuxI2cBus::bDebug = false;
+
+LinuxI2cBus::LinuxI2cBus(const char *pDevicePath /*= I2C_DEFAULT_DEVICE_PATH*/) :
+	iFd(-1)
+{
+	(void)memset(achPath, '\0', sizeof(achPath));
+
+	if ( NULL != pDevicePath )
+		(void)open(pDevicePath);
+}
+
+LinuxI2cBus::~LinuxI2cBus()
+{
+	close();
+}
+
+bool LinuxI2cBus::open(const char *pDevicePath)
+{
+	close();
+
+	if ( NULL == pDevicePath )
+		return false;
+
+	(void)strncpy(achPath, pDevicePath, sizeof(achPath) - 1);
+
+	iFd = ::open(achPath, O_RDWR | O_CLOEXEC);
+
+	if ( 0 > iFd )
+	{
+		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", achPath, strerror(errno));
+		return false;
+	}
+
+	unsigned long uFunctions = 0;
+
+	if ( ( 0 != ioctl(iFd, I2C_FUNCS, &uFunctions) ) || !( uFunctions & I2C_FUNC_I2C ) )
+	{
+		(void)printf("\"%s\" doesn't support combined (I2C_RDWR) transfers!\n", achPath);
+		close();
+		return false;
+	}
+	else if ( bDebug )
+		(void)printf("Opened \"%s.\"\n", achPath);
+	else
+		;
+
+	return true;
+}
+
+void LinuxI2cBus::close(void)
+{
+	if ( 0 <= iFd )
+		(void)::close(iFd);
+	iFd = -1;
+}
+
+bool LinuxI2cBus::transfer(const uint8_t uAddress, const uint8_t *pWrite, const uint32_t nWrite,
+	uint8_t *pRead, const uint32_t nRead)
+{
+	if ( !isOpen() )
+		return false;			// Reported when opened.
+
+	struct i2c_msg asMessages[2];
+	struct i2c_rdwr_ioctl_data sTransfer;
+
+	sTransfer.msgs = asMessages, sTransfer.nmsgs = 0;
+
+	if ( 0 < nWrite )
+	{
+		asMessages[sTransfer.nmsgs].addr = uAddress;
+		asMessages[sTransfer.nmsgs].flags = 0;
+		asMessages[sTransfer.nmsgs].len = (uint16_t)nWrite;
+		asMessages[sTransfer.nmsgs].buf = (uint8_t *)pWrite;
+		sTransfer.nmsgs++;
+	}
+
+	if ( 0 < nRead )
+	{
+		asMessages[sTransfer.nmsgs].addr = uAddress;
+		asMessages[sTransfer.nmsgs].flags = I2C_M_RD;
+		asMessages[sTransfer.nmsgs].len = (uint16_t)nRead;
+		asMessages[sTransfer.nmsgs].buf = pRead;
+		sTransfer.nmsgs++;
+	}
+
+	if ( 0 == sTransfer.nmsgs )
+		return true;
+
+	if ( 0 > ioctl(iFd, I2C_RDWR, &sTransfer) )
+	{
+		if ( bDebug )
+			(void)printf("I2C transfer to 0x%02x on \"%s\" failed!\n\t\"%s\"\n", uAddress, achPath, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,59 @@
+/*
+	LinuxI2cBus.h - I2C through the Linux i2c-dev interface for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	Each transfer is one I2C_RDWR ioctl, so a register write and the burst read that follows
+	go out with a repeated start and no other master can get in between.
+
+*/
+
+#ifndef _LINUX_I2C_BUS_H
+#define _LINUX_I2C_BUS_H
+
+#include "I2cBus.h"
+
+#define LINUX_I2C_BUS_VERSION	1     		// software version of this library
+
+#define I2C_DEFAULT_DEVICE_PATH	"/dev/i2c-1"	// The Raspberry PI's header pins 3 and 5.
+
+class LinuxI2cBus : public I2cBus
+{
+public:
+	LinuxI2cBus(const char *pDevicePath = I2C_DEFAULT_DEVICE_PATH);
+	virtual ~LinuxI2cBus();
+
+	bool open(const char *pDevicePath);
+	void close(void);
+
+	inline bool isOpen(void)
+	{
+		return 0 <= iFd;
+	}
+
+	virtual bool transfer(const uint8_t uAddress, const uint8_t *pWrite, const uint32_t nWrite,
+		uint8_t *pRead, const uint32_t nRead);
+
+private:
+	int32_t iFd;
+
+	char achPath[FILENAME_MAX];
+
+	static const bool bDebug;
+};
+
+#endif	// _LINUX_I2C_BUS_H
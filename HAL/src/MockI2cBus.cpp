@@ -0,0 +1,69 @@
+/*
+	MockI2cBus.cpp - In-memory I2C bus for exercising drivers without hardware; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MockI2cBus.h"
+
+MockI2cBus::MockI2cBus(const uint8_t uAddress) :
+	uDeviceAddress(uAddress), uTransfers(0), uReads(0), uWrites(0), bFailing(false)
+{
+	(void)memset(auRegisters, 0, sizeof(auRegisters));
+}
+
+MockI2cBus::~MockI2cBus()
+{
+}
+
+void MockI2cBus::setRegisters(const uint8_t uRegister, const uint8_t *pValues, const uint32_t nValues)
+{
+	for ( uint32_t i = 0 ; i < nValues ; i++ )
+		auRegisters[( uRegister + i ) % NUMBER_OF_REGISTERS] = pValues[i];
+}
+
+bool MockI2cBus::transfer(const uint8_t uAddress, const uint8_t *pWrite, const uint32_t nWrite,
+	uint8_t *pRead, const uint32_t nRead)
+{
+	uTransfers++;
+
+	if ( bFailing || ( uDeviceAddress != uAddress ) )
+		return false;
+
+	// The first byte written selects the register; the rest are written from there.
+	uint32_t uRegister = ( 0 < nWrite ) ? pWrite[0] : 0;
+
+	if ( 1 < nWrite )
+	{
+		setRegisters((uint8_t)uRegister, &pWrite[1], nWrite - 1);
+		uRegister += nWrite - 1;
+		uWrites++;
+	}
+
+	for ( uint32_t i = 0 ; i < nRead ; i++ )
+		pRead[i] = auRegisters[( uRegister + i ) % NUMBER_OF_REGISTERS];
+
+	if ( 0 < nRead )
+		uReads++;
+
+	return true;
+}
@@ -0,0 +1,83 @@
+/*
+	MockI2cBus.h - In-memory I2C bus for exercising drivers without hardware; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	One device's 256 registers in memory. Reads and writes auto-increment the register
+	address like most sensors do; the counters and the failure switch let an example check
+	how many transactions a driver used and how it copes with a dead bus.
+
+*/
+
+#ifndef _MOCK_I2C_BUS_H
+#define _MOCK_I2C_BUS_H
+
+#include "I2cBus.h"
+
+#define MOCK_I2C_BUS_VERSION	1     		// software version of this library
+
+class MockI2cBus : public I2cBus
+{
+public:
+	MockI2cBus(const uint8_t uAddress);
+	virtual ~MockI2cBus();
+
+	virtual bool transfer(const uint8_t uAddress, const uint8_t *pWrite, const uint32_t nWrite,
+		uint8_t *pRead, const uint32_t nRead);
+
+	// Sets the registers the driver will read, e.g., a sensor's data block.
+	void setRegisters(const uint8_t uRegister, const uint8_t *pValues, const uint32_t nValues);
+
+	inline uint8_t getRegister(const uint8_t uRegister)
+	{
+		return auRegisters[uRegister];
+	}
+
+	inline uint32_t getTransfers(void)
+	{
+		return uTransfers;
+	}
+
+	inline uint32_t getReads(void)
+	{
+		return uReads;
+	}
+
+	inline uint32_t getWrites(void)
+	{
+		return uWrites;
+	}
+
+	// While set, every transfer fails as if the device didn't acknowledge.
+	inline void setFailing(const bool bFail)
+	{
+		bFailing = bFail;
+	}
+
+	static const uint32_t NUMBER_OF_REGISTERS = 256;
+
+private:
+	uint8_t uDeviceAddress;
+
+	uint8_t auRegisters[NUMBER_OF_REGISTERS];
+
+	uint32_t uTransfers, uReads, uWrites;
+
+	bool bFailing;
+};
+
+#endif	// _MOCK_I2C_BUS_H
@@ -0,0 +1,375 @@
+/*
+	SysfsAttribute.cpp - Persistent-handle sysfs attribute class for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "SysfsAttribute.h"
+
+const bool SysfsAttribute::bDebug = false;
+
+SysfsAttribute::SysfsAttribute(const char *pPath /*= NULL*/, const int32_t iFlags /*= O_RDONLY*/) :
+	iFd(-1)
+{
+	(void)memset(achPath, '\0', sizeof(achPath));
+
+	if ( NULL != pPath )
+		(void)open(pPath, iFlags);
+}
+
+SysfsAttribute::~SysfsAttribute()
+{
+	close();
+}
+
+bool SysfsAttribute::open(const char *pPath, const int32_t iFlags /*= O_RDONLY*/)
+{
+	close();
+
+	if ( NULL == pPath )
+		return false;
+
+	(void)strncpy(achPath, pPath, sizeof(achPath) - 1);
+
+	if ( bDebug )
+		(void)printf("\nTrying to open \"%s.\"\n", achPath);
+
+	iFd = ::open(achPath, iFlags | O_CLOEXEC);
+
+	if ( 0 > iFd )
+	{
+		(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", achPath, strerror(errno));
+		return false;
+	}
+
+	else if ( bDebug )
+		(void)printf("Successfully opened \"%s.\"\n", achPath);
+	else
+		;
+
+	return true;
+}
+
+void SysfsAttribute::close(void)
+{
+	if ( 0 <= iFd )
+		(void)::close(iFd);
+	iFd = -1;
+}
+
+ssize_t SysfsAttribute::readBuffer(char *pBuffer, const size_t uSize)
+{
+	if ( ( 0 > iFd ) || ( NULL == pBuffer ) || ( 0 == uSize ) )
+		return -1;
+
+	ssize_t nRead = -1;
+
+	do
+	{
+		// Offset zero makes the kernel regenerate the attribute's value.
+		nRead = pread(iFd, pBuffer, uSize - 1, 0);
+	}
+	while ( ( 0 > nRead ) && ( EINTR == errno ) );
+
+	if ( 0 > nRead )
+	{
+		(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", achPath, strerror(errno));
+		pBuffer[0] = '\0';
+		return nRead;
+	}
+
+	pBuffer[nRead] = '\0';
+
+	return nRead;
+}
+
+bool SysfsAttribute::writeBuffer(const char *pBuffer, const size_t uLength)
+{
+	if ( 0 > iFd )
+		return false;
+
+	ssize_t nWritten = -1;
+
+	do
+	{
+		nWritten = pwrite(iFd, pBuffer, uLength, 0);
+	}
+	while ( ( 0 > nWritten ) && ( EINTR == errno ) );
+
+	if ( (ssize_t)uLength != nWritten )
+	{
+		(void)printf("Unable to write to \"%s!\"\n\t\"%s\"\n", achPath, strerror(errno));
+		return false;
+	}
+
+	else if ( bDebug )
+		(void)printf("Wrote \"%.*s\" to \"%s.\"\n", (int)uLength, pBuffer, achPath);
+	else
+		;
+
+	return true;
+}
+
+const char *SysfsAttribute::parseInteger(const char *p, int32_t &iValue)
+{
+	while ( ( ' ' == *p ) || ( '\t' == *p ) || ( '\n' == *p ) )
+		p++;
+
+	bool bNegative = false;
+
+	if ( '-' == *p )
+		bNegative = true, p++;
+	else if ( '+' == *p )
+		p++;
+	else
+		;
+
+	if ( ( '0' > *p ) || ( '9' < *p ) )
+		return NULL;
+
+	int64_t i = 0;
+
+	while ( ( '0' <= *p ) && ( '9' >= *p ) )
+	{
+		i = ( 10 * i ) + ( *p - '0' );
+		p++;
+	}
+
+	iValue = (int32_t)( bNegative ? -i : i );
+
+	return p;
+}
+
+const char *SysfsAttribute::parseDouble(const char *p, double_t &dValue)
+{
+	static const double_t dPowersOfTen[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+		1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+	};
+
+	const int32_t MAX_FRACTION_DIGITS = ( sizeof(dPowersOfTen) / sizeof(dPowersOfTen[0]) ) - 1;
+
+	while ( ( ' ' == *p ) || ( '\t' == *p ) || ( '\n' == *p ) )
+		p++;
+
+	const char *pStart = p;
+
+	bool bNegative = false;
+
+	if ( '-' == *p )
+		bNegative = true, p++;
+	else if ( '+' == *p )
+		p++;
+	else
+		;
+
+	int64_t iInteger = 0, iFraction = 0;
+	int32_t nDigits = 0, nFractionDigits = 0;
+
+	while ( ( '0' <= *p ) && ( '9' >= *p ) )
+	{
+		iInteger = ( 10 * iInteger ) + ( *p - '0' );
+		p++, nDigits++;
+	}
+
+	if ( '.' == *p )
+	{
+		p++;
+		while ( ( '0' <= *p ) && ( '9' >= *p ) )
+		{
+			if ( MAX_FRACTION_DIGITS > nFractionDigits )
+			{
+				iFraction = ( 10 * iFraction ) + ( *p - '0' );
+				nFractionDigits++;
+			}
+			p++, nDigits++;
+		}
+	}
+
+	if ( !nDigits )
+		return NULL;
+
+	// Exponents never come from the IIO core, but don't get them wrong.
+	if ( ( 'e' == *p ) || ( 'E' == *p ) )
+	{
+		char *pEnd = NULL;
+		dValue = strtod(pStart, &pEnd);
+		return pEnd;
+	}
+
+	dValue = (double_t)iInteger + ( (double_t)iFraction / dPowersOfTen[nFractionDigits] );
+
+	if ( bNegative )
+		dValue = -dValue;
+
+	return p;
+}
+
+bool SysfsAttribute::readInteger(int32_t &iValue)
+{
+	char achBuffer[ATTRIBUTE_BUFFER_SIZE];
+
+	if ( 0 >= readBuffer(achBuffer, sizeof(achBuffer)) )
+		return false;
+
+	if ( NULL == parseInteger(achBuffer, iValue) )
+	{
+		(void)printf("Unable to parse \"%s\" from \"%s!\"\n", achBuffer, achPath);
+		return false;
+	}
+
+	return true;
+}
+
+bool SysfsAttribute::readUnsigned(uint32_t &uValue)
+{
+	char achBuffer[ATTRIBUTE_BUFFER_SIZE];
+
+	if ( 0 >= readBuffer(achBuffer, sizeof(achBuffer)) )
+		return false;
+
+	const char *p = achBuffer;
+
+	while ( ( ' ' == *p ) || ( '\t' == *p ) || ( '\n' == *p ) )
+		p++;
+
+	if ( ( '0' > *p ) || ( '9' < *p ) )
+	{
+		(void)printf("Unable to parse \"%s\" from \"%s!\"\n", achBuffer, achPath);
+		return false;
+	}
+
+	uint32_t u = 0;
+
+	while ( ( '0' <= *p ) && ( '9' >= *p ) )
+	{
+		u = ( 10 * u ) + (uint32_t)( *p - '0' );
+		p++;
+	}
+
+	uValue = u;
+
+	return true;
+}
+
+int32_t SysfsAttribute::readIntegers(int32_t *piValues, const int32_t nValues)
+{
+	char achBuffer[ATTRIBUTE_BUFFER_SIZE];
+
+	if ( 0 >= readBuffer(achBuffer, sizeof(achBuffer)) )
+		return 0;
+
+	const char *p = achBuffer;
+	int32_t n = 0;
+
+	while ( ( n < nValues ) && ( NULL != p ) )
+	{
+		p = parseInteger(p, piValues[n]);
+		if ( NULL != p )
+			n++;
+	}
+
+	return n;
+}
+
+bool SysfsAttribute::readDouble(double_t &dValue)
+{
+	char achBuffer[ATTRIBUTE_BUFFER_SIZE];
+
+	if ( 0 >= readBuffer(achBuffer, sizeof(achBuffer)) )
+		return false;
+
+	if ( NULL == parseDouble(achBuffer, dValue) )
+	{
+		(void)printf("Unable to parse \"%s\" from \"%s!\"\n", achBuffer, achPath);
+		return false;
+	}
+
+	return true;
+}
+
+bool SysfsAttribute::readString(char *pBuffer, const size_t uSize)
+{
+	ssize_t nRead = readBuffer(pBuffer, uSize);
+
+	if ( 0 >= nRead )
+		return false;
+
+	// Like "%s," stop at the first whitespace; e.g., the trailing newline.
+	for ( ssize_t i = 0 ; i < nRead ; i++ )
+	{
+		if ( ( ' ' == pBuffer[i] ) || ( '\t' == pBuffer[i] ) || ( '\n' == pBuffer[i] ) )
+		{
+			pBuffer[i] = '\0';
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool SysfsAttribute::writeUnsigned(const uint32_t uValue)
+{
+	char achBuffer[ATTRIBUTE_BUFFER_SIZE];
+	char *p = &achBuffer[sizeof(achBuffer)];
+	uint32_t u = uValue;
+
+	// Format backwards from the end of the buffer; no snprintf needed.
+	do
+	{
+		*--p = (char)( '0' + ( u % 10 ) );
+		u /= 10;
+	}
+	while ( u );
+
+	return writeBuffer(p, (size_t)( &achBuffer[sizeof(achBuffer)] - p ));
+}
+
+bool SysfsAttribute::writeInteger(const int32_t iValue)
+{
+	if ( 0 <= iValue )
+		return writeUnsigned((uint32_t)iValue);
+
+	char achBuffer[ATTRIBUTE_BUFFER_SIZE];
+	char *p = &achBuffer[sizeof(achBuffer)];
+	uint32_t u = (uint32_t)( -(int64_t)iValue );
+
+	do
+	{
+		*--p = (char)( '0' + ( u % 10 ) );
+		u /= 10;
+	}
+	while ( u );
+
+	*--p = '-';
+
+	return writeBuffer(p, (size_t)( &achBuffer[sizeof(achBuffer)] - p ));
+}
+
+bool SysfsAttribute::writeString(const char *pString)
+{
+	if ( NULL == pString )
+		return false;
+
+	return writeBuffer(pString, strlen(pString));
+}
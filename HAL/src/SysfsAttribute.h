@@ -0,0 +1,90 @@
+/*
+	SysfsAttribute.h - Persistent-handle sysfs attribute class for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	A sysfs attribute (e.g., "/sys/bus/iio/devices/iio:device1/in_anglvel_x_raw" or
+	"/sys/class/pwm/pwmchip2/pwm0/duty_cycle") is opened once and then re-read or
+	re-written with pread/pwrite at offset zero; the kernel regenerates the value on
+	every access, so there's no need for fopen, fscanf, fprintf, and fclose per sample.
+
+*/
+
+#ifndef _SYSFS_ATTRIBUTE_H
+#define _SYSFS_ATTRIBUTE_H
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define SYSFS_ATTRIBUTE_VERSION	1     		// software version of this library
+
+class SysfsAttribute
+{
+public:
+	SysfsAttribute(const char *pPath = NULL, const int32_t iFlags = O_RDONLY);
+	~SysfsAttribute();
+
+	bool open(const char *pPath, const int32_t iFlags = O_RDONLY);
+	void close(void);
+
+	inline bool isOpen(void)
+	{
+		return 0 <= iFd;
+	}
+
+	inline int32_t getFd(void)
+	{
+		return iFd;
+	}
+
+	inline const char *getPath(void)
+	{
+		return (const char *)achPath;
+	}
+
+	bool readInteger(int32_t &iValue);
+	bool readUnsigned(uint32_t &uValue);
+	int32_t readIntegers(int32_t *piValues, const int32_t nValues);
+											// Returns the number of values parsed; e.g., "w x y z" quaternions.
+	bool readDouble(double_t &dValue);
+	bool readString(char *pBuffer, const size_t uSize);
+
+	bool writeInteger(const int32_t iValue);
+	bool writeUnsigned(const uint32_t uValue);
+	bool writeString(const char *pString);
+
+	// Fast, locale-free parsers; they return a pointer past the parsed text or NULL.
+	static const char *parseInteger(const char *p, int32_t &iValue);
+	static const char *parseDouble(const char *p, double_t &dValue);
+
+	static const size_t ATTRIBUTE_BUFFER_SIZE = 64;
+											// Plenty for any IIO or PWM attribute.
+
+private:
+	int32_t iFd;
+
+	char achPath[FILENAME_MAX];
+
+	static const bool bDebug;
+
+	ssize_t readBuffer(char *pBuffer, const size_t uSize);
+	bool writeBuffer(const char *pBuffer, const size_t uLength);
+};
+
+#endif	// _SYSFS_ATTRIBUTE_H
@@ -0,0 +1,397 @@
+/*
+	Executive.cpp - Rate-group real-time executive for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "Executive.h"
+
+const bool Executive::bDebug = false;
+
+const int32_t Executive::MAX_RATE_GROUPS;
+const int32_t Executive::MAX_TASKS_PER_GROUP;
+
+const double_t Executive::DEFAULT_BUDGET	= 0.5;	// Half the period; the rest is for the other groups and the kernel.
+
+const int32_t Executive::BASE_PRIORITY		= 70;	// Above the kernel's interrupt threads (50), below its watchdogs (99).
+
+Executive::Executive() :
+	nGroups(0), bRunning(false), bRealTime(false), bLocked(false)
+{
+	for ( int32_t i = 0 ; i < MAX_RATE_GROUPS ; i++ )
+	{
+		RateGroup &group = groups[i];
+
+		(void)memset(group.achName, '\0', sizeof(group.achName));
+		group.iPeriodNs = group.iBudgetNs = 0;
+		group.iCpu = -1, group.iPriority = 0, group.nTasks = 0;
+		(void)memset(group.apTasks, 0, sizeof(group.apTasks));
+		(void)memset(group.apContexts, 0, sizeof(group.apContexts));
+		(void)memset(group.apNames, 0, sizeof(group.apNames));
+		group.pTrigger = NULL, group.pTriggerContext = NULL;
+		(void)memset(&group.sThread, 0, sizeof(pthread_t));
+		group.bStarted = false;
+		group.pExecutive = this;
+		group.lateness.reset();
+	}
+}
+
+Executive::~Executive()
+{
+	stop();
+}
+
+int32_t Executive::addRateGroup(const char *pName, const double_t dRateHz, const int32_t iCpu /*= -1*/,
+	const double_t dBudget /*= DEFAULT_BUDGET*/)
+{
+	if ( ( MAX_RATE_GROUPS <= nGroups ) || running() || !( 0.0 < dRateHz ) )
+		return -1;
+
+	RateGroup &group = groups[nGroups];
+
+	(void)strncpy(group.achName, ( NULL != pName ) ? pName : "", sizeof(group.achName) - 1);
+
+	char achLateness[sizeof(group.achName) + 16];
+
+	(void)snprintf(achLateness, sizeof(achLateness), "%s lateness", group.achName);
+	group.lateness.setName(achLateness);
+
+	group.iPeriodNs	= (int64_t)( 1e9 / dRateHz );
+	group.iBudgetNs	= (int64_t)( group.iPeriodNs * ( ( ( 0.0 < dBudget ) && ( 1.0 >= dBudget ) ) ? dBudget : DEFAULT_BUDGET ) );
+	group.iCpu		= iCpu;
+
+	return nGroups++;
+}
+
+bool Executive::addTask(const int32_t iGroup, const char *pName, ExecutiveTask pTask, void *pContext)
+{
+	if ( ( 0 > iGroup ) || ( nGroups <= iGroup ) || ( NULL == pTask ) || running() )
+		return false;
+
+	RateGroup &group = groups[iGroup];
+
+	if ( MAX_TASKS_PER_GROUP <= group.nTasks )
+		return false;
+
+	group.apTasks[group.nTasks]		= pTask;
+	group.apContexts[group.nTasks]	= pContext;
+	group.apNames[group.nTasks]		= pName;
+	group.nTasks++;
+
+	return true;
+}
+
+bool Executive::setTrigger(const int32_t iGroup, ExecutiveTrigger pTrigger, void *pContext)
+{
+	if ( ( 0 > iGroup ) || ( nGroups <= iGroup ) || running() )
+		return false;
+
+	groups[iGroup].pTrigger			= pTrigger;
+	groups[iGroup].pTriggerContext	= pContext;
+
+	return true;
+}
+
+bool Executive::startGroup(RateGroup &group, const bool bFifo)
+{
+	pthread_attr_t sAttributes;
+
+	(void)pthread_attr_init(&sAttributes);
+
+	if ( bFifo )
+	{
+		struct sched_param sParameters;
+
+		(void)memset(&sParameters, 0, sizeof(sParameters));
+		sParameters.sched_priority = group.iPriority;
+
+		(void)pthread_attr_setinheritsched(&sAttributes, PTHREAD_EXPLICIT_SCHED);
+		(void)pthread_attr_setschedpolicy(&sAttributes, SCHED_FIFO);
+		(void)pthread_attr_setschedparam(&sAttributes, &sParameters);
+	}
+
+	if ( 0 <= group.iCpu )
+	{
+		cpu_set_t sCpus;
+
+		CPU_ZERO(&sCpus);
+		CPU_SET(group.iCpu, &sCpus);
+
+		(void)pthread_attr_setaffinity_np(&sAttributes, sizeof(sCpus), &sCpus);
+	}
+
+	int32_t iRet = pthread_create(&group.sThread, &sAttributes, groupBackground, (void *)&group);
+
+	(void)pthread_attr_destroy(&sAttributes);
+
+	if ( 0 != iRet )
+	{
+		if ( !bFifo || ( EPERM != iRet ) )
+			(void)fprintf(stderr, "%s: thread creation error for the \"%s\" group!\n\t\"%s\"", __FUNCTION__, group.achName, strerror(iRet));
+		return false;
+	}
+	else if ( bDebug )
+		(void)printf("The \"%s\" group's thread is running at priority %i%s.\n", group.achName, group.iPriority, bFifo ? " (SCHED_FIFO)" : "");
+	else
+		;
+
+	group.bStarted = true;
+
+	return true;
+}
+
+bool Executive::start(void)
+{
+	if ( running() )
+		return true;
+
+	if ( 0 == nGroups )
+		return false;
+
+	// Rate monotonic: each group is above every slower one.
+	for ( int32_t i = 0 ; i < nGroups ; i++ )
+	{
+		groups[i].iPriority = BASE_PRIORITY;
+
+		for ( int32_t j = 0 ; j < nGroups ; j++ )
+			if ( groups[j].iPeriodNs > groups[i].iPeriodNs )
+				groups[i].iPriority++;
+	}
+
+	bLocked = ( 0 == mlockall(MCL_CURRENT | MCL_FUTURE) );
+
+	if ( !bLocked )
+		(void)printf("%s: unable to lock the memory; a page fault may stall a frame.\n\t\"%s\"\n", __FUNCTION__, strerror(errno));
+
+	bRunning = true;
+	bRealTime = bLocked;
+
+	for ( int32_t i = 0 ; i < nGroups ; i++ )
+	{
+		if ( startGroup(groups[i], bRealTime) )
+			continue;
+
+		// Without the privilege for SCHED_FIFO, none of them can have it.
+		else if ( bRealTime && ( 0 == i ) && startGroup(groups[i], false) )
+		{
+			(void)printf("%s: unable to use SCHED_FIFO; the rate groups run as ordinary threads.\n", __FUNCTION__);
+			bRealTime = false;
+		}
+		else
+		{
+			stop();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Executive::stop(void)
+{
+	if ( !running() )
+		return;
+
+	bRunning = false;
+
+	for ( int32_t i = 0 ; i < nGroups ; i++ )
+		if ( groups[i].bStarted )
+		{
+			(void)pthread_join(groups[i].sThread, NULL);
+			groups[i].bStarted = false;
+		}
+
+	if ( bLocked )
+		(void)munlockall();
+	bLocked = false;
+
+	if ( bDebug )
+		printStats();
+}
+
+bool Executive::getStats(const int32_t iGroup, RateGroupStats &stats)
+{
+	if ( ( 0 > iGroup ) || ( nGroups <= iGroup ) )
+		return false;
+
+	if ( 0 == groups[iGroup].stats.writes() )
+		(void)memset(&stats, 0, sizeof(stats));
+	else
+		groups[iGroup].stats.read(stats);
+
+	return true;
+}
+
+LatencyHistogram *Executive::getLateness(const int32_t iGroup)
+{
+	if ( ( 0 > iGroup ) || ( nGroups <= iGroup ) )
+		return NULL;
+
+	return &groups[iGroup].lateness;
+}
+
+double_t Executive::getUtilization(const int32_t iGroup)
+{
+	RateGroupStats stats;
+
+	if ( !getStats(iGroup, stats) || ( 0 == stats.uFrames ) )
+		return 0.0;
+
+	return (double_t)stats.iTotalCpuNs / ( (double_t)stats.uFrames * (double_t)groups[iGroup].iPeriodNs );
+}
+
+void Executive::printStats(FILE *pFile /*= stdout*/)
+{
+	(void)fprintf(pFile, "%-12s %6s %9s %8s %8s %8s %9s %9s %9s %6s\n", "group", "Hz", "frames", "overruns", "skipped",
+		"over", "max cpu", "max late", "max run", "use");
+
+	for ( int32_t i = 0 ; i < nGroups ; i++ )
+	{
+		RateGroupStats stats;
+
+		(void)getStats(i, stats);
+
+		(void)fprintf(pFile, "%-12s %6.0lf %9u %8u %8u %8u %7.1lfus %7.1lfus %7.1lfus %5.1lf%%\n", groups[i].achName,
+			1e9 / groups[i].iPeriodNs, stats.uFrames, stats.uOverruns, stats.uSkipped, stats.uOverBudget,
+			stats.iMaxCpuNs * 1e-3, stats.iMaxLatenessNs * 1e-3, stats.iMaxElapsedNs * 1e-3, 100.0 * getUtilization(i));
+	}
+}
+
+void *Executive::groupBackground(void *pContext)
+{
+	RateGroup *pGroup = (RateGroup *)pContext;
+	pGroup->pExecutive->runGroup(*pGroup);
+	return NULL;
+}
+
+static int64_t nanoseconds(const struct timespec &t)
+{
+	return ( (int64_t)t.tv_sec * 1000000000LL ) + t.tv_nsec;
+}
+
+static void addNanoseconds(struct timespec &t, const int64_t iNs)
+{
+	int64_t iTotal = (int64_t)t.tv_nsec + iNs;
+
+	t.tv_sec += (time_t)( iTotal / 1000000000LL );
+	t.tv_nsec = (long)( iTotal % 1000000000LL );
+}
+
+void Executive::runGroup(RateGroup &group)
+{
+	RateGroupStats stats;
+
+	(void)memset(&stats, 0, sizeof(stats));
+
+	struct timespec deadline, now, cpuStart, cpuEnd;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+	while ( running() )
+	{
+		if ( !waitForFrame(group, deadline) )
+			continue;
+
+		(void)clock_gettime(CLOCK_MONOTONIC, &now);
+		(void)clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+
+		const int64_t iLatenessNs = nanoseconds(now) - nanoseconds(deadline);
+
+		group.lateness.record(iLatenessNs);
+
+		for ( int32_t i = 0 ; i < group.nTasks ; i++ )
+			group.apTasks[i](group.apContexts[i]);
+
+		(void)clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+		(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+		const int64_t iCpuNs = nanoseconds(cpuEnd) - nanoseconds(cpuStart),
+			iElapsedNs = nanoseconds(now) - nanoseconds(deadline);
+
+		stats.uFrames++;
+		stats.iLastCpuNs = iCpuNs;
+		stats.iTotalCpuNs += iCpuNs;
+
+		if ( iCpuNs > stats.iMaxCpuNs )
+			stats.iMaxCpuNs = iCpuNs;
+
+		if ( iLatenessNs > stats.iMaxLatenessNs )
+			stats.iMaxLatenessNs = iLatenessNs;
+
+		if ( iElapsedNs > stats.iMaxElapsedNs )
+			stats.iMaxElapsedNs = iElapsedNs;
+
+		if ( iCpuNs > group.iBudgetNs )
+			stats.uOverBudget++;
+
+		if ( iElapsedNs > group.iPeriodNs )
+		{
+			// Skip the deadlines that already went by rather than bursting to catch up.
+			const int64_t iSkipped = iElapsedNs / group.iPeriodNs;
+
+			stats.uOverruns++;
+			stats.uSkipped += (uint32_t)iSkipped;
+
+			// A trigger's events skip themselves; the next frame is the newest event.
+			if ( NULL == group.pTrigger )
+				addNanoseconds(deadline, iSkipped * group.iPeriodNs);
+		}
+
+		group.stats.write(stats);
+	}
+}
+
+bool Executive::waitForFrame(RateGroup &group, struct timespec &deadline)
+{
+	if ( NULL == group.pTrigger )
+	{
+		addNanoseconds(deadline, group.iPeriodNs);
+
+		while ( EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) )
+			;
+
+		return true;
+	}
+
+	// A couple of periods, so stop() isn't held up when the events stop.
+	const int32_t iTimeoutMs = (int32_t)( ( 2 * group.iPeriodNs ) / 1000000LL ) + 1;
+
+	int64_t iEventNs = 0;
+
+	if ( !group.pTrigger(group.pTriggerContext, iTimeoutMs, iEventNs) )
+		return false;
+
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	// Not from the future, nor from before the previous frame's.
+	if ( ( 0 >= iEventNs ) || ( iEventNs > nanoseconds(now) ) || ( iEventNs < nanoseconds(deadline) ) )
+		iEventNs = nanoseconds(now);
+
+	deadline.tv_sec = (time_t)( iEventNs / 1000000000LL );
+	deadline.tv_nsec = (long)( iEventNs % 1000000000LL );
+
+	return true;
+}
@@ -0,0 +1,167 @@
+/*
+	Executive.h - Rate-group real-time executive for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	Tasks register in rate groups, e.g., actuation at 400 Hz and control at 50 Hz; each
+	group runs its tasks, in the order they were added, on its own thread, woken on
+	absolute CLOCK_MONOTONIC deadlines by clock_nanosleep(TIMER_ABSTIME), so the period
+	doesn't drift with the tasks' run time.
+
+	start() locks the process's memory (mlockall) so a page fault can't stall a frame,
+	and runs the groups SCHED_FIFO, the faster the group the higher its priority (rate
+	monotonic), pinned to the CPU given, if any. Without the privileges for these (root,
+	or CAP_SYS_NICE and CAP_IPC_LOCK), it says so and runs the groups as ordinary threads.
+
+	Each frame's thread CPU time is charged against the group's budget, a fraction of its
+	period; a frame that finishes after the next deadline is an overrun, and the deadlines
+	it ran through are skipped rather than run back to back to catch up.
+
+	A group that consumes a sensor's samples shouldn't run on a clock of its own: two free
+	running clocks at the same rate beat, so some frames find no new sample and the next
+	one skips a sample. Such a group gets a trigger instead, which blocks until the sensor
+	publishes; its frames then start on the samples, and a frame's deadline, for the
+	lateness and the overruns, is when the sample was taken.
+
+*/
+
+#ifndef _EXECUTIVE_H
+#define _EXECUTIVE_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include <math.h>
+#include <atomic>
+#include "SeqLock.h"
+#include "LatencyHistogram.h"
+
+#define EXECUTIVE_VERSION	1     			// software version of this library
+
+// A task runs once a frame and returns; it mustn't block.
+typedef void (*ExecutiveTask)(void *pContext);
+
+// Blocks until the event that starts a frame, up to the timeout; false on a timeout. Sets
+//	the event's CLOCK_MONOTONIC time in nanoseconds, or leaves it zero for "now."
+typedef bool (*ExecutiveTrigger)(void *pContext, const int32_t iTimeoutMs, int64_t &iEventNs);
+
+typedef struct sRateGroupStats
+{
+	uint32_t uFrames;
+	uint32_t uOverruns;						// Frames that ran past the next deadline,
+	uint32_t uSkipped;						//	the deadlines they ran through,
+	uint32_t uOverBudget;					//	and frames that used more CPU than the budget.
+	int64_t iLastCpuNs;						// Thread CPU time, the last frame,
+	int64_t iMaxCpuNs;						//	the most in a frame,
+	int64_t iTotalCpuNs;					//	and all the frames'.
+	int64_t iMaxLatenessNs;					// The latest a frame started after its deadline.
+	int64_t iMaxElapsedNs;					// The longest a frame took, deadline to finish.
+} RateGroupStats;
+
+class Executive
+{
+public:
+	Executive();
+	~Executive();
+
+	// Returns the group's number, or negative; before start(). A negative CPU isn't pinned;
+	//	the budget is the share of the period the group's tasks may use, 0 to 1.
+	int32_t addRateGroup(const char *pName, const double_t dRateHz, const int32_t iCpu = -1,
+		const double_t dBudget = DEFAULT_BUDGET);
+
+	// Returns false if the group is full or the executive is running.
+	bool addTask(const int32_t iGroup, const char *pName, ExecutiveTask pTask, void *pContext);
+
+	// Starts the group's frames on the trigger's events instead of its clock; the rate is
+	//	then the events' nominal rate, for the priorities and the timeout. Before start().
+	bool setTrigger(const int32_t iGroup, ExecutiveTrigger pTrigger, void *pContext);
+
+	bool start(void);
+	void stop(void);						// Waits for each group's frame to come round; up to a period.
+
+	inline bool running(void)
+	{
+		return bRunning.load(std::memory_order_relaxed);
+	}
+
+	// Whether start() got SCHED_FIFO and locked memory.
+	inline bool realTime(void)
+	{
+		return bRealTime;
+	}
+
+	inline int32_t getRateGroups(void)
+	{
+		return nGroups;
+	}
+
+	bool getStats(const int32_t iGroup, RateGroupStats &stats);
+
+	// How late the group's frames started, deadline to wake up; NULL for no such group.
+	LatencyHistogram *getLateness(const int32_t iGroup);
+
+	// The share of the group's period its tasks used, on average.
+	double_t getUtilization(const int32_t iGroup);
+
+	void printStats(FILE *pFile = stdout);
+
+	static const int32_t MAX_RATE_GROUPS = 8;
+	static const int32_t MAX_TASKS_PER_GROUP = 8;
+
+	static const double_t DEFAULT_BUDGET;
+
+	static const int32_t BASE_PRIORITY;		// The slowest group's SCHED_FIFO priority.
+
+private:
+	typedef struct sRateGroup
+	{
+		char achName[32];
+		int64_t iPeriodNs;
+		int64_t iBudgetNs;
+		int32_t iCpu;
+		int32_t iPriority;
+		int32_t nTasks;
+		ExecutiveTask apTasks[MAX_TASKS_PER_GROUP];
+		void *apContexts[MAX_TASKS_PER_GROUP];
+		const char *apNames[MAX_TASKS_PER_GROUP];
+		ExecutiveTrigger pTrigger;			// NULL for the clock.
+		void *pTriggerContext;
+		pthread_t sThread;
+		bool bStarted;
+		Executive *pExecutive;
+		SeqLock<RateGroupStats> stats;
+		LatencyHistogram lateness;
+	} RateGroup;
+
+	RateGroup groups[MAX_RATE_GROUPS];
+	int32_t nGroups;
+
+	std::atomic<bool> bRunning;
+	bool bRealTime;
+	bool bLocked;
+
+	static const bool bDebug;
+
+	static void *groupBackground(void *pContext);
+	void runGroup(RateGroup &group);
+
+	// Waits for the group's next frame; false if there isn't one yet. Sets its deadline.
+	bool waitForFrame(RateGroup &group, struct timespec &deadline);
+	bool startGroup(RateGroup &group, const bool bFifo);
+};
+
+#endif	// _EXECUTIVE_H
@@ -0,0 +1,135 @@
+/*
+	LatencyHistogram.cpp - Lock-free log-linear latency histogram for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <string.h>
+#include "LatencyHistogram.h"
+
+const uint32_t LatencyHistogram::SUB_BUCKET_BITS;
+const uint32_t LatencyHistogram::SUB_BUCKETS;
+const uint32_t LatencyHistogram::MAX_EXPONENT;
+const uint32_t LatencyHistogram::NUMBER_OF_BUCKETS;
+
+LatencyHistogram::LatencyHistogram(const char *pName /*= NULL*/)
+{
+	setName(pName);
+	reset();
+}
+
+void LatencyHistogram::setName(const char *pName)
+{
+	(void)memset(achName, '\0', sizeof(achName));
+
+	if ( NULL != pName )
+		(void)strncpy(achName, pName, sizeof(achName) - 1);
+}
+
+void LatencyHistogram::reset(void)
+{
+	for ( uint32_t i = 0 ; i < NUMBER_OF_BUCKETS ; i++ )
+		auCounts[i].store(0, std::memory_order_relaxed);
+
+	uSum.store(0, std::memory_order_relaxed);
+	uMin.store(UINT64_MAX, std::memory_order_relaxed);
+	uMax.store(0, std::memory_order_relaxed);
+	uCount.store(0, std::memory_order_release);
+}
+
+uint64_t LatencyHistogram::bucketLow(const uint32_t uBucket)
+{
+	if ( SUB_BUCKETS > uBucket )
+		return uBucket;
+
+	const uint32_t uExponent = ( ( uBucket - SUB_BUCKETS ) / SUB_BUCKETS ) + SUB_BUCKET_BITS,
+		uSubBucket = ( uBucket - SUB_BUCKETS ) % SUB_BUCKETS;
+
+	return (uint64_t)( SUB_BUCKETS + uSubBucket ) << ( uExponent - SUB_BUCKET_BITS );
+}
+
+uint64_t LatencyHistogram::bucketHigh(const uint32_t uBucket)
+{
+	if ( ( NUMBER_OF_BUCKETS - 1 ) <= uBucket )
+		return UINT64_MAX;
+
+	return bucketLow(uBucket + 1) - 1;
+}
+
+int64_t LatencyHistogram::getMin(void)
+{
+	return ( 0 == getCount() ) ? 0 : (int64_t)uMin.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::getMax(void)
+{
+	return (int64_t)uMax.load(std::memory_order_relaxed);
+}
+
+double_t LatencyHistogram::getMean(void)
+{
+	const uint64_t uN = getCount();
+
+	return ( 0 == uN ) ? 0.0 : (double_t)uSum.load(std::memory_order_relaxed) / (double_t)uN;
+}
+
+int64_t LatencyHistogram::valueAtPercentile(const double_t dPercentile)
+{
+	const uint64_t uN = getCount();
+
+	if ( 0 == uN )
+		return 0;
+
+	// The rank of the sample wanted, from one.
+	uint64_t uRank = (uint64_t)ceil(( ( 0.0 > dPercentile ) ? 0.0 : ( ( 100.0 < dPercentile ) ? 100.0 : dPercentile ) ) / 100.0 * uN);
+
+	if ( 0 == uRank )
+		uRank = 1;
+
+	uint64_t uSeen = 0;
+
+	for ( uint32_t i = 0 ; i < NUMBER_OF_BUCKETS ; i++ )
+	{
+		uSeen += auCounts[i].load(std::memory_order_relaxed);
+
+		// No bucket's edge is past the largest value recorded.
+		if ( uSeen >= uRank )
+			return (int64_t)( ( bucketHigh(i) < (uint64_t)getMax() ) ? bucketHigh(i) : (uint64_t)getMax() );
+	}
+
+	return getMax();
+}
+
+void LatencyHistogram::print(FILE *pFile /*= stdout*/)
+{
+	(void)fprintf(pFile, "%-20s %10" PRIu64 " samples; min %9.1lf, mean %9.1lf, p50 %9.1lf, p90 %9.1lf, p99 %9.1lf, p99.9 %9.1lf, max %9.1lf us\n",
+		achName, getCount(), getMin() * 1e-3, getMean() * 1e-3, valueAtPercentile(50.0) * 1e-3, valueAtPercentile(90.0) * 1e-3,
+		valueAtPercentile(99.0) * 1e-3, valueAtPercentile(99.9) * 1e-3, getMax() * 1e-3);
+}
+
+void LatencyHistogram::printBuckets(FILE *pFile /*= stdout*/)
+{
+	(void)fprintf(pFile, "%s:\n", achName);
+
+	for ( uint32_t i = 0 ; i < NUMBER_OF_BUCKETS ; i++ )
+	{
+		const uint64_t uBucketCount = auCounts[i].load(std::memory_order_relaxed);
+
+		if ( 0 != uBucketCount )
+			(void)fprintf(pFile, "\t%12" PRIu64 " to %12" PRIu64 " ns: %" PRIu64 "\n", bucketLow(i), bucketHigh(i), uBucketCount);
+	}
+}
@@ -0,0 +1,126 @@
+/*
+	LatencyHistogram.h - Lock-free log-linear latency histogram for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	An HDR-style histogram of nanosecond latencies, cheap enough to leave on in flight:
+	record() is a count-leading-zeros, a shift, and a few relaxed atomic stores, with no
+	lock and no allocation. Below 16 ns each nanosecond has a bucket; above, each power
+	of two is split into 16 buckets, so a value is known to within 1/16 (6.25 percent) up
+	to about 18 minutes. Larger values land in the top bucket.
+
+	One thread records; any thread may read, e.g., percentiles for telemetry or print()
+	on demand. A reader racing record() may see a count a sample behind the others.
+
+*/
+
+#ifndef _LATENCY_HISTOGRAM_H
+#define _LATENCY_HISTOGRAM_H
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <math.h>
+#include <atomic>
+
+#define LATENCY_HISTOGRAM_VERSION	1     	// software version of this library
+
+class LatencyHistogram
+{
+public:
+	LatencyHistogram(const char *pName = NULL);
+
+	// Only one thread may record; a negative value counts as zero.
+	inline void record(const int64_t iValueNs)
+	{
+		const uint64_t uValue = ( 0 < iValueNs ) ? (uint64_t)iValueNs : 0;
+		const uint32_t uBucket = bucketOf(uValue);
+
+		auCounts[uBucket].store(auCounts[uBucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		uSum.store(uSum.load(std::memory_order_relaxed) + uValue, std::memory_order_relaxed);
+
+		if ( uValue > uMax.load(std::memory_order_relaxed) )
+			uMax.store(uValue, std::memory_order_relaxed);
+
+		if ( uValue < uMin.load(std::memory_order_relaxed) )
+			uMin.store(uValue, std::memory_order_relaxed);
+
+		uCount.store(uCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// From the recording thread, or while nothing records.
+	void reset(void);
+
+	inline uint64_t getCount(void)
+	{
+		return uCount.load(std::memory_order_acquire);
+	}
+
+	// Zero while empty.
+	int64_t getMin(void);
+	int64_t getMax(void);
+	double_t getMean(void);
+
+	// The value that dPercentile percent of the samples are at or below, to the bucket's
+	//	precision (its upper edge); zero while empty.
+	int64_t valueAtPercentile(const double_t dPercentile);
+
+	inline const char *getName(void)
+	{
+		return achName;
+	}
+
+	void setName(const char *pName);
+
+	// One line: the count, minimum, mean, the 50th, 90th, 99th, and 99.9th percentiles,
+	//	and the maximum, in microseconds.
+	void print(FILE *pFile = stdout);
+
+	// Each non-empty bucket's range and count.
+	void printBuckets(FILE *pFile = stdout);
+
+	static const uint32_t SUB_BUCKET_BITS = 4;
+	static const uint32_t SUB_BUCKETS = ( 1 << SUB_BUCKET_BITS );
+	static const uint32_t MAX_EXPONENT = 40;	// 2^40 ns; about 18 minutes.
+	static const uint32_t NUMBER_OF_BUCKETS = SUB_BUCKETS + ( ( MAX_EXPONENT - SUB_BUCKET_BITS + 1 ) * SUB_BUCKETS );
+
+	// The smallest and largest values that land in a bucket.
+	static uint64_t bucketLow(const uint32_t uBucket);
+	static uint64_t bucketHigh(const uint32_t uBucket);
+
+	static inline uint32_t bucketOf(const uint64_t uValue)
+	{
+		if ( SUB_BUCKETS > uValue )
+			return (uint32_t)uValue;
+
+		const uint32_t uExponent = 63 - (uint32_t)__builtin_clzll(uValue);
+
+		if ( MAX_EXPONENT < uExponent )
+			return NUMBER_OF_BUCKETS - 1;
+
+		const uint32_t uSubBucket = (uint32_t)( uValue >> ( uExponent - SUB_BUCKET_BITS ) ) & ( SUB_BUCKETS - 1 );
+
+		return SUB_BUCKETS + ( ( uExponent - SUB_BUCKET_BITS ) * SUB_BUCKETS ) + uSubBucket;
+	}
+
+private:
+	char achName[32];
+
+	std::atomic<uint64_t> auCounts[NUMBER_OF_BUCKETS];
+	std::atomic<uint64_t> uCount, uSum, uMin, uMax;
+};
+
+#endif	// _LATENCY_HISTOGRAM_H
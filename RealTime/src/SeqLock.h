@@ -0,0 +1,109 @@
+/*
+	SeqLock.h - Single-writer, lock-free latest-value publication for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	One thread writes; any number of threads read the newest value without a lock or a
+	system call. The sequence number is odd while a write is in progress; a reader that sees
+	an odd number, or a different number after copying, copies again. The value is kept in
+	relaxed atomic words so the copy that might race a write is still well defined.
+
+	T has to be trivially copyable; e.g., a plain struct like ImuSample.
+
+*/
+
+#ifndef _SEQ_LOCK_H
+#define _SEQ_LOCK_H
+
+#include <inttypes.h>
+#include <string.h>
+#include <atomic>
+
+#define SEQ_LOCK_VERSION	1     			// software version of this library
+
+template <typename T>
+class SeqLock
+{
+public:
+	SeqLock() :
+		uSequence(0)
+	{
+		for ( uint32_t i = 0 ; i < NUMBER_OF_WORDS ; i++ )
+			auWords[i].store(0, std::memory_order_relaxed);
+	}
+
+	// Only one thread may write.
+	void write(const T &value)
+	{
+		uint64_t auValue[NUMBER_OF_WORDS] = { 0 };
+
+		(void)memcpy(auValue, &value, sizeof(T));
+
+		const uint32_t uStart = uSequence.load(std::memory_order_relaxed);
+
+		uSequence.store(uStart + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for ( uint32_t i = 0 ; i < NUMBER_OF_WORDS ; i++ )
+			auWords[i].store(auValue[i], std::memory_order_relaxed);
+
+		uSequence.store(uStart + 2, std::memory_order_release);
+	}
+
+	// Returns false, leaving value alone, if a write was in progress.
+	bool tryRead(T &value) const
+	{
+		uint64_t auValue[NUMBER_OF_WORDS];
+
+		const uint32_t uStart = uSequence.load(std::memory_order_acquire);
+
+		if ( uStart & 1 )
+			return false;
+
+		for ( uint32_t i = 0 ; i < NUMBER_OF_WORDS ; i++ )
+			auValue[i] = auWords[i].load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if ( uStart != uSequence.load(std::memory_order_relaxed) )
+			return false;
+
+		(void)memcpy(&value, auValue, sizeof(T));
+
+		return true;
+	}
+
+	// Retries until it gets a consistent copy; a write takes well under a microsecond.
+	void read(T &value) const
+	{
+		while ( !tryRead(value) )
+			;
+	}
+
+	// Counts writes; zero means nothing has been published.
+	inline uint32_t writes(void) const
+	{
+		return uSequence.load(std::memory_order_acquire) / 2;
+	}
+
+private:
+	static const uint32_t NUMBER_OF_WORDS = ( sizeof(T) + sizeof(uint64_t) - 1 ) / sizeof(uint64_t);
+
+	std::atomic<uint32_t> uSequence;
+	std::atomic<uint64_t> auWords[NUMBER_OF_WORDS];
+};
+
+#endif	// _SEQ_LOCK_H
@@ -0,0 +1,292 @@
+/*
+	ActuatorStage.cpp - Actuator output thread with latest-wins command mailboxes for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "ActuatorStage.h"
+
+const bool ActuatorStage::bDebug = false;
+
+ActuatorStage::ActuatorStage(K9TvcGimbal *pGimbal, Jet *pJet, PwmBackend *pBackend /*= NULL*/,
+	const int64_t iPeriodNs /*= SERVO_PERIOD_WIDTH*/) :
+	pGimbal(pGimbal), pJet(pJet), pBackend(pBackend), iPeriodNs(iPeriodNs),
+	bRunning(false), bOwnThread(true), uFrames(0), uApplies(0), uReplaced(0), uLate(0), iMaxLatencyNs(0),
+	latency("post to servo")
+{
+	(void)memset(&sActuatorThread, 0, sizeof(pthread_t));
+	(void)memset(auPosts, 0, sizeof(auPosts));
+	(void)memset(auApplied, 0, sizeof(auApplied));
+
+	abShaped[E_ACTUATOR_PITCH]		= true;
+	abShaped[E_ACTUATOR_YAW]		= true;
+	abShaped[E_ACTUATOR_THROTTLE]	= false;
+}
+
+ActuatorStage::~ActuatorStage()
+{
+	stop();
+}
+
+bool ActuatorStage::start(const bool bThread /*= true*/)
+{
+	if ( running() )
+		return true;
+
+	uFrames = uApplies = uReplaced = uLate = 0;
+	iMaxLatencyNs = 0;
+
+	bOwnThread = bThread;
+	bRunning = true;
+
+	if ( !bOwnThread )
+		return true;
+
+	int32_t iRet = pthread_create(&sActuatorThread, NULL, actuatorBackground, (void *)this);
+
+	if ( 0 != iRet )
+	{
+		(void)fprintf(stderr, "%s: thread creation error!\n\t\"%s\"", __FUNCTION__, strerror(iRet));
+		bRunning = false;
+		return false;
+	}
+	else if ( bDebug )
+		(void)printf("Actuator thread created successfully.\n");
+	else
+		;
+
+	return true;
+}
+
+void ActuatorStage::stop(void)
+{
+	if ( !running() )
+		return;
+
+	bRunning = false;
+
+	if ( bOwnThread )
+		(void)pthread_join(sActuatorThread, NULL);
+
+	if ( bDebug )
+		(void)printf("Actuator stage stopped: %u frames, %u applied, %u replaced, %u late, %" PRId64 " ns worst latency.\n",
+			getFrames(), getApplies(), getReplaced(), getLate(), getMaxLatencyNs());
+}
+
+void ActuatorStage::post(const E_ACTUATOR_CHANNELS e, const double_t dValue)
+{
+	if ( ( 0 > e ) || ( NUM_ACTUATOR_CHANNELS <= e ) )
+		return;
+
+	ActuatorCommand command;
+
+	(void)memset(&command, 0, sizeof(command));
+
+	command.dValue		= dValue;
+	command.iPostedNs	= Servo::timestampNow();
+	command.uSequence	= ++auPosts[e];
+
+	mailboxes[e].write(command);
+}
+
+bool ActuatorStage::getPosted(const E_ACTUATOR_CHANNELS e, ActuatorCommand &command)
+{
+	if ( ( 0 > e ) || ( NUM_ACTUATOR_CHANNELS <= e ) || ( 0 == mailboxes[e].writes() ) )
+		return false;
+
+	mailboxes[e].read(command);
+
+	return true;
+}
+
+bool ActuatorStage::getApplied(const E_ACTUATOR_CHANNELS e, ActuatorApplied &applied)
+{
+	if ( ( 0 > e ) || ( NUM_ACTUATOR_CHANNELS <= e ) || ( 0 == appliedCommands[e].writes() ) )
+		return false;
+
+	appliedCommands[e].read(applied);
+
+	return true;
+}
+
+void ActuatorStage::setShaping(const E_ACTUATOR_CHANNELS e, const bool bShape)
+{
+	if ( ( 0 > e ) || ( NUM_ACTUATOR_CHANNELS <= e ) || running() )
+		return;
+
+	abShaped[e] = bShape;
+}
+
+void *ActuatorStage::actuatorBackground(void *pContext)
+{
+	ActuatorStage *pThis = (ActuatorStage *)pContext;
+	pThis->actuate();
+	return NULL;
+}
+
+static void addNanoseconds(struct timespec &t, const int64_t iNs)
+{
+	int64_t iTotal = (int64_t)t.tv_nsec + iNs;
+
+	t.tv_sec += (time_t)( iTotal / 1000000000LL );
+	t.tv_nsec = (long)( iTotal % 1000000000LL );
+}
+
+static int64_t differenceNanoseconds(const struct timespec &a, const struct timespec &b)
+{
+	return ( (int64_t)( a.tv_sec - b.tv_sec ) * 1000000000LL ) + ( a.tv_nsec - b.tv_nsec );
+}
+
+void ActuatorStage::apply(const E_ACTUATOR_CHANNELS e, const double_t dValue)
+{
+	switch ( e )
+	{
+		case E_ACTUATOR_PITCH:
+			if ( NULL != pGimbal )
+				pGimbal->writeAngleDegrees(E_PITCH_AXIS, dValue);
+			break;
+
+		case E_ACTUATOR_YAW:
+			if ( NULL != pGimbal )
+				pGimbal->writeAngleDegrees(E_YAW_AXIS, dValue);
+			break;
+
+		case E_ACTUATOR_THROTTLE:
+			if ( NULL != pJet )
+				pJet->throttle(dValue);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void ActuatorStage::actuate(void)
+{
+	struct timespec deadline, now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+	while ( running() )
+	{
+		addNanoseconds(deadline, iPeriodNs);
+
+		while ( EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) )
+			;
+
+		frame();
+
+		(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+		int64_t iLateNs = differenceNanoseconds(now, deadline);
+
+		if ( iLateNs > iPeriodNs )
+		{
+			// Skip the frames that already went by; the servos only show the newest anyway.
+			uLate++;
+			addNanoseconds(deadline, ( iLateNs / iPeriodNs ) * iPeriodNs);
+		}
+	}
+}
+
+void ActuatorStage::frame(void)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	const int64_t iFrameNs = ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec;
+
+	ActuatorCommand commands[NUM_ACTUATOR_CHANNELS];
+	double_t adOutputs[NUM_ACTUATOR_CHANNELS];
+	bool abPending[NUM_ACTUATOR_CHANNELS], abNew[NUM_ACTUATOR_CHANNELS];
+	bool bAny = false;
+
+	// Only the newest command on each channel goes out.
+	for ( int32_t i = 0 ; i < NUM_ACTUATOR_CHANNELS ; i++ )
+	{
+		abPending[i] = abNew[i] = false;
+
+		if ( 0 == mailboxes[i].writes() )
+			continue;
+
+		mailboxes[i].read(commands[i]);
+
+		if ( commands[i].uSequence != auApplied[i] )
+		{
+			uReplaced += commands[i].uSequence - auApplied[i] - 1;
+			auApplied[i] = commands[i].uSequence;
+			abNew[i] = true;
+
+			if ( abShaped[i] )
+				shapers[i].setTarget(commands[i].dValue, iFrameNs);
+		}
+
+		// A shaped channel keeps moving, a frame at a time, until it gets there.
+		if ( abShaped[i] && ( abNew[i] || !shapers[i].settled() ) )
+			adOutputs[i] = shapers[i].step(iFrameNs);
+		else if ( abNew[i] )
+			adOutputs[i] = commands[i].dValue;
+		else
+			continue;
+
+		apply((E_ACTUATOR_CHANNELS)i, adOutputs[i]);
+
+		abPending[i] = bAny = true;
+	}
+
+	if ( bAny && ( NULL != pBackend ) && !pBackend->flush() && bDebug )
+		(void)printf("%s: unable to flush \"%s;\" the next frame retries.\n", __FUNCTION__, pBackend->getName());
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	const int64_t iAppliedNs = ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec;
+
+	for ( int32_t i = 0 ; i < NUM_ACTUATOR_CHANNELS ; i++ )
+	{
+		if ( !abPending[i] )
+			continue;
+
+		ActuatorApplied applied;
+
+		applied.dValue		= commands[i].dValue;
+		applied.dOutput		= adOutputs[i];
+		applied.iPostedNs	= commands[i].iPostedNs;
+		applied.iAppliedNs	= iAppliedNs;
+		applied.uSequence	= commands[i].uSequence;
+
+		appliedCommands[i].write(applied);
+
+		if ( !abNew[i] )
+			continue;
+
+		uApplies++;
+
+		latency.record(iAppliedNs - applied.iPostedNs);
+
+		if ( ( iAppliedNs - applied.iPostedNs ) > getMaxLatencyNs() )
+			iMaxLatencyNs = iAppliedNs - applied.iPostedNs;
+	}
+
+	uFrames++;
+}
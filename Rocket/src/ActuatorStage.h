@@ -0,0 +1,191 @@
+/*
+	ActuatorStage.h - Actuator output thread with latest-wins command mailboxes for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	Writing the gimbal servos and the ESC from the control loop puts the PWM I/O (a sysfs
+	write each, or an I2C transaction) in the loop's compute time. Here the control loop
+	posts each command to its channel's mailbox, which returns at once, and a thread applies
+	the newest command on each channel once per servo frame (SERVO_PERIOD_WIDTH, 400 Hz).
+	A command posted twice in a frame replaces the first; the servos can't show both.
+
+	Each mailbox is a SeqLock, one writer per channel: the control loop posts pitch and yaw,
+	and whoever throttles posts the throttle. After a frame's writes, and the backend's
+	flush() if one is given, the thread records when each command reached the hardware,
+	for getApplied().
+
+	The gimbal channels go through an OutputShaper, which spreads each control command over
+	the frames up to the next, within its slew and acceleration limits, so the nozzle
+	moves smoothly instead of in a step per command. The throttle goes out as posted
+	unless shaping is turned on for it.
+
+	While the thread runs, it owns the gimbal and the jet; post to them, don't write them.
+
+*/
+
+#ifndef _ACTUATOR_STAGE_H
+#define _ACTUATOR_STAGE_H
+
+#include <pthread.h>
+#include <atomic>
+#include "K_9_TVC_Gimbal_Generation_2.h"
+#include "Jet.h"
+#include "PwmBackend.h"
+#include "OutputShaper.h"
+#include "SeqLock.h"
+#include "LatencyHistogram.h"
+
+#define ACTUATOR_STAGE_VERSION	1     		// software version of this library
+
+typedef enum
+{
+	E_ACTUATOR_PITCH		= 0,			// Gimbal degrees.
+	E_ACTUATOR_YAW			= 1,			// Gimbal degrees.
+	E_ACTUATOR_THROTTLE		= 2,			// Jet throttle position.
+
+	NUM_ACTUATOR_CHANNELS	= 3
+
+} E_ACTUATOR_CHANNELS;
+
+typedef struct sActuatorCommand
+{
+	double_t dValue;
+	int64_t iPostedNs;						// CLOCK_MONOTONIC.
+	uint32_t uSequence;						// Counts posts on this channel, from one.
+} ActuatorCommand;
+
+typedef struct sActuatorApplied
+{
+	double_t dValue;						// The command,
+	double_t dOutput;						//	and what the last frame wrote on its way there.
+	int64_t iPostedNs;
+	int64_t iAppliedNs;						// When the last write (and flush) returned.
+	uint32_t uSequence;						// The command's; zero until one is applied.
+} ActuatorApplied;
+
+class ActuatorStage
+{
+public:
+	// Given a backend, e.g., a PCA9685 with auto-flush off, the stage flushes it once a
+	//	frame, so the frame's writes go out together.
+	ActuatorStage(K9TvcGimbal *pGimbal, Jet *pJet, PwmBackend *pBackend = NULL,
+		const int64_t iPeriodNs = SERVO_PERIOD_WIDTH);
+	~ActuatorStage();
+
+	// Without its own thread, the caller runs frame() once a frame, e.g., from an Executive
+	//	rate group at the servo frame rate.
+	bool start(const bool bOwnThread = true);
+	void stop(void);
+
+	// One frame: apply the newest commands; only while running, and only from one thread.
+	void frame(void);
+
+	inline bool running(void)
+	{
+		return bRunning.load(std::memory_order_relaxed);
+	}
+
+	// Returns at once; the command goes out at the next frame unless another replaces it.
+	void post(const E_ACTUATOR_CHANNELS e, const double_t dValue);
+
+	// The last command posted; false if there's none.
+	bool getPosted(const E_ACTUATOR_CHANNELS e, ActuatorCommand &command);
+
+	// The last command applied, and when; false until one is.
+	bool getApplied(const E_ACTUATOR_CHANNELS e, ActuatorApplied &applied);
+
+	// Set these up before start(); the thread owns the shapers while it runs.
+	void setShaping(const E_ACTUATOR_CHANNELS e, const bool bShape);
+
+	inline bool getShaping(const E_ACTUATOR_CHANNELS e)
+	{
+		return abShaped[e];
+	}
+
+	inline OutputShaper &getShaper(const E_ACTUATOR_CHANNELS e)
+	{
+		return shapers[e];
+	}
+
+	inline uint32_t getFrames(void)
+	{
+		return uFrames.load(std::memory_order_relaxed);
+	}
+
+	// Commands written to the hardware.
+	inline uint32_t getApplies(void)
+	{
+		return uApplies.load(std::memory_order_relaxed);
+	}
+
+	// Commands a newer one replaced before a frame could apply them.
+	inline uint32_t getReplaced(void)
+	{
+		return uReplaced.load(std::memory_order_relaxed);
+	}
+
+	// Frames that started more than a period late; only counted on its own thread.
+	inline uint32_t getLate(void)
+	{
+		return uLate.load(std::memory_order_relaxed);
+	}
+
+	// The longest time from a post to its first write, in nanoseconds.
+	inline int64_t getMaxLatencyNs(void)
+	{
+		return iMaxLatencyNs.load(std::memory_order_relaxed);
+	}
+
+	// Every command's time from its post to its first write; kept across stop() and start().
+	inline LatencyHistogram &getLatency(void)
+	{
+		return latency;
+	}
+
+private:
+	K9TvcGimbal *pGimbal;
+	Jet *pJet;
+	PwmBackend *pBackend;
+
+	int64_t iPeriodNs;
+
+	SeqLock<ActuatorCommand> mailboxes[NUM_ACTUATOR_CHANNELS];
+	SeqLock<ActuatorApplied> appliedCommands[NUM_ACTUATOR_CHANNELS];
+
+	uint32_t auPosts[NUM_ACTUATOR_CHANNELS];		// Each channel's poster's own count.
+	uint32_t auApplied[NUM_ACTUATOR_CHANNELS];		// The thread's; the last sequence applied.
+
+	OutputShaper shapers[NUM_ACTUATOR_CHANNELS];
+	bool abShaped[NUM_ACTUATOR_CHANNELS];
+
+	std::atomic<bool> bRunning;
+	bool bOwnThread;
+	std::atomic<uint32_t> uFrames, uApplies, uReplaced, uLate;
+	std::atomic<int64_t> iMaxLatencyNs;
+
+	LatencyHistogram latency;
+
+	pthread_t sActuatorThread;
+
+	static const bool bDebug;
+
+	static void *actuatorBackground(void *pContext);
+	void actuate(void);
+	void apply(const E_ACTUATOR_CHANNELS e, const double_t dValue);
+};
+
+#endif	// _ACTUATOR_STAGE_H
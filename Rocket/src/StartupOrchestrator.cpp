@@ -0,0 +1,251 @@
+/*
+	StartupOrchestrator.cpp - Concurrent device start up with a timeline for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "StartupOrchestrator.h"
+
+const bool StartupOrchestrator::bDebug = false;
+
+const int32_t StartupOrchestrator::MAX_TASKS;
+
+StartupOrchestrator::StartupOrchestrator() :
+	nTasks(0), uFinished(0), iOriginNs(0), iFinishNs(0), bRan(false)
+{
+	(void)memset(tasks, 0, sizeof(tasks));
+	(void)memset(records, 0, sizeof(records));
+
+	(void)pthread_mutex_init(&sMutex, NULL);
+	(void)pthread_cond_init(&sFinished, NULL);
+
+	iOriginNs = processStartNs();
+}
+
+StartupOrchestrator::~StartupOrchestrator()
+{
+	(void)pthread_cond_destroy(&sFinished);
+	(void)pthread_mutex_destroy(&sMutex);
+}
+
+int64_t StartupOrchestrator::timestampNow(void)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_BOOTTIME, &now);
+
+	return ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec;
+}
+
+int64_t StartupOrchestrator::processStartNs(void)
+{
+	FILE *pFile = fopen("/proc/self/stat", "r");
+
+	char achStat[1024];
+
+	size_t uLength = 0;
+
+	if ( NULL != pFile )
+	{
+		uLength = fread(achStat, 1, sizeof(achStat) - 1, pFile);
+		(void)fclose(pFile);
+	}
+
+	achStat[uLength] = '\0';
+
+	// The name, in parentheses, can have spaces; the start time is the 20th field after it.
+	char *pField = strrchr(achStat, ')');
+
+	for ( int32_t i = 0 ; ( NULL != pField ) && ( i < 20 ) ; i++ )
+		pField = strchr(pField + 1, ' ');
+
+	const long lTicksPerSecond = sysconf(_SC_CLK_TCK);
+
+	if ( ( NULL == pField ) || ( 0 >= lTicksPerSecond ) )
+		return timestampNow();				// From here, then.
+
+	const unsigned long long uTicks = strtoull(pField + 1, NULL, 10);
+
+	return (int64_t)( ( uTicks / lTicksPerSecond ) * 1000000000ULL ) +
+		(int64_t)( ( uTicks % lTicksPerSecond ) * 1000000000ULL / lTicksPerSecond );
+}
+
+int64_t StartupOrchestrator::sinceStart(void)
+{
+	return timestampNow() - iOriginNs;
+}
+
+int32_t StartupOrchestrator::addTask(const char *pName, StartupFunction pFunction, void *pContext, const uint32_t uFollows /*= 0*/)
+{
+	if ( ( MAX_TASKS <= nTasks ) || bRan || ( NULL == pFunction ) )
+		return -1;
+
+	StartupTask &task = tasks[nTasks];
+
+	task.pFunction		= pFunction;
+	task.pContext		= pContext;
+	task.uFollows		= uFollows;
+	task.pOrchestrator	= this;
+	task.iIndex			= nTasks;
+
+	(void)strncpy(records[nTasks].achName, ( NULL != pName ) ? pName : "", sizeof(records[nTasks].achName) - 1);
+
+	return nTasks++;
+}
+
+void *StartupOrchestrator::taskBackground(void *pContext)
+{
+	StartupTask *pTask = (StartupTask *)pContext;
+	StartupOrchestrator *pThis = pTask->pOrchestrator;
+	StartupRecord &record = pThis->records[pTask->iIndex];
+
+	record.iStartNs		= pThis->sinceStart();
+	record.bSucceeded	= pTask->pFunction(pTask->pContext);
+	record.iFinishNs	= pThis->sinceStart();
+
+	(void)pthread_mutex_lock(&pThis->sMutex);
+	pThis->uFinished |= ( 1u << pTask->iIndex );
+	pTask->bFinished = true;
+	(void)pthread_cond_signal(&pThis->sFinished);
+	(void)pthread_mutex_unlock(&pThis->sMutex);
+
+	return NULL;
+}
+
+bool StartupOrchestrator::run(void)
+{
+	if ( bRan )
+		return false;
+
+	bRan = true;
+
+	const uint32_t uAll = ( 1u << nTasks ) - 1;			// MAX_TASKS is well under 32.
+
+	(void)pthread_mutex_lock(&sMutex);
+
+	while ( uAll != uFinished )
+	{
+		bool bRunning = false;
+
+		for ( int32_t i = 0 ; i < nTasks ; i++ )
+		{
+			StartupTask &task = tasks[i];
+
+			if ( task.bStarted )
+			{
+				bRunning = bRunning || !task.bFinished;
+				continue;
+			}
+			else if ( ( task.uFollows & uFinished ) != task.uFollows )
+				continue;
+
+			else
+				;
+
+			task.bStarted = true;
+			records[i].iReadyNs = sinceStart();
+
+			int32_t iRet = pthread_create(&task.sThread, NULL, taskBackground, (void *)&task);
+
+			if ( 0 != iRet )
+			{
+				(void)fprintf(stderr, "%s: thread creation error for \"%s!\"\n\t\"%s\"", __FUNCTION__, records[i].achName, strerror(iRet));
+
+				// Bring it up here instead; it just doesn't overlap the rest.
+				(void)pthread_mutex_unlock(&sMutex);
+				records[i].iStartNs		= sinceStart();
+				records[i].bSucceeded	= task.pFunction(task.pContext);
+				records[i].iFinishNs	= sinceStart();
+				(void)pthread_mutex_lock(&sMutex);
+
+				task.bFinished = true;		// Still started, so it isn't launched again; nothing to join.
+				uFinished |= ( 1u << i );
+				continue;
+			}
+			else if ( bDebug )
+				(void)printf("Started \"%s.\"\n", records[i].achName);
+			else
+				;
+
+			task.bJoinable = true;
+			bRunning = true;
+		}
+
+		if ( uAll == uFinished )
+			break;
+
+		// Nothing running and nothing ready: what's left follows a task that doesn't exist.
+		else if ( !bRunning )
+		{
+			for ( int32_t i = 0 ; i < nTasks ; i++ )
+				if ( !tasks[i].bFinished )
+				{
+					(void)printf("%s: \"%s\" follows a task that never runs; skipped.\n", __FUNCTION__, records[i].achName);
+					tasks[i].bFinished = true, records[i].bSucceeded = false;
+					uFinished |= ( 1u << i );
+				}
+			break;
+		}
+		else
+			(void)pthread_cond_wait(&sFinished, &sMutex);
+	}
+
+	(void)pthread_mutex_unlock(&sMutex);
+
+	bool bSucceeded = true;
+
+	for ( int32_t i = 0 ; i < nTasks ; i++ )
+	{
+		if ( tasks[i].bJoinable )
+			(void)pthread_join(tasks[i].sThread, NULL);
+
+		bSucceeded = bSucceeded && records[i].bSucceeded;
+	}
+
+	iFinishNs = sinceStart();
+
+	return bSucceeded;
+}
+
+bool StartupOrchestrator::getRecord(const int32_t iTask, StartupRecord &record)
+{
+	if ( ( 0 > iTask ) || ( nTasks <= iTask ) )
+		return false;
+
+	record = records[iTask];
+
+	return true;
+}
+
+void StartupOrchestrator::printTimeline(FILE *pFile /*= stdout*/)
+{
+	(void)fprintf(pFile, "Start up, in milliseconds since the process started:\n");
+	(void)fprintf(pFile, "\t%-20s %8s %8s %8s %8s\n", "device", "ready", "start", "finish", "took");
+
+	for ( int32_t i = 0 ; i < nTasks ; i++ )
+		(void)fprintf(pFile, "\t%-20s %8.1lf %8.1lf %8.1lf %8.1lf%s\n", records[i].achName,
+			records[i].iReadyNs * 1e-6, records[i].iStartNs * 1e-6, records[i].iFinishNs * 1e-6,
+			( records[i].iFinishNs - records[i].iStartNs ) * 1e-6, records[i].bSucceeded ? "" : " failed");
+
+	(void)fprintf(pFile, "\tall done at %.1lf ms.\n", iFinishNs * 1e-6);
+}
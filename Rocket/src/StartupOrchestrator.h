@@ -0,0 +1,121 @@
+/*
+	StartupOrchestrator.h - Concurrent device start up with a timeline for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+	Each device's constructor blocks: the BMP180's first conversions, the BNO055's
+	profile check (or a second of calibration), each servo's sysfs export. One after
+	another they add up; but they're on different buses and drivers, so most of them
+	can wait at the same time. Each is added as a task, with the tasks it has to follow;
+	run() starts every task as soon as the ones it follows finish, each on its own
+	thread, and returns when all of them have.
+
+	Each task's start and finish go in a timeline, in nanoseconds since the process
+	started (to the kernel's clock tick), so printTimeline() shows where the time to the
+	first control tick goes.
+
+*/
+
+#ifndef _STARTUP_ORCHESTRATOR_H
+#define _STARTUP_ORCHESTRATOR_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include <inttypes.h>
+
+#define STARTUP_ORCHESTRATOR_VERSION	1 	// software version of this library
+
+// Returns false if the device didn't come up; the tasks that follow it still run.
+typedef bool (*StartupFunction)(void *pContext);
+
+typedef struct sStartupRecord
+{
+	char achName[32];
+	int64_t iReadyNs;						// When the tasks it follows had finished,
+	int64_t iStartNs;						//	when its thread started,
+	int64_t iFinishNs;						//	and when it returned; since the process started.
+	bool bSucceeded;
+} StartupRecord;
+
+class StartupOrchestrator
+{
+public:
+	StartupOrchestrator();
+	~StartupOrchestrator();
+
+	// Returns the task's number, for the uFollows masks of the ones after it (bit n for
+	//	task n), or negative if there are already MAX_TASKS.
+	int32_t addTask(const char *pName, StartupFunction pFunction, void *pContext, const uint32_t uFollows = 0);
+
+	// Runs every task; true if they all succeeded. Only once.
+	bool run(void);
+
+	inline int32_t getTasks(void)
+	{
+		return nTasks;
+	}
+
+	bool getRecord(const int32_t iTask, StartupRecord &record);
+
+	// From the process start to the end of run().
+	inline int64_t getFinishNs(void)
+	{
+		return iFinishNs;
+	}
+
+	void printTimeline(FILE *pFile = stdout);
+
+	// CLOCK_BOOTTIME, the clock the kernel keeps the process start time in.
+	static int64_t timestampNow(void);
+
+	// When the process started, in CLOCK_BOOTTIME nanoseconds.
+	static int64_t processStartNs(void);
+
+	static const int32_t MAX_TASKS = 16;
+
+private:
+	typedef struct sStartupTask
+	{
+		StartupFunction pFunction;
+		void *pContext;
+		uint32_t uFollows;
+		bool bStarted, bFinished;
+		bool bJoinable;					// It ran on its own thread.
+		pthread_t sThread;
+		StartupOrchestrator *pOrchestrator;
+		int32_t iIndex;
+	} StartupTask;
+
+	StartupTask tasks[MAX_TASKS];
+	StartupRecord records[MAX_TASKS];
+	int32_t nTasks;
+
+	uint32_t uFinished;						// A bit per finished task; guarded by sMutex.
+	int64_t iOriginNs;
+	int64_t iFinishNs;
+	bool bRan;
+
+	pthread_mutex_t sMutex;
+	pthread_cond_t sFinished;
+
+	static const bool bDebug;
+
+	static void *taskBackground(void *pContext);
+	int64_t sinceStart(void);
+};
+
+#endif	// _STARTUP_ORCHESTRATOR_H
@@ -22,33 +22,113 @@
 // Todo: update this:
 const double_t Rockhopper::ROCKHOPPER_MASS = 500;   // g
 
+const char *Rockhopper::pLatencyItemNames[NUM_LATENCY_ITEMS] =
+{
+    "control jitter p99",
+    "imu age p99",
+    "control p99",
+    "post p99",
+    "post to servo p99",
+    "control lateness p99"
+};
+
 Rockhopper::Rockhopper(const char *RockhopperName /*= "rockhopper. a simulated rocket with an EDF."*/) :
-    Rocket(RockhopperName), pressureSensor(NULL), orientationSensor(NULL), canineGimbal(NULL),
-    controlSystem(NULL), rocketEDF(NULL), stdoutTelemetry(NULL)
+    Rocket(RockhopperName), pressureSensor(NULL), orientationSensor(NULL), imuAcquisition(NULL), barometerAcquisition(NULL), actuatorStage(NULL), canineGimbal(NULL),
+    controlSystem(NULL), rocketEDF(NULL), stdoutTelemetry(NULL), uLastControlSequence(0), iControlGroup(-1),
+    controlJitter("control jitter"), imuAge("imu age"), controlCompute("control"), outputPost("post"), iLastStepNs(0)
 {
     dRocketMass         = ROCKHOPPER_MASS;
 
-    pressureSensor      = new BMP180(BMP180_ULTRA_HIGH_RES);
-    orientationSensor   = new BNO055();
-    canineGimbal        = new K9TvcGimbal();
+    (void)memset(&triggerSample, 0, sizeof(triggerSample));
+
+    (void)pthread_mutex_init(&imuSensorMutex, NULL);
+    (void)pthread_mutex_init(&barometerSensorMutex, NULL);
+
+#ifdef  _CASCADED_CONTROL
+    controlSystem       = new CascadedControl();
+#else
     controlSystem       = new RockHopperControl();
-    rocketEDF           = new DoBoFo70Pro12(E_JET_0, E_PWM_2);
+#endif
     stdoutTelemetry     = new Telemetry();
     locationGPS         = new GPS("GoouuTech (Beffkkip) GT-U7 Ublox NEO-6M GPS", E_GPS_NUM_0); 
 
+    for ( int32_t i = 0 ; i < NUM_LATENCY_ITEMS ; i++ )
+        stdoutTelemetry->writeItemValueHeader(pLatencyItemNames[i], "us", i);
+
+    // The sensors and the servos are on different buses; bring them up at once.
+    (void)startup.addTask("barometer", startBarometer, (void *)this);
+    (void)startup.addTask("imu", startImu, (void *)this);
+    (void)startup.addTask("actuators", startActuators, (void *)this);
+
+    if ( !startup.run() )
+        (void)printf("%s: not every device came up; see the start up timeline.\n", __FUNCTION__);
+
+    if ( bDebug )
+        startup.printTimeline();
+
     (void)memset(&scalibratePressureThread, 0, sizeof(pthread_t));
     (void)memset(&sCalibrateImuThread, 0, sizeof(pthread_t));    
+    (void)memset(&lastBarometerSample, 0, sizeof(lastBarometerSample));
 
     setFeedback(E_FEEDBACK_OFF);
     update();
 
 }
 
+bool Rockhopper::startBarometer(void *pContext)
+{
+    Rockhopper *pThis = (Rockhopper *)pContext;
+
+    pThis->pressureSensor       = new BMP180(BMP180_ULTRA_HIGH_RES);
+    pThis->barometerAcquisition = new BarometerAcquisition(pThis->pressureSensor);
+
+    return '\0' != pThis->pressureSensor->getName()[0];
+}
+
+bool Rockhopper::startImu(void *pContext)
+{
+    Rockhopper *pThis = (Rockhopper *)pContext;
+
+    pThis->orientationSensor    = new BNO055();
+    pThis->imuAcquisition       = new ImuAcquisition(pThis->orientationSensor);
+
+    // The control's attitude and rates, and the UI's accelerations; over sysfs, 9 reads a
+    //  sample rather than 22.
+    pThis->orientationSensor->setSampleChannels(E_SAMPLE_GYROSCOPE | E_SAMPLE_ACCELERATION | E_SAMPLE_ORIENTATION);
+
+    return '\0' != pThis->orientationSensor->getName()[0];
+}
+
+bool Rockhopper::startActuators(void *pContext)
+{
+    Rockhopper *pThis = (Rockhopper *)pContext;
+
+    // The servos share the PWM chip and its period; one after another, on this task.
+    pThis->canineGimbal         = new K9TvcGimbal();
+    pThis->rocketEDF            = new DoBoFo70Pro12(E_JET_0, E_PWM_2);
+    pThis->actuatorStage        = new ActuatorStage(pThis->canineGimbal, pThis->rocketEDF);
+
+    // Spread each control output over the PWM frames until the next one.
+    pThis->actuatorStage->getShaper(E_ACTUATOR_PITCH).setInterpolationTime(pThis->controlSystem->getSampleTime());
+    pThis->actuatorStage->getShaper(E_ACTUATOR_YAW).setInterpolationTime(pThis->controlSystem->getSampleTime());
+
+    return true;
+}
+
 Rockhopper::~Rockhopper()
 {
+    // The gimbal goes back to center with direct writes, so the stage has to stop first.
+    executive.stop();
+
+    printLatency();
+
+    delete actuatorStage, actuatorStage = NULL;
+
     setFeedback(E_FEEDBACK_OFF);
     update();    
 
+    delete imuAcquisition, imuAcquisition = NULL;
+    delete barometerAcquisition, barometerAcquisition = NULL;
     delete pressureSensor, pressureSensor = NULL;
     delete orientationSensor, orientationSensor = NULL;
     delete canineGimbal, canineGimbal = NULL;
@@ -57,19 +137,87 @@ Rockhopper::~Rockhopper()
     delete stdoutTelemetry, stdoutTelemetry = NULL;
     delete locationGPS, locationGPS = NULL;
 
+    (void)pthread_mutex_destroy(&imuSensorMutex);
+    (void)pthread_mutex_destroy(&barometerSensorMutex);
+
 }
 
 double_t Rockhopper::getTemperature(void)
 {
-    return pressureSensor->readTemperature();
+    // The last sample also while a calibration has the sensor.
+    if ( barometerAcquisition->running() || ( 0 != pthread_mutex_trylock(&barometerSensorMutex) ) )
+    {
+        (void)barometerAcquisition->getLatest(lastBarometerSample);
+        return lastBarometerSample.dTemperature;
+    }
+
+    const double_t d = pressureSensor->readTemperature();
+
+    (void)pthread_mutex_unlock(&barometerSensorMutex);
+    return d;
 }
 double_t Rockhopper::getPressure(void)
 {
-    return pressureSensor->readPressure();
+    // The last sample also while a calibration has the sensor.
+    if ( barometerAcquisition->running() || ( 0 != pthread_mutex_trylock(&barometerSensorMutex) ) )
+    {
+        (void)barometerAcquisition->getLatest(lastBarometerSample);
+        return lastBarometerSample.dPressure;
+    }
+
+    const double_t d = pressureSensor->readPressure();
+
+    (void)pthread_mutex_unlock(&barometerSensorMutex);
+    return d;
 }
 double_t Rockhopper::getAltitude(void)
 {
-    return pressureSensor->readAltitude();
+    // The last estimate or sample also while a calibration has the sensor.
+    if ( barometerAcquisition->running() || ( 0 != pthread_mutex_trylock(&barometerSensorMutex) ) )
+    {
+        AltitudeEstimate estimate;
+
+        if ( barometerAcquisition->getEstimate(estimate) )
+            return estimate.dAltitude;
+
+        (void)barometerAcquisition->getLatest(lastBarometerSample);
+        return lastBarometerSample.dAltitude;
+    }
+
+    const double_t d = pressureSensor->readAltitude();
+
+    (void)pthread_mutex_unlock(&barometerSensorMutex);
+    return d;
+}
+
+bool Rockhopper::getAltitudeEstimate(AltitudeEstimate &estimate)
+{
+    return barometerAcquisition->running() && barometerAcquisition->getEstimate(estimate);
+}
+
+double_t Rockhopper::getVerticalSpeed(void)
+{
+    AltitudeEstimate estimate;
+
+    return getAltitudeEstimate(estimate) ? estimate.dVerticalSpeed : 0.0;
+}
+
+void Rockhopper::getBarometerSample(BarometerSample &sample, int64_t &iAgeNs)
+{
+    if ( barometerAcquisition->running() || ( 0 != pthread_mutex_trylock(&barometerSensorMutex) ) )
+        (void)barometerAcquisition->getLatest(lastBarometerSample);
+    else
+    {
+        pressureSensor->readSample(lastBarometerSample);
+        (void)pthread_mutex_unlock(&barometerSensorMutex);
+    }
+
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    sample = lastBarometerSample;
+    iAgeNs = ( ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec ) - sample.iTimestampNs;
 }
 
 void Rockhopper::setOrientationDegrees(const double_t &dPitch, const double_t &dRoll, const double_t &dYaw)
@@ -84,8 +232,28 @@ void Rockhopper::getOrientationDegrees(double_t &dPitch, double_t &dRoll, double
 
 void Rockhopper::readOrientationDegrees(double_t &dPitch, double_t &dRoll, double_t &dYaw)
 {
-    double_t dP = 0.0, dR = 0.0, dY = 0.0;
-    orientationSensor->readOrientation(dP, dR, dY);
+    // The last published sample also while a calibration has the sensor.
+    if ( imuAcquisition->running() || ( 0 != pthread_mutex_trylock(&imuSensorMutex) ) )
+    {
+        ImuSample sample;
+
+        (void)memset(&sample, 0, sizeof(sample));
+        (void)imuAcquisition->getLatest(sample);
+
+        dPitch = sample.dOrientation[E_PITCH_AXIS], dRoll = sample.dOrientation[E_ROLL_AXIS], dYaw = sample.dOrientation[E_YAW_AXIS];
+    }
+    else
+    {
+        orientationSensor->readOrientation(dPitch, dRoll, dYaw);
+        (void)pthread_mutex_unlock(&imuSensorMutex);
+    }
+
+    mountOrientationDegrees(dPitch, dRoll, dYaw);
+}
+
+void Rockhopper::mountOrientationDegrees(double_t &dPitch, double_t &dRoll, double_t &dYaw)
+{
+    double_t dP = dPitch, dR = dRoll, dY = dYaw;
 
     // I don't know why pitch and roll and yaw need these.
 
@@ -119,8 +287,27 @@ void Rockhopper::readOrientationDegrees(double_t &dPitch, double_t &dRoll, doubl
 
 void Rockhopper::getAngularVelocities(double_t &x, double_t &y, double_t &z)
 {
-    double_t xX = 0.0, yY = 0.0, zZ = 0.0;
-    orientationSensor->readGyroscope(xX, yY, zZ);
+    if ( imuAcquisition->running() || ( 0 != pthread_mutex_trylock(&imuSensorMutex) ) )
+    {
+        ImuSample sample;
+
+        (void)memset(&sample, 0, sizeof(sample));
+        (void)imuAcquisition->getLatest(sample);
+
+        x = sample.dGyroscope[0], y = sample.dGyroscope[1], z = sample.dGyroscope[2];
+    }
+    else
+    {
+        orientationSensor->readGyroscope(x, y, z);
+        (void)pthread_mutex_unlock(&imuSensorMutex);
+    }
+
+    mountAngularVelocities(x, y, z);
+}
+
+void Rockhopper::mountAngularVelocities(double_t &x, double_t &y, double_t &z)
+{
+    double_t xX = x, yY = y, zZ = z;
     // 03/27/2024 BNO055 sensor facing up, servo connectors facing you.
     x = -xX, y = zZ, z = yY;
 }
@@ -161,10 +348,23 @@ void Rockhopper::getFeedback(E_FEEDBACK_MODE &e)
 
 void Rockhopper::throttle(double_t position /*= 0.0*/)
 {
-    rocketEDF->throttle(position);
+    // Any thrust may lift off; the pad's pressure is what it is from here on.
+    if ( 0.0 < position )
+        barometerAcquisition->freezeBaseline();
+
+    if ( ( NULL != actuatorStage ) && actuatorStage->running() )
+        actuatorStage->post(E_ACTUATOR_THROTTLE, position);
+    else
+        rocketEDF->throttle(position);
 }
 double_t Rockhopper::throttlePosition(void)
 {
+    ActuatorCommand command;
+
+    // The stage's thread owns the EDF; the last position posted is the one it's going to.
+    if ( ( NULL != actuatorStage ) && actuatorStage->running() && actuatorStage->getPosted(E_ACTUATOR_THROTTLE, command) )
+        return command.dValue;
+
     return rocketEDF->throttlePosition();
 }
 double_t Rockhopper::thrust(void)
@@ -173,33 +373,299 @@ double_t Rockhopper::thrust(void)
 }
 
 void Rockhopper::update(void)
+{
+    updateTelemetry();
+
+    // The executive's control group steps the loop while it runs.
+    if ( executive.running() )
+        return;
+
+    ImuSample sample;
+
+    (void)memset(&sample, 0, sizeof(sample));
+
+    // The attitude and the rates come from the same read.
+    const bool bNew = readImuSample(sample);
+
+    step(sample, bNew);
+}
+
+void Rockhopper::step(ImuSample &sample, const bool bNew)
 {
     double_t dPitch = 0.0, 
         dRoll       = 0.0, 
         dYaw        = 0.0;
 
-    double_t dPitchRate = 0.0, 
-        dRollRate       = 0.0, 
-        dYawRate        = 0.0;
+    const int64_t iStartNs = BNO055::timestampNow();
 
-    readOrientationDegrees(dPitch, dRoll, dYaw);
-    getAngularVelocities(dPitchRate, dRollRate, dYawRate);
+    if ( iLastStepNs )
+        controlJitter.record(llabs(( iStartNs - iLastStepNs ) - (int64_t)( controlSystem->getSampleTime() * 1e9 )));
 
-	controlSystem->SetInputAngleDegreesValues(dPitch, dRoll, dYaw);
-	controlSystem->SetInputAngularVelocityRadiansPerSecondValues(dPitchRate, dRollRate, dYawRate);
+    iLastStepNs = iStartNs;
 
-    controlSystem->update();
+    if ( bNew )
+    {
+        imuAge.record(iStartNs - sample.iTimestampNs);
+
+        mountOrientationDegrees(sample.dOrientation[E_PITCH_AXIS], sample.dOrientation[E_ROLL_AXIS], sample.dOrientation[E_YAW_AXIS]);
+        mountAngularVelocities(sample.dGyroscope[E_PITCH_AXIS], sample.dGyroscope[E_ROLL_AXIS], sample.dGyroscope[E_YAW_AXIS]);
+
+        // Steps by the time between the samples' timestamps; no new sample, no step.
+        controlSystem->update(sample);
+    }
 
     controlSystem->GetControlledOutputAngleDegreesValues(dPitch, dRoll, dYaw);
 
-    canineGimbal->writeAngleDegrees(E_PITCH_AXIS, dPitch);
-    canineGimbal->writeAngleDegrees(E_YAW_AXIS, dYaw);    
+    const int64_t iControlledNs = BNO055::timestampNow();
+
+    if ( bNew )
+        controlCompute.record(iControlledNs - iStartNs);
+
+    if ( ( NULL != actuatorStage ) && actuatorStage->running() )
+    {
+        actuatorStage->post(E_ACTUATOR_PITCH, dPitch);
+        actuatorStage->post(E_ACTUATOR_YAW, dYaw);
+    }
+    else
+    {
+        canineGimbal->writeAngleDegrees(E_PITCH_AXIS, dPitch);
+        canineGimbal->writeAngleDegrees(E_YAW_AXIS, dYaw);    
+    }
+
+    outputPost.record(BNO055::timestampNow() - iControlledNs);
+
+}
+
+void Rockhopper::printLatency(FILE *pFile /*= stderr*/)
+{
+    (void)fprintf(pFile, "Control loop latency:\n");
+
+    controlJitter.print(pFile);
+    imuAge.print(pFile);
+    controlCompute.print(pFile);
+    outputPost.print(pFile);
+
+    if ( NULL != actuatorStage )
+        actuatorStage->getLatency().print(pFile);
+
+    for ( int32_t i = 0 ; i < executive.getRateGroups() ; i++ )
+        executive.getLateness(i)->print(pFile);
+}
+
+void Rockhopper::updateTelemetry(void)
+{
+    if ( !stdoutTelemetry->getTelemetry() )
+        return;
+
+    LatencyHistogram *apHistograms[NUM_LATENCY_ITEMS] =
+    {
+        &controlJitter, &imuAge, &controlCompute, &outputPost,
+        ( NULL != actuatorStage ) ? &actuatorStage->getLatency() : NULL,    // NULL in the destructor.
+        executive.getLateness(iControlGroup)
+    };
+
+    for ( int32_t i = 0 ; i < NUM_LATENCY_ITEMS ; i++ )
+        stdoutTelemetry->writeItemValue(( NULL != apHistograms[i] ) ? apHistograms[i]->valueAtPercentile(99.0) * 1e-3 : 0.0, i);
+
+    stdoutTelemetry->update();
+}
+
+bool Rockhopper::imuTrigger(void *pContext, const int32_t iTimeoutMs, int64_t &iEventNs)
+{
+    Rockhopper *pThis = (Rockhopper *)pContext;
+
+    // A frame per control step: the first sample a sample time after the last frame's; the
+    //  IMU may sample faster than the control steps.
+    const int64_t iLastNs = pThis->triggerSample.iTimestampNs;
+    const int64_t iStepNs = (int64_t)( ( pThis->controlSystem->getSampleTime() - Control::SAMPLE_TIME_TOLERANCE ) * 1e9 );
+    const int64_t iDeadlineNs = BNO055::timestampNow() + ( (int64_t)iTimeoutMs * 1000000LL );
+
+    ImuSample sample;
+
+    do
+    {
+        const int64_t iRemainingMs = ( iDeadlineNs - BNO055::timestampNow() ) / 1000000LL;
+
+        if ( ( 0 >= iRemainingMs ) || !pThis->imuAcquisition->waitForSample(sample, (int32_t)iRemainingMs) )
+            return false;
+    }
+    while ( iLastNs && ( ( sample.iTimestampNs - iLastNs ) < iStepNs ) );
+
+    pThis->triggerSample = sample;
+
+    // The sample's time, on the executive's clock; the IMU's timestamps may be on another.
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    iEventNs = ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec - ( BNO055::timestampNow() - pThis->triggerSample.iTimestampNs );
+
+    return true;
+}
+
+void Rockhopper::controlTask(void *pContext)
+{
+    Rockhopper *pThis = (Rockhopper *)pContext;
+
+    // The trigger's sample; each frame starts on a new one, so the steps follow the samples.
+    ImuSample sample = pThis->triggerSample;
+
+    const bool bNew = ( sample.uSequence != pThis->uLastControlSequence ) && !BNO055::isStale(sample);
+
+    if ( bNew )
+        pThis->uLastControlSequence = sample.uSequence;
+
+    pThis->step(sample, bNew);
+}
+
+void Rockhopper::actuationTask(void *pContext)
+{
+    Rockhopper *pThis = (Rockhopper *)pContext;
+
+    pThis->actuatorStage->frame();
+}
 
+bool Rockhopper::startExecutive(void)
+{
+    if ( executive.running() )
+        return true;
+
+    // The groups are set up once; the executive keeps them across stop() and start().
+    if ( 0 == executive.getRateGroups() )
+    {
+        // The last core; the kernel and the UI keep to the others, e.g., with isolcpus=3.
+        const int32_t iCpu = (int32_t)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+
+        const int32_t iActuation = executive.addRateGroup("actuation", 1e9 / SERVO_PERIOD_WIDTH, iCpu);
+        iControlGroup = executive.addRateGroup("control", 1.0 / controlSystem->getSampleTime(), iCpu);
+
+        (void)executive.setTrigger(iControlGroup, imuTrigger, (void *)this);
+        (void)executive.addTask(iControlGroup, "control", controlTask, (void *)this);
+        (void)executive.addTask(iActuation, "actuation", actuationTask, (void *)this);
+    }
+
+    // The control group reads the samples the acquisition publishes, and the actuation
+    //  group runs the stage's frames in place of its thread.
+    if ( !startImuAcquisition() )
+        return false;
+
+    actuatorStage->stop();
+
+    if ( !actuatorStage->start(false) )
+        return false;
+
+    uLastControlSequence = 0;
+    (void)memset(&triggerSample, 0, sizeof(triggerSample));
+
+    if ( executive.start() )
+        return true;
+
+    actuatorStage->stop();
+    return false;
+}
+
+void Rockhopper::stopExecutive(void)
+{
+    if ( !executive.running() )
+        return;
+
+    executive.stop();
+
+    if ( bDebug )
+        executive.printStats();
+
+    // Back to the stage's own thread.
+    actuatorStage->stop();
+    (void)actuatorStage->start();
 }
 
 void Rockhopper::getAccelerations(double_t &x, double_t &y, double_t &z)
 {
-	orientationSensor->readAccelerations(x, y, z);
+    if ( imuAcquisition->running() || ( 0 != pthread_mutex_trylock(&imuSensorMutex) ) )
+    {
+        ImuSample sample;
+
+        (void)memset(&sample, 0, sizeof(sample));
+        (void)imuAcquisition->getLatest(sample);
+
+        x = sample.dAcceleration[0], y = sample.dAcceleration[1], z = sample.dAcceleration[2];
+    }
+    else
+    {
+	    orientationSensor->readAccelerations(x, y, z);
+        (void)pthread_mutex_unlock(&imuSensorMutex);
+    }
+}
+
+bool Rockhopper::readImuSample(ImuSample &sample)
+{
+    // Wake when the next sample lands rather than re-reading the last one; ignore old data.
+    if ( imuAcquisition->running() )
+        return imuAcquisition->waitForSample(sample, BNO055::STREAM_TIMEOUT_MS) && !BNO055::isStale(sample);
+
+    // No sample while a calibration has the sensor.
+    if ( 0 != pthread_mutex_trylock(&imuSensorMutex) )
+        return false;
+
+    const bool bRead = orientationSensor->readSample(sample, BNO055::STREAM_TIMEOUT_MS);
+
+    (void)pthread_mutex_unlock(&imuSensorMutex);
+    return bRead;
+}
+
+bool Rockhopper::startImuAcquisition(void)
+{
+    // Not while a calibration has the sensor; it restarts the acquisition when it's done.
+    if ( 0 != pthread_mutex_trylock(&imuSensorMutex) )
+        return imuAcquisition->running();
+
+    const bool bStarted = imuAcquisition->start();
+
+    (void)pthread_mutex_unlock(&imuSensorMutex);
+    return bStarted;
+}
+
+void Rockhopper::stopImuAcquisition(void)
+{
+    imuAcquisition->stop();
+}
+
+bool Rockhopper::startBarometerAcquisition(void)
+{
+    if ( barometerAcquisition->running() )
+        return true;
+
+    // Not while a calibration has the sensor; it restarts the acquisition when it's done.
+    if ( 0 != pthread_mutex_trylock(&barometerSensorMutex) )
+        return false;
+
+    // One blocking conversion, so the reads have a value until the worker's first.
+    pressureSensor->readSample(lastBarometerSample);
+
+    const bool bStarted = barometerAcquisition->start();
+
+    (void)pthread_mutex_unlock(&barometerSensorMutex);
+    return bStarted;
+}
+
+void Rockhopper::stopBarometerAcquisition(void)
+{
+    barometerAcquisition->stop();
+}
+
+bool Rockhopper::startActuatorStage(void)
+{
+    return actuatorStage->start();
+}
+
+void Rockhopper::stopActuatorStage(void)
+{
+    actuatorStage->stop();
+}
+
+bool Rockhopper::getActuatorApplied(const E_ACTUATOR_CHANNELS e, ActuatorApplied &applied)
+{
+    return actuatorStage->running() && actuatorStage->getApplied(e, applied);
 }
 
 void Rockhopper::calibrateSensors(void)
@@ -241,14 +707,45 @@ void Rockhopper::calibrateSensors(void)
 void *Rockhopper::calibratePressureSensorBackground( void *pContext )
 {
     Rockhopper *pThis = (Rockhopper *)pContext;
+    // The calibration reads the sensor itself; the worker and the direct reads have to
+    //  stand aside meanwhile, the reads returning the last sample.
+    (void)pthread_mutex_lock(&pThis->barometerSensorMutex);
+
+    const bool bAcquiring = pThis->barometerAcquisition->running();
+
+    pThis->barometerAcquisition->stop();
     pThis->pressureSensor->getOffsets(BMP180::NUMBER_OF_OFFSET_SAMPLES_FOR_FIVE_MINUTES, DEFAULT_PRESSURE, DEFAULT_ALTITUDE);
+    (void)pThis->pressureSensor->saveProfile();
+
+    // The new baseline is fresh; track it from here, on the pad.
+    pThis->barometerAcquisition->rearmBaseline();
+
+    if ( bAcquiring )
+        (void)pThis->barometerAcquisition->start();
+
+    (void)pthread_mutex_unlock(&pThis->barometerSensorMutex);
     return NULL;
 }
 
 void *Rockhopper::calibrateOrientationSensorBackground( void *pContext )
 {
     Rockhopper *pThis = (Rockhopper *)pContext;
+    // The acquisition thread owns the sensor while it runs; it and the direct reads have to
+    //  stand aside meanwhile, the reads returning the last published sample, or none.
+    (void)pthread_mutex_lock(&pThis->imuSensorMutex);
+
+    const bool bAcquiring = pThis->imuAcquisition->running();
+
+    pThis->imuAcquisition->stop();
+
+    // At most five minutes; it stops once the offsets converge, usually in a few seconds.
     pThis->orientationSensor->getOffsets(BNO055::NUMBER_OF_OFFSET_SAMPLES_FOR_FIVE_MINUTES);
+    (void)pThis->orientationSensor->saveProfile();
+
+    if ( bAcquiring )
+        (void)pThis->imuAcquisition->start();
+
+    (void)pthread_mutex_unlock(&pThis->imuSensorMutex);
     return NULL;
 }
 
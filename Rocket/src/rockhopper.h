@@ -25,8 +25,15 @@
 #include "Rocket.h"
 #include "BMP180.h"
 #include "BNO055.h"
+#include "ImuAcquisition.h"
+#include "BarometerAcquisition.h"
+#include "ActuatorStage.h"
+#include "StartupOrchestrator.h"
+#include "Executive.h"
+#include "LatencyHistogram.h"
 #include "K_9_TVC_Gimbal_Generation_2.h"
 #include "RockHopperControl.h"
+#include "CascadedControl.h"
 #include "DoBoFo70Pro12.h"
 #include "Gimbal.h"
 #include "Control.h"
@@ -36,6 +43,24 @@
 
 #define ROCKHOPPER_VERSION	1     			// the software version of this library
 
+// Fly the cascaded angle and rate control in place of RockHopperControl; it isn't tuned
+//  on the vehicle yet.
+//#define	_CASCADED_CONTROL
+
+// The latency telemetry items, 99th percentiles in microseconds; the Telemetry numbers.
+typedef enum
+{
+	E_LATENCY_ITEM_CONTROL_JITTER		= 0,
+	E_LATENCY_ITEM_IMU_AGE				= 1,
+	E_LATENCY_ITEM_CONTROL				= 2,
+	E_LATENCY_ITEM_POST					= 3,
+	E_LATENCY_ITEM_ACTUATION			= 4,
+	E_LATENCY_ITEM_CONTROL_LATENESS		= 5,
+
+	NUM_LATENCY_ITEMS					= 6
+
+} E_LATENCY_ITEMS;
+
 class Rockhopper : public Rocket
 {
 public:
@@ -90,19 +115,112 @@ public:
 
     virtual void update(void);
 
+    // Optional: sample the IMU in the background; update() and the read functions then
+    //  use the newest published sample instead of reading the sensor themselves.
+    virtual bool startImuAcquisition(void);
+    virtual void stopImuAcquisition(void);
+
+    // Optional: convert the barometer in the background, so the altitude, pressure, and
+    //  temperature reads return at once with the newest completed conversion.
+    virtual bool startBarometerAcquisition(void);
+    virtual void stopBarometerAcquisition(void);
+
+    // The newest barometer sample and how old it is (nanoseconds).
+    virtual void getBarometerSample(BarometerSample &sample, int64_t &iAgeNs);
+
+    // The barometer's filtered altitude, vertical speed, and apogee; only while the
+    //  background acquisition runs, else false. getAltitude() then returns the filtered one.
+    virtual bool getAltitudeEstimate(AltitudeEstimate &estimate);
+    virtual double_t getVerticalSpeed(void);
+
+    // Optional: write the gimbal and the EDF on their own thread at the servo frame rate;
+    //  update() and throttle() then post their commands and return at once.
+    virtual bool startActuatorStage(void);
+    virtual void stopActuatorStage(void);
+
+    // The last command on a channel to reach the hardware, and when; only while the stage runs.
+    virtual bool getActuatorApplied(const E_ACTUATOR_CHANNELS e, ActuatorApplied &applied);
+
+    // Optional: run the control loop on the IMU's samples at the control's rate (50 Hz; the
+    //  cascade's inner loop, 100 Hz) and the actuator stage's frames at the servos' rate
+    //  (400 Hz) in SCHED_FIFO rate groups; update() then does nothing.
+    //  Starts the IMU acquisition, which the control group reads.
+    virtual bool startExecutive(void);
+    virtual void stopExecutive(void);
+
+    inline Executive &getExecutive(void)
+    {
+        return executive;
+    }
+
+    // Each control tick's stages, always on: the period's jitter, the IMU sample's age when
+    //  the control gets it, the control law, posting (or writing) the outputs, and a post's
+    //  time to the servo; and how late the executive's groups wake. To stderr, so a flight's
+    //  log keeps it; also on shutdown.
+    virtual void printLatency(FILE *pFile = stderr);
+
+    // Sends the latency items' 99th percentiles while the telemetry is on; update() calls it.
+    virtual void updateTelemetry(void);
+
+    // When each device came up; the constructor brings them up concurrently.
+    inline StartupOrchestrator &getStartup(void)
+    {
+        return startup;
+    }
+
 protected:    
 
 private:
+    // A control step on a sample; a sample that isn't new just refreshes the outputs.
+    void step(ImuSample &sample, const bool bNew);
+
+    // The executive's tasks, and the control group's trigger: the IMU's samples.
+    static bool imuTrigger(void *pContext, const int32_t iTimeoutMs, int64_t &iEventNs);
+    static void controlTask(void *pContext);
+    static void actuationTask(void *pContext);
+
+    // The constructor's start up tasks.
+    static bool startBarometer(void *pContext);
+    static bool startImu(void *pContext);
+    static bool startActuators(void *pContext);
+
+    // From the BNO055's axes to the rocket's; see the dated notes for the mounting.
+    static void mountOrientationDegrees(double_t &dPitch, double_t &dRoll, double_t &dYaw);
+    static void mountAngularVelocities(double_t &x, double_t &y, double_t &z);
+
+    // From the acquisition thread when it runs; else straight from the sensor.
+    bool readImuSample(ImuSample &sample);
+
     BMP180 *pressureSensor;
     BNO055 *orientationSensor;
+    ImuAcquisition *imuAcquisition;
+    BarometerAcquisition *barometerAcquisition;
+    BarometerSample lastBarometerSample;
+    ActuatorStage *actuatorStage;
     K9TvcGimbal *canineGimbal;
-    RockHopperControl *controlSystem;
+    Control *controlSystem;
     DoBoFo70Pro12 *rocketEDF;
     Telemetry *stdoutTelemetry;
 	GPS *locationGPS;
 
+    StartupOrchestrator startup;
+    Executive executive;
+    ImuSample triggerSample;                // The control group's; the sample that started the frame,
+    uint32_t uLastControlSequence;          //  and the sample it last stepped on.
+    int32_t iControlGroup;
+
+    // Written by whichever thread steps the control: the executive's, else update()'s caller.
+    LatencyHistogram controlJitter, imuAge, controlCompute, outputPost;
+    int64_t iLastStepNs;
+
+    static const char *pLatencyItemNames[NUM_LATENCY_ITEMS];
+
 	pthread_t scalibratePressureThread, sCalibrateImuThread;
 
+    // Held by a calibration for as long as it reads its sensor; the direct reads only try
+    //  them, and give the last sample rather than wait.
+    pthread_mutex_t imuSensorMutex, barometerSensorMutex;
+
 };
 
 #endif // _ROCKHOPPER_H
@@ -0,0 +1,100 @@
+/*
+	MockPca9685.cpp - Exercise the i2c-dev PCA9685 driver without hardware.
+
+	A MockI2cBus stands in for "/dev/i2c-1" with a PCA9685's registers. Two Servos and an
+	ESC channel write through one PCA9685 with auto-flush off; the example checks the
+	prescaler, that one flush() sends all three channels in a single transaction, that an
+	unchanged channel sends nothing, and that the pulse widths read back.
+
+	Usage: MockPca9685
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "Servo.h"
+#include "PCA9685.h"
+#include "MockI2cBus.h"
+
+// The OFF count of a channel, from the mock's registers.
+static uint32_t offCounts(MockI2cBus &bus, const uint32_t uChannel)
+{
+	const uint8_t uRegister = PCA9685::LED0_ON_L_REGISTER + ( PCA9685::REGISTERS_PER_CHANNEL * uChannel );
+
+	return bus.getRegister(uRegister + 2) | ( ( bus.getRegister(uRegister + 3) & 0x0f ) << 8 );
+}
+
+static bool check(const char *pName, const uint32_t uValue, const uint32_t uExpected)
+{
+	if ( uValue == uExpected )
+		return true;
+
+	(void)printf("%s: expected %u, got %u.\n", pName, uExpected, uValue);
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	MockI2cBus bus(PCA9685_I2C_ADDRESS);
+
+	PCA9685 pwm(&bus);
+
+	if ( !pwm.open(SERVO_PERIOD_WIDTH) )
+		return 1;
+
+	// 25 MHz / ( 4096 * 400 Hz ) is 15.3; the prescaler is one less than that, rounded.
+	bool bGood = check("prescale", bus.getRegister(PCA9685::PRE_SCALE_REGISTER), 14);
+
+	bGood = check("mode 1", bus.getRegister(PCA9685::MODE1_REGISTER) & ~PCA9685::MODE1_RESTART,
+		PCA9685::MODE1_AUTO_INCREMENT | PCA9685::MODE1_ALLCALL) && bGood;
+
+	(void)printf("The period is %.0lf nanoseconds.\n", pwm.getPeriod());
+
+	pwm.setAutoFlush(false);
+
+	Servo pitch(E_PWM_0, &pwm), yaw(E_PWM_1, &pwm), esc(E_PWM_2, &pwm);
+
+	const uint32_t uTransfers = bus.getTransfers();
+
+	pitch.writePulseWidth(1200000);
+	yaw.writePulseWidth(1800000);
+	esc.writePulseWidth(1000000);
+
+	bGood = check("transfers before the flush", bus.getTransfers(), uTransfers) && bGood;
+
+	bGood = pwm.flush() && bGood;
+
+	bGood = check("transfers for three channels", bus.getTransfers(), uTransfers + 1) && bGood;
+
+	const double_t dCountsPerNanosecond = PCA9685::COUNTS / pwm.getPeriod();
+
+	bGood = check("pitch counts", offCounts(bus, 0), (uint32_t)( ( 1200000 * dCountsPerNanosecond ) + 0.5 )) && bGood;
+	bGood = check("yaw counts", offCounts(bus, 1), (uint32_t)( ( 1800000 * dCountsPerNanosecond ) + 0.5 )) && bGood;
+	bGood = check("ESC counts", offCounts(bus, 2), (uint32_t)( ( 1000000 * dCountsPerNanosecond ) + 0.5 )) && bGood;
+
+	// Within the servo's deadband, or the same count, nothing goes out.
+	pitch.writePulseWidth(1200100);
+
+	bGood = pwm.flush() && bGood;
+	bGood = check("transfers for no change", bus.getTransfers(), uTransfers + 1) && bGood;
+
+	// One count is about 600 nanoseconds; a read back is within half of one.
+	uint32_t uPulseWidth = yaw.readDevicePulseWidth();
+
+	bGood = check("yaw read back", ( fabs((double_t)uPulseWidth - 1800000.0) <= ( pwm.getPeriod() / PCA9685::COUNTS ) ) ? 1 : 0, 1) && bGood;
+
+	// A dead bus leaves the channel staged for the next flush().
+	bus.setFailing(true);
+	esc.writePulseWidth(1500000);
+	bGood = !pwm.flush() && bGood;
+	bus.setFailing(false);
+	bGood = pwm.flush() && check("ESC counts after a retry", offCounts(bus, 2), (uint32_t)( ( 1500000 * dCountsPerNanosecond ) + 0.5 )) && bGood;
+
+	(void)printf("%u transactions, %u errors.\n", pwm.getTransactions(), pwm.getErrors());
+
+	(void)printf("%s\n", bGood ? "The PCA9685 driver wrote every channel correctly." : "The PCA9685 driver failed!");
+
+	return bGood ? 0 : 1;
+}
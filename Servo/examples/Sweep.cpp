@@ -16,13 +16,26 @@ DorheaMG90S myServo("Dorhea MG90S w. Metal Gears", E_PWM_0);
 
 static double_t pos = MIN_ANGLE;	// variable to store the servo position
 
+// Sleeps until the slew model says the horn got there, instead of a fixed 150 ms.
+static void waitForServo(void)
+{
+	struct timespec settle;
+
+	const int64_t iSettleNs = myServo.settledAt();
+
+	settle.tv_sec = (time_t)( iSettleNs / 1000000000LL );
+	settle.tv_nsec = (long)( iSettleNs % 1000000000LL );
+
+	(void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &settle, NULL);
+}
+
 static void setup()
 {
 	(void)printf("%s:%s\n", PROGRAM_NAME, __FUNCTION__);
 
 	myServo.writeAngleDegrees(MIN_ANGLE);
 	
-	(void)usleep(1000*150);     // wait 150 ms for the servo to reach the position.
+	waitForServo();     		// wait for the servo to reach the position.
 
 }
 
@@ -33,13 +46,13 @@ static void loop() {
 	{ 								// goes from 0 degrees to 180 degrees in steps of 0.5 degree.
 		myServo.writeAngleDegrees(pos);
 									// tell servo to go to position in variable "pos."
-		(void)usleep(1000*150);     // wait 150 ms for the servo to reach the position.
+		waitForServo();     		// wait for the servo to reach the position.
 	}
 	for (pos = MAX_ANGLE - 0.5; pos >= ( MIN_ANGLE + 0.5 ); pos -= 0.5 ) 
 	{ 
 									// goes from 180 degrees to 0 degrees in steps of 0.5 degree.
 		myServo.writeAngleDegrees(pos);
-		(void)usleep(1000*150);     // wait 150 ms for the servo to reach the position.
+		waitForServo();     		// wait for the servo to reach the position.
 	}
 }
 
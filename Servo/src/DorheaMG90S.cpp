@@ -34,8 +34,8 @@ extern const char* __progname;			// The program name is provided by libc.
 #define PROGRAM_NAME __progname
 
 
-DorheaMG90S::DorheaMG90S(const char *strDescription/*= NULL*/, E_SERVO_CHANNELS sIndex/*=E_PWM_0*/) :
-	Servo(sIndex)
+DorheaMG90S::DorheaMG90S(const char *strDescription/*= NULL*/, E_SERVO_CHANNELS sIndex/*=E_PWM_0*/, PwmBackend *pBackend /*= NULL*/) :
+	Servo(sIndex, pBackend)
 {
 
 	(void)strncpy(achGimbalName, "Dorhea MG90S with only one Metal Gear", sizeof(achGimbalName));
@@ -56,7 +56,7 @@
 class DorheaMG90S : public Servo
 {
 public:
-	DorheaMG90S(const char *strDescription = NULL, E_SERVO_CHANNELS sIndex=E_PWM_0);
+	DorheaMG90S(const char *strDescription = NULL, E_SERVO_CHANNELS sIndex=E_PWM_0, PwmBackend *pBackend = NULL);
 	~DorheaMG90S();
 protected:
 
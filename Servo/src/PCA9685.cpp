@@ -0,0 +1,191 @@
+/*
+	PCA9685.cpp - PCA9685 PWM chip over i2c-dev for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PCA9685.h"
+
+const bool PCA9685::bDebug = false;
+
+const uint8_t PCA9685::MODE1_REGISTER;
+const uint8_t PCA9685::MODE2_REGISTER;
+const uint8_t PCA9685::LED0_ON_L_REGISTER;
+const uint8_t PCA9685::PRE_SCALE_REGISTER;
+const uint8_t PCA9685::MODE1_RESTART;
+const uint8_t PCA9685::MODE1_AUTO_INCREMENT;
+const uint8_t PCA9685::MODE1_SLEEP;
+const uint8_t PCA9685::MODE1_ALLCALL;
+const uint8_t PCA9685::MODE2_OUTDRV;
+const uint32_t PCA9685::NUMBER_OF_CHANNELS;
+const uint32_t PCA9685::COUNTS;
+const uint32_t PCA9685::REGISTERS_PER_CHANNEL;
+const useconds_t PCA9685::OSCILLATOR_START_US;
+
+const double_t PCA9685::OSCILLATOR_FREQUENCY = 25000000.0;
+
+PCA9685::PCA9685(I2cBus *pBus, const uint8_t uAddress /*= PCA9685_I2C_ADDRESS*/) :
+	pBus(pBus), uAddress(uAddress), bAutoFlush(true),
+	dOscillatorFrequency(OSCILLATOR_FREQUENCY), dPeriod(0.0), uDirty(0),
+	uTransactions(0), uErrors(0)
+{
+	(void)memset(auCounts, 0, sizeof(auCounts));
+}
+
+PCA9685::~PCA9685()
+{
+}
+
+const char *PCA9685::getName(void)
+{
+	return "pca9685-i2c-dev";
+}
+
+bool PCA9685::open(const uint32_t uPeriod)
+{
+	if ( ( NULL == pBus ) || ( 0 == uPeriod ) )
+		return false;
+
+	// The prescaler only takes a write while the oscillator sleeps.
+	const double_t dFrequency = 1e9 / uPeriod;
+
+	int32_t iPrescale = (int32_t)( ( dOscillatorFrequency / ( COUNTS * dFrequency ) ) + 0.5 ) - 1;
+
+	if ( 3 > iPrescale )
+		iPrescale = 3;						// The data sheet's minimum; about 1526 Hz.
+	else if ( 255 < iPrescale )
+		iPrescale = 255;
+	else
+		;
+
+	const uint8_t uMode1 = MODE1_AUTO_INCREMENT | MODE1_ALLCALL;
+
+	bool bSuccess = pBus->writeRegister(uAddress, MODE1_REGISTER, uMode1 | MODE1_SLEEP) &&
+		pBus->writeRegister(uAddress, MODE2_REGISTER, MODE2_OUTDRV) &&
+		pBus->writeRegister(uAddress, PRE_SCALE_REGISTER, (uint8_t)iPrescale) &&
+		pBus->writeRegister(uAddress, MODE1_REGISTER, uMode1);
+
+	if ( bSuccess )
+	{
+		(void)usleep(OSCILLATOR_START_US);
+		bSuccess = pBus->writeRegister(uAddress, MODE1_REGISTER, uMode1 | MODE1_RESTART);
+	}
+
+	if ( !bSuccess )
+	{
+		(void)printf("There's no PCA9685 answering at I2C address 0x%02x.\n", uAddress);
+		uErrors++;
+		return false;
+	}
+
+	dPeriod = 1e9 * COUNTS * ( iPrescale + 1 ) / dOscillatorFrequency;
+
+	if ( bDebug )
+		(void)printf("PCA9685 prescale %i; the period is %lf nanoseconds.\n", iPrescale, dPeriod);
+
+	return true;
+}
+
+bool PCA9685::writePulseWidth(const uint32_t uChannel, const uint32_t uPulseWidth)
+{
+	if ( ( NUMBER_OF_CHANNELS <= uChannel ) || ( 0.0 >= dPeriod ) )
+		return false;
+
+	double_t dCounts = ( (double_t)uPulseWidth * COUNTS / dPeriod ) + 0.5;
+
+	uint16_t uCounts = ( dCounts >= ( COUNTS - 1 ) ) ? (uint16_t)( COUNTS - 1 ) : (uint16_t)dCounts;
+
+	if ( uCounts != auCounts[uChannel] )
+	{
+		auCounts[uChannel] = uCounts;
+		uDirty |= (uint16_t)( 1 << uChannel );
+	}
+
+	return bAutoFlush ? flush() : true;
+}
+
+bool PCA9685::readPulseWidth(const uint32_t uChannel, uint32_t &uPulseWidth)
+{
+	uint8_t auRegisters[REGISTERS_PER_CHANNEL];
+
+	if ( ( NUMBER_OF_CHANNELS <= uChannel ) || ( NULL == pBus ) ||
+		!pBus->readRegisters(uAddress, LED0_ON_L_REGISTER + ( REGISTERS_PER_CHANNEL * uChannel ), auRegisters, sizeof(auRegisters)) )
+		return false;
+
+	uTransactions++;
+
+	// OFF minus ON, in counts, wrapping; bit 4 of OFF_H is "fully off."
+	if ( auRegisters[3] & 0x10 )
+		uPulseWidth = 0;
+	else
+	{
+		uint32_t uOn = auRegisters[0] | ( ( auRegisters[1] & 0x0f ) << 8 );
+		uint32_t uOff = auRegisters[2] | ( ( auRegisters[3] & 0x0f ) << 8 );
+
+		uPulseWidth = (uint32_t)( ( ( ( uOff + COUNTS - uOn ) % COUNTS ) * dPeriod / COUNTS ) + 0.5 );
+	}
+
+	return true;
+}
+
+bool PCA9685::flush(void)
+{
+	if ( 0 == uDirty )
+		return true;
+
+	if ( NULL == pBus )
+		return false;
+
+	uint32_t uLow = 0, uHigh = NUMBER_OF_CHANNELS - 1;
+
+	while ( !( uDirty & ( 1 << uLow ) ) )
+		uLow++;
+
+	while ( !( uDirty & ( 1 << uHigh ) ) )
+		uHigh--;
+
+	// The register address, then ON_L, ON_H, OFF_L, OFF_H for each channel in the span;
+	//	the clean channels in between go out again unchanged.
+	uint8_t auWrite[1 + ( NUMBER_OF_CHANNELS * REGISTERS_PER_CHANNEL )];
+	uint32_t nWrite = 0;
+
+	auWrite[nWrite++] = (uint8_t)( LED0_ON_L_REGISTER + ( REGISTERS_PER_CHANNEL * uLow ) );
+
+	for ( uint32_t i = uLow ; i <= uHigh ; i++ )
+	{
+		auWrite[nWrite++] = 0;
+		auWrite[nWrite++] = 0;
+		auWrite[nWrite++] = (uint8_t)( auCounts[i] & 0xff );
+		auWrite[nWrite++] = (uint8_t)( auCounts[i] >> 8 );
+	}
+
+	if ( !pBus->transfer(uAddress, auWrite, nWrite, NULL, 0) )
+	{
+		uErrors++;
+		return false;						// Still dirty; the next flush() tries again.
+	}
+
+	uTransactions++;
+	uDirty = 0;
+
+	return true;
+}
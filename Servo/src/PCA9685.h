@@ -0,0 +1,120 @@
+/*
+	PCA9685.h - PCA9685 PWM chip over i2c-dev for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	Bypasses the kernel's pwm-pca9685 driver and its one sysfs file per channel: the driver
+	keeps each channel's LEDn_ON/LEDn_OFF registers in a shadow, and flush() writes the span
+	from the lowest changed channel to the highest in one I2C transaction, with the chip's
+	register auto-increment on. Updating the pitch and yaw servos and the ESC on channels
+	0, 1, and 2 is then one 13 byte write.
+
+	With auto-flush on (the default), each writePulseWidth() is its own transaction; turn it
+	off to batch a frame's worth of channels and flush() once.
+
+	The kernel driver must not be bound to the chip at the same time (remove the
+	"i2c-pwm-pca9685a" overlay). Any I2cBus works; MockI2cBus runs it without hardware.
+
+*/
+
+#ifndef _PCA9685_H
+#define _PCA9685_H
+
+#include <math.h>
+#include <unistd.h>
+#include "PwmBackend.h"
+#include "I2cBus.h"
+
+#define PCA9685_VERSION	1     				// software version of this library
+
+#define PCA9685_I2C_ADDRESS	0x40
+
+class PCA9685 : public PwmBackend
+{
+public:
+	PCA9685(I2cBus *pBus, const uint8_t uAddress = PCA9685_I2C_ADDRESS);
+	virtual ~PCA9685();
+
+	virtual const char *getName(void);
+	virtual bool open(const uint32_t uPeriod);
+	virtual bool writePulseWidth(const uint32_t uChannel, const uint32_t uPulseWidth);
+	virtual bool readPulseWidth(const uint32_t uChannel, uint32_t &uPulseWidth);
+	virtual bool flush(void);
+
+	inline void setAutoFlush(const bool bFlush)
+	{
+		bAutoFlush = bFlush;
+	}
+
+	// The internal oscillator is 25 MHz within a few percent; measure it to trim the period.
+	inline void setOscillatorFrequency(const double_t dHertz)
+	{
+		dOscillatorFrequency = dHertz;
+	}
+
+	// The period the prescaler actually gives, in nanoseconds; one count is 1/4096th of it.
+	inline double_t getPeriod(void)
+	{
+		return dPeriod;
+	}
+
+	inline uint32_t getTransactions(void)
+	{
+		return uTransactions;
+	}
+
+	inline uint32_t getErrors(void)
+	{
+		return uErrors;
+	}
+
+	// The registers from the data sheet.
+	static const uint8_t MODE1_REGISTER			= 0x00;
+	static const uint8_t MODE2_REGISTER			= 0x01;
+	static const uint8_t LED0_ON_L_REGISTER		= 0x06;		// Four per channel: ON_L, ON_H, OFF_L, OFF_H.
+	static const uint8_t PRE_SCALE_REGISTER		= 0xfe;
+
+	static const uint8_t MODE1_RESTART			= 0x80;
+	static const uint8_t MODE1_AUTO_INCREMENT	= 0x20;
+	static const uint8_t MODE1_SLEEP			= 0x10;
+	static const uint8_t MODE1_ALLCALL			= 0x01;
+	static const uint8_t MODE2_OUTDRV			= 0x04;		// Totem pole outputs, for servo inputs.
+
+	static const uint32_t NUMBER_OF_CHANNELS	= 16;
+	static const uint32_t COUNTS				= 4096;
+	static const uint32_t REGISTERS_PER_CHANNEL	= 4;
+
+	static const double_t OSCILLATOR_FREQUENCY;
+	static const useconds_t OSCILLATOR_START_US	= 500;
+
+private:
+	I2cBus *pBus;
+	uint8_t uAddress;
+
+	bool bAutoFlush;
+
+	double_t dOscillatorFrequency;
+	double_t dPeriod;						// nanoseconds.
+
+	uint16_t auCounts[NUMBER_OF_CHANNELS];	// The OFF count for each channel; ON is always 0.
+	uint16_t uDirty;						// A bit per channel staged since the last flush().
+
+	uint32_t uTransactions, uErrors;
+
+	static const bool bDebug;
+};
+
+#endif	// _PCA9685_H
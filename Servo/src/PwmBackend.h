@@ -0,0 +1,58 @@
+/*
+	PwmBackend.h - Servo pulse output interface for Raspberry PI; Version 1.
+	Copyright (c) 2024 Kirby W. Cartwright. All right reserved.
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Lesser General Public
+	License as published by the Free Software Foundation; either
+	version 2.1 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public
+	License along with this library; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+	By default a Servo writes its channel's "duty_cycle" under "/sys/class/pwm/." Given a
+	backend instead, it writes through that; e.g., PCA9685 drives the PWM chip over
+	"/dev/i2c-N" itself, staging each channel's pulse width so that flush() sends every
+	changed channel in one transaction.
+
+	Many Servos share one backend; whoever creates it opens it, once, before the Servos.
+
+*/
+
+#ifndef _PWM_BACKEND_H
+#define _PWM_BACKEND_H
+
+#include <inttypes.h>
+
+#define PWM_BACKEND_VERSION	1     			// software version of this library
+
+class PwmBackend
+{
+public:
+	virtual ~PwmBackend()
+	{
+	}
+
+	virtual const char *getName(void) = 0;
+
+	// Finds and configures the device for a PWM period in nanoseconds.
+	virtual bool open(const uint32_t uPeriod) = 0;
+
+	// Stages a channel's pulse width in nanoseconds; it goes out on flush(), or at once if
+	//	the backend flushes automatically.
+	virtual bool writePulseWidth(const uint32_t uChannel, const uint32_t uPulseWidth) = 0;
+
+	// Reads a channel's pulse width back from the device.
+	virtual bool readPulseWidth(const uint32_t uChannel, uint32_t &uPulseWidth) = 0;
+
+	// Sends everything staged since the last flush().
+	virtual bool flush(void) = 0;
+};
+
+#endif	// _PWM_BACKEND_H
@@ -118,12 +118,28 @@ const char *Servo::pPulseWidthPaths[NUM_PWM_CHANNELS] =
 
 uint32_t Servo::uNumPWMs = 0xffffffff;
 
-Servo::Servo(E_SERVO_CHANNELS sIndex/*=E_PWM_0*/) :
-	pHandle(NULL), dAngleUpperLimit(MAX_ANGLE), dAngleLowerLimit(MIN_ANGLE),
-	dAngleDefault(DEFAULT_ANGLE), dAngleCenter(CENTER_ANGLE), bWaitForSlew(true), ePwmChannel(sIndex)
+Servo::Servo(E_SERVO_CHANNELS sIndex/*=E_PWM_0*/, PwmBackend *pBackend /*= NULL*/) :
+	dAngleUpperLimit(MAX_ANGLE), dAngleLowerLimit(MIN_ANGLE),
+	dAngleDefault(DEFAULT_ANGLE), dAngleCenter(CENTER_ANGLE), bWaitForSlew(false), ePwmChannel(sIndex),
+	pBackend(pBackend), uShadowPulseWidth(0), uDeadband(DEFAULT_DEADBAND), uWrites(0), uSuppressed(0),
+	dSlewRate(SERVO_SLEW_RATE), dSlewStartPulseWidth(DEFAULT_PULSE_WIDTH), iSlewStartNs(0)
 {
 	(void)memset(achGimbalName,'\0', sizeof(achGimbalName));
 
+	if ( NULL != pBackend )
+	{
+		// The backend's owner set the period up for every channel.
+		if ( pBackend->writePulseWidth(ePwmChannel, DEFAULT_PULSE_WIDTH) && pBackend->flush() )
+		{
+			uShadowPulseWidth = DEFAULT_PULSE_WIDTH;
+			dSlewStartPulseWidth = DEFAULT_PULSE_WIDTH, iSlewStartNs = timestampNow();
+		}
+		else
+			(void)printf("%s: unable to write PWM channel %i through \"%s.\"\n", __FUNCTION__, ePwmChannel, pBackend->getName());
+
+		return;
+	}
+
 	if (bDebug)
 		(void)printf("%s: Trying to open hardware PWM channel\"%i.\"\n", __FUNCTION__, ePwmChannel);
 	
@@ -131,24 +147,14 @@ Servo::Servo(E_SERVO_CHANNELS sIndex/*=E_PWM_0*/) :
 
 	while (true)
 	{
-		if (bDebug)		
-			(void)printf("\nTrying to open \"%s.\"\n", pNumPWMs);
-
-		pHandle = fopen(pNumPWMs,"r");
+		SysfsAttribute numPWMsAttribute(pNumPWMs);
 		
-		if ( NULL == pHandle )
-		{	
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pNumPWMs, strerror(errno));		
+		if ( !numPWMsAttribute.isOpen() )
 			break;	
-		}
-
-		if (bDebug)
-		 	(void)printf("Successfully opened \"%s.\"\n", pNumPWMs);
 
-		int numPwms = -1;
-		if ( 1 != fscanf(pHandle, "%i", &numPwms) )
+		int32_t numPwms = -1;
+		if ( !numPWMsAttribute.readInteger(numPwms) )
 		{
-			(void)printf("Unable to read from \"%s!\"\n\t\"%s\"\n", pNumPWMs, strerror(errno));
 			break;
 		}
 		else if (bDebug)
@@ -158,79 +164,47 @@ Servo::Servo(E_SERVO_CHANNELS sIndex/*=E_PWM_0*/) :
 		else
 			;
 
-		(void)usleep(PWM_SETTING_DELAY);
+		// A channel left exported, e.g., by the last run, is still there; exporting it
+		//	again fails with EBUSY.
+		if ( 0 != access(pEnablePaths[ePwmChannel], F_OK) )
+		{
+			SysfsAttribute exportAttribute(pExportPath, O_WRONLY);
 
+			if ( !exportAttribute.isOpen() )
+				break;		
 
-		(void)fclose(pHandle);
-		pHandle = NULL;
+			else if ( !exportAttribute.writeInteger(ePwmChannel) )
+				break;				 
 
-		if (bDebug)
-			(void)printf("\nTrying to open \"%s.\"\n", pExportPath);
-		
-		pHandle = fopen(pExportPath,"w");
+			else if (bDebug)
+				(void)printf("Exported PWM channel %i.\n", ePwmChannel);
 
-		if ( NULL == pHandle )
-		{
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pExportPath, strerror(errno));
-			break;		
+			else
+				;
+
+			// The kernel makes the channel's directory during the write; udev may take a
+			//	moment more to hand its attributes to a non-root user.
+			if ( !waitForAttribute(pEnablePaths[ePwmChannel]) )
+				break;
 		}
 
-		else 
+		if ( !bPeriodWritten )
 		{
-			 if ( 0 > fprintf(pHandle, "%i", ePwmChannel) )
-			 {
-				(void)printf("Unable to write to \"%s!\"\n\t\"%s\"\n", pExportPath, strerror(errno));
-				break;				 
-			 }
-			 else if (bDebug)
-			 {
-				(void)printf("Exported PWM channel %i.\n", ePwmChannel);
-			 }
-			 else
-			 	;
+			SysfsAttribute periodAttribute(pPeriodPaths[ePwmChannel], O_RDWR);
 
-		}
+			if ( !periodAttribute.isOpen() )
+				break;		
 
-		(void)usleep(PWM_SETTING_DELAY);
+			// Trying to set 400 Hz.
+			else if ( !periodAttribute.writeUnsigned(SERVO_PERIOD_WIDTH) )
+				break;				 
 
-		(void)fclose(pHandle);
-		pHandle = NULL;
+			else if (bDebug)
+				(void)printf("Wrote %i nanoseconds to PWM Channel %i period (400 Hz).\n", SERVO_PERIOD_WIDTH, ePwmChannel);
+
+			else
+				;
 
-		if ( !bPeriodWritten )
-		{
-			if (bDebug)
-				(void)printf("\nTrying to open \"%s.\"\n", pPeriodPaths[ePwmChannel]);
-			
-			pHandle = fopen(pPeriodPaths[ePwmChannel],"r+");
-
-			if ( NULL == pHandle )
-			{
-				(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pPeriodPaths[ePwmChannel], strerror(errno));
-				break;		
-			}
-
-			else 
-			{
-				// Trying to set 400 Hz.
-				if ( 0 > fprintf(pHandle, "%i", SERVO_PERIOD_WIDTH) )
-				{
-					(void)printf("Unable to write to \"%s!\"\n\t\"%s\"\n", pPeriodPaths[ePwmChannel], strerror(errno));
-					break;				 
-				}
-				else if (bDebug)
-				{
-					(void)printf("Wrote %i nanoseconds to PWM Channel %i period (400 Hz).\n", SERVO_PERIOD_WIDTH, ePwmChannel);
-				}
-				else
-					;
-
-			}
-					
-			(void)usleep(PWM_SETTING_DELAY);		
-		
-			(void)fclose(pHandle);
-			pHandle = NULL;
-		
 			bPeriodWritten = true;
 
 		}
@@ -242,87 +216,66 @@ Servo::Servo(E_SERVO_CHANNELS sIndex/*=E_PWM_0*/) :
 		else
 			;
 
+		// The duty cycle is written every update; keep it open.
+		if ( !dutyCycleAttribute.open(pPulseWidthPaths[ePwmChannel], O_RDWR) )
+			break;		
 
-		if (bDebug)		
-			(void)printf("\nTrying to open \"%s.\"\n", pPulseWidthPaths[ePwmChannel]);
-		
-		pHandle = fopen(pPulseWidthPaths[ePwmChannel],"r+");
+		// Trying to set the default,
+		else if ( !dutyCycleAttribute.writeUnsigned(DEFAULT_PULSE_WIDTH) )
+			break;				 
 
-		if ( NULL == pHandle)
-		{
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pPulseWidthPaths[ePwmChannel], strerror(errno));
-			break;		
-		}
+		else if (bDebug)
+			(void)printf("Wrote %i nanoseconds to PWM Channel %i duty cycle (50 percent at 400 Hz).\n", DEFAULT_PULSE_WIDTH, ePwmChannel);
 
-		else 
-		{
-			// Trying to set the default,
-			 if ( 0 > fprintf(pHandle, "%i", DEFAULT_PULSE_WIDTH) )
-			 {
-				(void)printf("Unable to write to \"%s!\"\n\t\"%s\"\n", pPulseWidthPaths[ePwmChannel], strerror(errno));
-				break;				 
-			 }
-			 else if (bDebug)
-			 {
-				(void)printf("Wrote %i nanoseconds to PWM Channel %i duty cycle (50 percent at 400 Hz).\n", DEFAULT_PULSE_WIDTH, ePwmChannel);
-			 }
-			 else
-			 	;
-		}		
-	
-		(void)usleep(PWM_SETTING_DELAY);
+		else
+			;
 
-		(void)fclose(pHandle);
-		pHandle = NULL;
-		
-		if (bDebug)
-			(void)printf("\nTrying to open \"%s.\"\n", pEnablePaths[ePwmChannel]);
-		
-		pHandle = fopen(pEnablePaths[ePwmChannel],"r+");
+		uShadowPulseWidth = DEFAULT_PULSE_WIDTH;
 
-		if ( NULL == pHandle )
-		{
-			(void)printf("Unable to open \"%s!\"\n\t\"%s\"\n", pEnablePaths[ePwmChannel], strerror(errno));
+		// Where it was before is unknown; take it as already there.
+		dSlewStartPulseWidth = DEFAULT_PULSE_WIDTH, iSlewStartNs = timestampNow();
+
+		SysfsAttribute enableAttribute(pEnablePaths[ePwmChannel], O_RDWR);
+
+		if ( !enableAttribute.isOpen() )
 			break;		
-		}
 
-		else 
-		{
-			// Trying to turn on.
-			 if ( 0 > fprintf(pHandle, "%i", 1) )
-			 {
-				(void)printf("Unable to write to \"%s!\"\n\t\"%s\"\n", pEnablePaths[ePwmChannel], strerror(errno));
-				break;				 
-			 }
-			 else if (bDebug)
-			 {
-				(void)printf("Turned-on PWM Channel %i.\n", ePwmChannel);
-			 }
-			 else
-			 	;
-
-		}			
-			
-		(void)usleep(PWM_SETTING_DELAY);
+		// Trying to turn on.
+		else if ( !enableAttribute.writeUnsigned(1) )
+			break;				 
+
+		else if (bDebug)
+			(void)printf("Turned-on PWM Channel %i.\n", ePwmChannel);
+
+		else
+			;
 
 		break;
 	}
 
-	if ( NULL!=pHandle)
-		(void)fclose(pHandle);
-	pHandle = NULL;	
-
 }
 
-Servo::~Servo()
+bool Servo::waitForAttribute(const char *pPath)
 {
-	if ( NULL!= pHandle )
+	for ( useconds_t uWaited = 0 ; uWaited < PWM_SETTING_DELAY ; uWaited += PWM_POLL_DELAY )
 	{
-		(void)fprintf(pHandle, "%i", DEFAULT_PULSE_WIDTH);
-		(void)fclose(pHandle);
-		pHandle = NULL;
-		(void)usleep((SERVO_PERIOD_WIDTH+500)/1000 );
+		if ( 0 == access(pPath, W_OK) )
+			return true;
+
+		(void)usleep(PWM_POLL_DELAY);
 	}
+
+	if ( 0 == access(pPath, W_OK) )
+		return true;
+
+	(void)printf("%s: \"%s\" didn't become writable within %u microseconds.\n", __FUNCTION__, pPath, PWM_SETTING_DELAY);
+
+	return false;
+}
+
+Servo::~Servo()
+{
+	dutyCycleAttribute.close();
 }
 
 void Servo::writeAngleRadians(double_t dRadians)
@@ -331,27 +284,30 @@ void Servo::writeAngleRadians(double_t dRadians)
 }
 
 uint32_t Servo::readPulseWidth(void)
+{
+	return uShadowPulseWidth;
+}
+
+uint32_t Servo::readDevicePulseWidth(void)
 {
 	uint32_t uPulseWidth = 0;
 
-	FILE *pHandle = fopen(pPulseWidthPaths[ePwmChannel],"r+");
-	
-	if ( NULL!=pHandle )
-	{
-		
-		int nRead = fscanf(pHandle, "%i", &uPulseWidth);
+	if ( NULL != pBackend )
+		return pBackend->readPulseWidth(ePwmChannel, uPulseWidth) ? uPulseWidth : 0;
+
+	if ( !dutyCycleAttribute.isOpen() )
+		return uPulseWidth;
 		
-		if ( 0 > nRead )
-		{
-			(void)fprintf(stderr, "Unable to read from \"%s!\"\n\t\"%s\"\n", pPulseWidthPaths[ePwmChannel], strerror(errno));
-		}
-		else if (bDebug)
-		{
-			(void)printf("Read %i nanoseconds from PWM Channel %i duty cycle (50 percent at 36 Hz).\n", uPulseWidth, ePwmChannel);		
-		}
-		else
-			;
+	if ( !dutyCycleAttribute.readUnsigned(uPulseWidth) )
+	{
+		uPulseWidth = 0;
 	}
+	else if (bDebug)
+	{
+		(void)printf("Read %i nanoseconds from PWM Channel %i duty cycle (50 percent at 36 Hz).\n", uPulseWidth, ePwmChannel);		
+	}
+	else
+		;
 
 	return uPulseWidth;
 
@@ -359,17 +315,29 @@ uint32_t Servo::readPulseWidth(void)
 
 void Servo::writePulseWidth(uint32_t uValue)
 {
-	FILE *pHandle = fopen(pPulseWidthPaths[ePwmChannel],"r+");
-	
-	if ( NULL==pHandle )
+	if ( !dutyCycleAttribute.isOpen() && ( NULL == pBackend ) )
 	{
 		return;
 	}
+
+	// In a steady hover the commands barely move; don't make a system call for nothing.
+	uint32_t uChange = ( uValue > uShadowPulseWidth ) ? ( uValue - uShadowPulseWidth ) : ( uShadowPulseWidth - uValue );
+
+	if ( ( 0 != uShadowPulseWidth ) && ( ( 0 == uChange ) || ( uChange < uDeadband ) ) )
+	{
+		uSuppressed++;
+		return;
+	}
 	
 	// Trying to set the pulse width in nanoseconds.
-	if ( 0 > fprintf(pHandle, "%i", uValue) )
+	if ( NULL != pBackend )
 	{
-		(void)printf("Unable to write to \"%s!\"\n\t\"%s\"\n", pPulseWidthPaths[ePwmChannel], strerror(errno));				 
+		if ( !pBackend->writePulseWidth(ePwmChannel, uValue) )
+			return;
+	}
+	else if ( !dutyCycleAttribute.writeUnsigned(uValue) )
+	{
+		return;					// Already reported.
 	}
 	else if (bDebug)
 	{
@@ -378,11 +346,27 @@ void Servo::writePulseWidth(uint32_t uValue)
 	else
 		;
 
+	// The horn starts over from wherever it had got to.
+	const int64_t iNow = timestampNow();
+
+	dSlewStartPulseWidth = ( 0 != uShadowPulseWidth ) ? estimatedPulseWidth(iNow) : (double_t)uValue;
+	iSlewStartNs = iNow;
+
+	uShadowPulseWidth = uValue;
+	uWrites++;
+
 	if ( bWaitForSlew )
-		(void)usleep((SERVO_PERIOD_WIDTH+500)/1000 );
-	
-	(void)fclose(pHandle);
-	pHandle = NULL;	
+	{
+		struct timespec settle;
+
+		const int64_t iSettleNs = settledAt();
+
+		settle.tv_sec = (time_t)( iSettleNs / 1000000000LL );
+		settle.tv_nsec = (long)( iSettleNs % 1000000000LL );
+
+		while ( EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &settle, NULL) )
+			;
+	}
 	
 }
 
@@ -504,3 +488,69 @@ double_t Servo::readAngleRadians(void)
 	return ( ( M_PI *readAngleDegrees() ) / MAX_ANGLE ) ;
 }
 
+int64_t Servo::timestampNow(void)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ( (int64_t)now.tv_sec * 1000000000LL ) + now.tv_nsec;
+}
+
+// The slew rate in nanoseconds of pulse width per second.
+static double_t pulseWidthRate(const double_t dDegreesPerSecond)
+{
+	return dDegreesPerSecond * ( (double_t)MAX_PULSE_WIDTH - (double_t)MIN_PULSE_WIDTH ) / ( MAX_ANGLE - MIN_ANGLE );
+}
+
+double_t Servo::estimatedPulseWidth(int64_t iTimestampNs /*= 0*/)
+{
+	if ( 0 == uShadowPulseWidth )
+		return 0.0;
+
+	if ( 0 == iTimestampNs )
+		iTimestampNs = timestampNow();
+
+	if ( iTimestampNs <= iSlewStartNs )
+		return dSlewStartPulseWidth;
+
+	double_t dDistance = (double_t)uShadowPulseWidth - dSlewStartPulseWidth;
+	double_t dTravel = pulseWidthRate(dSlewRate) * ( iTimestampNs - iSlewStartNs ) * 1e-9;
+
+	if ( fabs(dDistance) <= dTravel )
+		return (double_t)uShadowPulseWidth;
+
+	return dSlewStartPulseWidth + copysign(dTravel, dDistance);
+}
+
+double_t Servo::estimatedAngleDegrees(int64_t iTimestampNs /*= 0*/)
+{
+	// The same conversion as readAngleDegrees(), so the two agree once settled.
+	double_t dDegrees = estimatedPulseWidth(iTimestampNs) - (double_t)MIN_PULSE_WIDTH;
+	dDegrees /= ( (double_t)MAX_PULSE_WIDTH - (double_t)MIN_PULSE_WIDTH );
+	dDegrees *= ( MAX_ANGLE - MIN_ANGLE );
+	dDegrees += MIN_ANGLE;
+
+	return dDegrees;
+}
+
+double_t Servo::estimatedAngleRadians(int64_t iTimestampNs /*= 0*/)
+{
+	return ( ( M_PI * estimatedAngleDegrees(iTimestampNs) ) / MAX_ANGLE );
+}
+
+int64_t Servo::settledAt(void)
+{
+	double_t dDistance = fabs((double_t)uShadowPulseWidth - dSlewStartPulseWidth);
+
+	return iSlewStartNs + (int64_t)( 1e9 * dDistance / pulseWidthRate(dSlewRate) );
+}
+
+bool Servo::settled(int64_t iTimestampNs /*= 0*/)
+{
+	if ( 0 == iTimestampNs )
+		iTimestampNs = timestampNow();
+
+	return ( iTimestampNs >= settledAt() );
+}
+
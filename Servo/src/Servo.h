@@ -33,6 +33,9 @@
 #include <inttypes.h>
 #include <math.h>
 #include <unistd.h>
+#include <time.h>
+#include "SysfsAttribute.h"
+#include "PwmBackend.h"
 
 #define SERVO_VERSION       2     		// software version of this library
 
@@ -90,7 +93,9 @@ typedef enum
 class Servo
 {
 public:
-	Servo(E_SERVO_CHANNELS sIndex=E_PWM_0);
+	// With a backend, e.g., PCA9685, the servo writes through it instead of sysfs; the
+	//	backend has to be open already.
+	Servo(E_SERVO_CHANNELS sIndex=E_PWM_0, PwmBackend *pBackend = NULL);
 	~Servo();
 	void writeAngleDegrees(double_t dDegrees = DEFAULT_ANGLE );		
 											// The arguments for these are an angle in degrees.
@@ -121,16 +126,70 @@ public:
 	double_t readFrequency(void);
 
 	uint32_t readPulseWidth(void);          // Returns the current pulse width in nanoseconds for this servo channel.
+											// The last one written; it doesn't go back to sysfs.
+	uint32_t readDevicePulseWidth(void);	// Reads the duty cycle back from sysfs (or the backend).
 
 	void writePulseWidth(uint32_t uValue);	// Write pulse width in nanoseconds.
-
+											// Skipped if within the deadband of the last one written.
+	inline void setDeadband(uint32_t uNanoseconds)
+	{
+		uDeadband = uNanoseconds;
+	}
+
+	inline uint32_t getDeadband(void)
+	{
+		return uDeadband;
+	}
+
+	inline uint32_t getWrites(void)			// Duty cycle writes that went to sysfs.
+	{
+		return uWrites;
+	}
+
+	inline uint32_t getSuppressed(void)		// Ones the deadband skipped.
+	{
+		return uSuppressed;
+	}
+
+	static const uint32_t DEFAULT_DEADBAND = 1000;
+											// nanoseconds; 0.09 degree, under the MG90S's own deadband.
+
+	// The horn doesn't get where it's told at once; these model it slewing at the slew rate
+	//	toward the last pulse width written, so a caller can find where it is, or when it will
+	//	be there, without sleeping. Timestamps are CLOCK_MONOTONIC nanoseconds; zero is now.
+	double_t estimatedAngleDegrees(int64_t iTimestampNs = 0);
+	double_t estimatedAngleRadians(int64_t iTimestampNs = 0);
+	double_t estimatedPulseWidth(int64_t iTimestampNs = 0);
+
+	int64_t settledAt(void);				// When the horn reaches the last pulse width written.
+	bool settled(int64_t iTimestampNs = 0);
+
+	inline void setSlewRate(double_t dDegreesPerSecond = SERVO_SLEW_RATE)
+	{
+		dSlewRate = dDegreesPerSecond;		// E.g., slower under load.
+	}
+
+	inline double_t getSlewRate(void)
+	{
+		return dSlewRate;
+	}
+
+	// Off by default; on, writePulseWidth() sleeps until settledAt().
+	inline void setWaitForSlew(bool bWait)
+	{
+		bWaitForSlew = bWait;
+	}
+
+	static int64_t timestampNow(void);
 
 	static const useconds_t PWM_SETTING_DELAY = 10000;
-											// 10 milliseconds.
+											// 10 milliseconds; the longest a new channel's
+											//	attributes may take to show up.
+	static const useconds_t PWM_POLL_DELAY = 500;
 
 protected:
 	static uint32_t uNumPWMs;
-	FILE *pHandle;							// Used to access the "/sys/class/pwm/" abstraction.
+	SysfsAttribute dutyCycleAttribute;		// Used to access the "/sys/class/pwm/" abstraction; opened once.
 		
 	E_SERVO_CHANNELS servoIndex;            // Index into the channel data for this servo.
 
@@ -152,9 +211,22 @@ private:
 	
 	E_SERVO_CHANNELS ePwmChannel;
 
+	PwmBackend *pBackend;					// NULL for sysfs.
+
+	uint32_t uShadowPulseWidth;				// The last pulse width written; zero before the first.
+	uint32_t uDeadband;
+	uint32_t uWrites, uSuppressed;
+
+	double_t dSlewRate;						// degrees per second.
+	double_t dSlewStartPulseWidth;			// Where the horn was when the last write went out,
+	int64_t iSlewStartNs;					//	and when.
+
 	static const bool bDebug;	
 
 	static bool bPeriodWritten;				// Per PWM chip, you can only write the period once.
+
+	// Returns as soon as a freshly exported attribute can be written.
+	static bool waitForAttribute(const char *pPath);
 };
 
 #endif
@@ -29,7 +29,7 @@ UI::UI(const char *UIName/* = NULL*/) :
 	bDebug(true),bContinue(true), bCalibrated(false),
 	dPitchSetting(0.0), dRollSetting(0.0), dYawSetting(0.0),
 	dAltitudeSetting(0.0), dThrottleSetting(0.0),
-	dAltitudeValue(0.0), dPressureValue(0.0), dTemperatureValue(0.0),
+	dAltitudeValue(0.0), dVerticalSpeedValue(0.0), dPressureValue(0.0), dTemperatureValue(0.0),
 	dPitchValue(0.0), dRollValue(0.0), dYawValue(0.0),
 
 	dLatitudeValue(0.0), dLongitudeValue(0.0), dLocationAltitudeValue(0.0),
@@ -275,6 +275,7 @@ void UI::displayMenu(void)
 	(void)fprintf(stdout, "\t     Enter T# to set the throttle position in percent; 0 to 100%%.\n" );
 	(void)fprintf(stdout, "\t     Enter t to toggle the Telemetry On/Off.\n" );	
 	(void)fprintf(stdout, "\t     Press z or Z to zero sensors. This take five minutes.\n" );
+	(void)fprintf(stdout, "\t     Press l or L to dump the control loop latencies to stderr.\n" );
 	(void)fprintf(stdout, "\t     Press + or - to increase or decrease the throttle.\n" );	
 	(void)fprintf(stdout, "\t     Press Up or Down Arrow to change pitch.\n" );		
 	(void)fprintf(stdout, "\t     Press Left or Right Arrow to change Yaw.\n" );		
@@ -639,6 +640,13 @@ void UI::handleMenu(void)
 			displayCommand(E_COMMAND_HELP);
 		}
 		break;
+		case 'L':
+		case 'l':
+		{
+			rockHopper->printLatency();
+			displayCommand(E_COMMAND_DUMP_LATENCY);
+		}
+		break;
 		case 'c':
 		case 'C':
 		{
@@ -667,6 +675,10 @@ void UI::setup(void)
 
 	initScreen();
 	bContinue = true;
+	(void)rockHopper->startImuAcquisition();
+	(void)rockHopper->startBarometerAcquisition();
+	(void)rockHopper->startActuatorStage();
+	(void)rockHopper->startExecutive();
 	getOrientation(dPitchSetting, dRollSetting, dYawSetting);
 	readOrientation(dPitchValue, dRollValue, dYawValue);	
 	getThrottle(dThrottleSetting);
@@ -700,6 +712,10 @@ void UI::teardown(void)
 {
 	clearScreen();
 	bContinue	= false;
+	rockHopper->stopExecutive();
+	rockHopper->stopActuatorStage();
+	rockHopper->stopBarometerAcquisition();
+	rockHopper->stopImuAcquisition();
 	resetTermios();
 	showCursor();
 }
@@ -813,8 +829,9 @@ void UI::displayValues(void)
 			case 2:
 			{					
 				getAltitude(dAltitudeValue);
+				getVerticalSpeed(dVerticalSpeedValue);
 				gotoXY(1,4);
-				(void)fprintf(stdout, "ALTITUDE: %5.1lf m", dAltitudeValue);					
+				(void)fprintf(stdout, "ALTITUDE: %5.1lf m %+4.1lf m/s", dAltitudeValue, dVerticalSpeedValue);					
 			}
 			break;	
 			case 3:
@@ -915,7 +932,8 @@ void UI::displayCommand(E_COMMAND_CODES e /*= E_COMMAND_NOTHING*/)
 		"PITCH DOWN       ",
 		"TURN LEFT        ",
 		"TURN RIGHT       ",
-		"SET FEEDBACK     "
+		"SET FEEDBACK     ",
+		"DUMP LATENCY     "
 	};
 
 	gotoXY(1,1);
@@ -955,6 +973,11 @@ void UI::getAltitude(double_t &dAltitude)
 	dAltitude = rockHopper->getAltitude();
 }
 
+void UI::getVerticalSpeed(double_t &dVerticalSpeed)
+{
+	dVerticalSpeed = rockHopper->getVerticalSpeed();
+}
+
 void UI::getTemperature(double_t &dTemperature)
 {
 	dTemperature = rockHopper->getTemperature();
@@ -51,8 +51,9 @@ typedef enum
 	E_COMMAND_TURN_LEFT			= 14,
 	E_COMMAND_TURN_RIGHT		= 15,
 	E_COMMAND_SET_FEEDBACK		= 16,
+	E_COMMAND_DUMP_LATENCY		= 17,
 
-	NUM_COMMANDS				= 17
+	NUM_COMMANDS				= 18
 } E_COMMAND_CODES; 
 
 typedef enum
@@ -120,6 +121,8 @@ public:
 
 	void getAltitude(double_t &dAltitude);
 
+	void getVerticalSpeed(double_t &dVerticalSpeed);
+
 	void getTemperature(double_t &dTemperature);
 
 	void getPressure(double_t &dPressure);
@@ -147,6 +150,7 @@ protected:
 		dThrottleSetting,
 
 		dAltitudeValue,
+		dVerticalSpeedValue,
 		dPressureValue,
 		dTemperatureValue,
 		dPitchValue,